@@ -0,0 +1,789 @@
+/*
+ * AIGSolver.cpp - And-inverter graphs, gate reconstruction and cofactoring
+ */
+
+#include "AIGSolver.h"
+#include "QBFFeatures.h"
+#include "QCDCLSolver.h"
+#include <algorithm>
+#include <iostream>
+#include <map>
+#include <random>
+#include <set>
+
+// Rebuild the graph from its roots once this many nodes are allocated,
+// at the least (cofactoring leaves the old cone behind)
+static const long long MIN_GC_NODES = 1 << 14;
+
+// First SAT sweep at this many live nodes; later ones once the graph has
+// doubled since the last
+static const long long FIRST_SWEEP_NODES = 2000;
+
+// Random simulation: 64 patterns per word
+static const int SIM_WORDS = 4;
+
+// Candidate pairs over at most this many inputs are compared on every
+// input pattern; larger ones need a SAT call, each stopped after
+// SWEEP_SAT_SECONDS. A sweep stops calling after SWEEP_MAX_SAT_FAILURES
+// calls that did not prove their pair equivalent
+static const size_t EXHAUSTIVE_VARS = 12;
+static const long long SWEEP_MAX_SAT_FAILURES = 32;
+static const double SWEEP_SAT_SECONDS = 0.02;
+
+AIGSolver::AIGSolver()
+    : nodeLimit(1000000), gcThreshold(MIN_GC_NODES), sweepThreshold(FIRST_SWEEP_NODES), overflow(false),
+      aborted(false), allocations(0), visitStamp(0), verbose(false), timeLimit(0) {}
+
+void AIGSolver::setVerbose(bool enabled) {
+    verbose = enabled;
+}
+
+void AIGSolver::setTimeLimit(double seconds) {
+    timeLimit = seconds;
+}
+
+void AIGSolver::setNodeLimit(long long value) {
+    nodeLimit = std::max(2LL, value);
+}
+
+void AIGSolver::setOuterCallback(const OuterCallback& callback) {
+    outerCallback = callback;
+}
+
+// ============================================================================
+// Graph Construction
+// ============================================================================
+
+int AIGSolver::input(int var) {
+    auto it = inputOf.find(var);
+    if (it != inputOf.end()) return 2 * it->second;
+    nodes.push_back({-1, -1, var});
+    inputOf[var] = nodes.size() - 1;
+    return 2 * (nodes.size() - 1);
+}
+
+/*
+ * AND with constant propagation and structural hashing. Dead nodes are
+ * dropped before the graph passes twice the node limit, and cofactoring
+ * adds at most twice the live cone, so beyond four times the limit it
+ * cannot be kept.
+ */
+int AIGSolver::mkAnd(int a, int b) {
+    if (aborted) return 0;
+    if (a > b) std::swap(a, b);
+    if (a == 0) return 0;              // false ∧ b
+    if (a == 1) return b;              // true ∧ b
+    if (a == b) return a;
+    if (a == (b ^ 1)) return 0;        // x ∧ ¬x
+
+    uint64_t key = ((uint64_t)(uint32_t)a << 32) | (uint32_t)b;
+    auto it = strash.find(key);
+    if (it != strash.end()) return 2 * it->second;
+
+    if ((long long)nodes.size() >= 4 * nodeLimit + 64) {
+        overflow = aborted = true;
+        return 0;
+    }
+    if (timeLimit > 0 && ++allocations >= 4096) {
+        allocations = 0;
+        if (std::chrono::steady_clock::now() >= deadline) {
+            aborted = true;
+            return 0;
+        }
+    }
+    nodes.push_back({a, b, -1});
+    strash[key] = nodes.size() - 1;
+    return 2 * (nodes.size() - 1);
+}
+
+int AIGSolver::literalOf(const Literal& lit) {
+    auto it = gateLit.find(lit.variable);
+    int f = (it != gateLit.end()) ? it->second : input(lit.variable);
+    return lit.isNegated ? f ^ 1 : f;
+}
+
+// Nodes reachable from the roots, in ascending (topological) order; the
+// cost is the cone's size, not the graph's
+std::vector<int> AIGSolver::coneOf(const std::vector<int>& roots) {
+    if (visited.size() < nodes.size()) visited.resize(nodes.size(), 0);
+    visitStamp++;
+    std::vector<int> cone, stack;
+    for (int root : roots) stack.push_back(root >> 1);
+    while (!stack.empty()) {
+        int id = stack.back();
+        stack.pop_back();
+        if (visited[id] == visitStamp) continue;
+        visited[id] = visitStamp;
+        cone.push_back(id);
+        if (nodes[id].left >= 0) {
+            stack.push_back(nodes[id].left >> 1);
+            stack.push_back(nodes[id].right >> 1);
+        }
+    }
+    std::sort(cone.begin(), cone.end());
+    return cone;
+}
+
+std::vector<int> AIGSolver::supportOf(int f) {
+    std::vector<int> vars;
+    for (int id : coneOf({f})) {
+        if (nodes[id].var >= 0) vars.push_back(nodes[id].var);
+    }
+    return vars;
+}
+
+// Value of f; inputs missing from values are false
+bool AIGSolver::evaluate(int f, const std::unordered_map<int, bool>& values) {
+    std::unordered_map<int, bool> value;
+    for (int id : coneOf({f})) {
+        const Node& node = nodes[id];
+        if (id == 0) {
+            value[id] = false;
+        } else if (node.left < 0) {
+            auto it = values.find(node.var);
+            value[id] = it != values.end() && it->second;
+        } else {
+            value[id] = (value[node.left >> 1] != (node.left & 1)) && (value[node.right >> 1] != (node.right & 1));
+        }
+    }
+    return value[f >> 1] != (f & 1);
+}
+
+// ============================================================================
+// Circuit Reconstruction
+// ============================================================================
+
+static int literalKey(const Literal& lit) {
+    return 2 * lit.variable + (lit.isNegated ? 1 : 0);
+}
+
+/*
+ * Definitions of existential variables by variables of the same or an
+ * earlier group:
+ *
+ *   AND   (¬o ∨ a1) ... (¬o ∨ ak) (o ∨ ¬a1 ∨ ... ∨ ¬ak), o = g or ¬g (OR)
+ *   XOR   the four ternary clauses over g, a, b that forbid one parity
+ *
+ * A variable may have several readings: the clauses of g = a ⊕ b also
+ * say a = g ⊕ b, and g ↔ h is a one-input AND both ways. Definitions are
+ * accepted inputs first, the first one whose inputs are all settled
+ * wins, and a clause defines at most one gate, so the gates never form a
+ * cycle.
+ */
+void AIGSolver::detectGates(const QBFPreprocessor& preprocessor, const std::unordered_map<int, int>& groupOf,
+                            const std::vector<bool>& universalGroup) {
+    gates.clear();
+    const auto& clauses = preprocessor.getClauses();
+    std::unordered_map<int, std::vector<int>> occurrences;
+    for (size_t c = 0; c < clauses.size(); c++) {
+        for (const auto& lit : clauses[c]) occurrences[literalKey(lit)].push_back(c);
+    }
+    auto earlier = [&](int input, int var) {
+        return input != var && groupOf.at(input) <= groupOf.at(var);
+    };
+
+    std::map<int, std::vector<Gate>> candidates;   // Variable → its definitions, XOR first
+    for (const auto& [var, group] : groupOf) {
+        if (universalGroup[group]) continue;
+
+        // XOR: group g's ternary clauses by their other two variables
+        std::map<std::pair<int, int>, std::vector<int>> byInputs;
+        for (bool negated : {false, true}) {
+            for (int c : occurrences[literalKey(Literal(var, negated))]) {
+                if (clauses[c].size() != 3) continue;
+                std::vector<int> others;
+                for (const auto& lit : clauses[c]) {
+                    if (lit.variable != var) others.push_back(lit.variable);
+                }
+                if (others.size() != 2 || others[0] == others[1]) continue;
+                std::sort(others.begin(), others.end());
+                byInputs[{others[0], others[1]}].push_back(c);
+            }
+        }
+        for (const auto& [inputs, list] : byInputs) {
+            if (list.size() < 4 || !earlier(inputs.first, var) || !earlier(inputs.second, var)) continue;
+
+            // The assignment each clause forbids, and its parity
+            std::map<int, int> forbidden;   // Assignment bits (g, a, b) → clause
+            int parity = -1;
+            bool consistent = true;
+            for (int c : list) {
+                int bits = 0, ones = 0;
+                for (const auto& lit : clauses[c]) {
+                    int bit = lit.variable == var ? 0 : lit.variable == inputs.first ? 1 : 2;
+                    if (lit.isNegated) {
+                        bits |= 1 << bit;
+                        ones++;
+                    }
+                }
+                if (parity >= 0 && ones % 2 != parity) consistent = false;
+                parity = ones % 2;
+                forbidden.emplace(bits, c);
+            }
+            if (!consistent || forbidden.size() != 4) continue;
+
+            // Odd assignments forbidden: g = a ⊕ b; even ones: g = ¬(a ⊕ b)
+            Gate gate;
+            gate.isXor = true;
+            gate.negated = (parity == 0);
+            gate.inputs = {Literal(inputs.first, false), Literal(inputs.second, false)};
+            for (const auto& entry : forbidden) gate.clauses.push_back(entry.second);
+            candidates[var].push_back(gate);
+        }
+
+        // AND
+        for (bool negated : {false, true}) {
+            Literal out(var, negated);
+            std::unordered_map<int, int> implied;   // Literal a → clause (¬o ∨ a)
+            for (int c : occurrences[literalKey(out.complement())]) {
+                if (clauses[c].size() != 2) continue;
+                const Literal& other = clauses[c][0].variable == var ? clauses[c][1] : clauses[c][0];
+                implied.emplace(literalKey(other), c);
+            }
+            for (int c : occurrences[literalKey(out)]) {
+                auto mentions = std::count_if(clauses[c].begin(), clauses[c].end(),
+                                              [&](const Literal& lit) { return lit.variable == var; });
+                if (clauses[c].size() < 2 || mentions != 1) continue;
+                Gate gate;
+                gate.negated = negated;
+                gate.clauses.push_back(c);
+                bool isDefinition = true;
+                for (const auto& lit : clauses[c]) {
+                    if (lit.variable == var) continue;
+                    auto it = implied.find(literalKey(lit.complement()));
+                    if (it == implied.end() || !earlier(lit.variable, var)) {
+                        isDefinition = false;
+                        break;
+                    }
+                    gate.inputs.push_back(lit.complement());
+                    gate.clauses.push_back(it->second);
+                }
+                if (isDefinition) candidates[var].push_back(gate);
+            }
+        }
+    }
+
+    // Accept definitions inputs first: one waits until each input is
+    // settled, as a gate or as a variable that stays. When all that is
+    // left waits on a cycle, its first variable stays a variable
+    std::map<std::pair<int, size_t>, int> waiting;   // (variable, definition) → inputs not settled
+    std::unordered_map<int, std::vector<std::pair<int, size_t>>> dependents;
+    std::vector<std::pair<int, size_t>> ready;
+    std::set<int> unsettled;
+    for (const auto& [var, definitions] : candidates) {
+        unsettled.insert(var);
+        for (size_t i = 0; i < definitions.size(); i++) {
+            int& count = waiting[{var, i}];
+            for (const auto& lit : definitions[i].inputs) {
+                if (!candidates.count(lit.variable)) continue;
+                count++;
+                dependents[lit.variable].emplace_back(var, i);
+            }
+            if (count == 0) ready.emplace_back(var, i);
+        }
+    }
+    auto settle = [&](int var) {
+        unsettled.erase(var);
+        for (const auto& dependent : dependents[var]) {
+            if (--waiting[dependent] == 0) ready.push_back(dependent);
+        }
+    };
+    std::vector<bool> used(clauses.size(), false);
+    size_t next = 0;
+    while (!unsettled.empty()) {
+        if (next == ready.size()) {
+            settle(*unsettled.begin());
+            continue;
+        }
+        auto [var, i] = ready[next++];
+        const Gate& gate = candidates[var][i];
+        if (!unsettled.count(var) ||
+            std::any_of(gate.clauses.begin(), gate.clauses.end(), [&](int c) { return used[c]; })) {
+            continue;
+        }
+        for (int c : gate.clauses) used[c] = true;
+        gates.emplace_back(var, gate);
+        settle(var);
+    }
+}
+
+// Definition of every gate, in terms of the non-gate variables
+void AIGSolver::buildGates() {
+    gateLit.clear();
+    for (const auto& [var, gate] : gates) {
+        int f = gate.isXor ? 0 : 1;
+        for (const auto& lit : gate.inputs) f = gate.isXor ? mkXor(f, literalOf(lit)) : mkAnd(f, literalOf(lit));
+        gateLit[var] = gate.negated ? f ^ 1 : f;
+    }
+}
+
+// ============================================================================
+// Elimination
+// ============================================================================
+
+/*
+ * ∃x f or ∀x f. Both cofactors come out of one pass over f's cone in
+ * topological order; a node that does not depend on x is its own cofactor.
+ */
+int AIGSolver::quantify(int f, int var, bool universal) {
+    auto it = inputOf.find(var);
+    if (it == inputOf.end()) return f;
+    int x = it->second;
+
+    std::vector<int> cone = coneOf({f});
+    if (!std::binary_search(cone.begin(), cone.end(), x)) return f;
+    size_t size = nodes.size();
+    std::vector<int> lo(size), hi(size);
+    std::vector<char> depends(size, 0);
+    for (int id : cone) {
+        Node node = nodes[id];  // Copy: mkAnd may grow nodes
+        if (id == x) {
+            lo[id] = 0;
+            hi[id] = 1;
+            depends[id] = 1;
+        } else if (node.left < 0 || !(depends[node.left >> 1] || depends[node.right >> 1])) {
+            lo[id] = hi[id] = 2 * id;
+        } else {
+            depends[id] = 1;
+            int l = node.left, r = node.right;
+            lo[id] = mkAnd(lo[l >> 1] ^ (l & 1), lo[r >> 1] ^ (r & 1));
+            hi[id] = mkAnd(hi[l >> 1] ^ (l & 1), hi[r >> 1] ^ (r & 1));
+        }
+    }
+    int f0 = lo[f >> 1] ^ (f & 1), f1 = hi[f >> 1] ^ (f & 1);
+    return universal ? mkAnd(f0, f1) : mkOr(f0, f1);
+}
+
+/*
+ * Copy the roots' cones into a fresh graph. Gate definitions are dropped
+ * with the old graph; buildGates() makes them again.
+ */
+void AIGSolver::rebuild(std::vector<int>& roots) {
+    std::vector<int> cone = coneOf(roots);
+    std::vector<Node> old;
+    old.swap(nodes);
+    strash.clear();
+    inputOf.clear();
+    gateLit.clear();
+    nodes.push_back({-1, -1, -1});
+
+    std::vector<int> renamed(old.size(), 0);
+    for (int id : cone) {
+        const Node& node = old[id];
+        if (id == 0) {
+            renamed[id] = 0;
+        } else if (node.left < 0) {
+            renamed[id] = input(node.var);
+        } else {
+            renamed[id] = mkAnd(renamed[node.left >> 1] ^ (node.left & 1), renamed[node.right >> 1] ^ (node.right & 1));
+        }
+    }
+    for (int& root : roots) root = renamed[root >> 1] ^ (root & 1);
+}
+
+/*
+ * Between eliminations only the roots are alive: sweep once their cone
+ * has doubled since the last sweep, and drop the dead nodes once the
+ * graph has doubled since the last rebuild. False once a limit is hit.
+ */
+bool AIGSolver::safePoint(std::vector<int>& roots) {
+    if (timeLimit > 0 && std::chrono::steady_clock::now() >= deadline) aborted = true;
+    if (aborted) return false;
+    long long live = coneOf(roots).size();
+    stats.aigPeakNodes = std::max(stats.aigPeakNodes, live);
+    if (live > nodeLimit) {
+        overflow = aborted = true;
+        return false;
+    }
+    if (live > sweepThreshold) {
+        sweep(roots);
+        live = nodes.size();
+        sweepThreshold = std::max(sweepThreshold, 2 * live);
+    }
+    if ((long long)nodes.size() > gcThreshold) {
+        rebuild(roots);
+        live = nodes.size();
+        gcThreshold = std::min(std::max(MIN_GC_NODES, 2 * live), 2 * nodeLimit);
+    }
+    return !aborted;
+}
+
+// ============================================================================
+// SAT Sweeping
+// ============================================================================
+
+/*
+ * Simulate the live graph on random patterns, then copy it into a fresh
+ * graph in topological order. Each node whose signature it shares with
+ * an earlier node (up to negation; the constant node comes first, so
+ * constant nodes turn into 0 or 1) is checked against that node and
+ * merged into it if they are equivalent. The checks run on the new
+ * graph, where the nodes below are merged already, so the miters stay
+ * small.
+ */
+void AIGSolver::sweep(std::vector<int>& roots) {
+    std::vector<int> cone = coneOf(roots);
+    if (cone.empty() || cone[0] != 0) cone.insert(cone.begin(), 0);
+
+    std::mt19937_64 random(12345);
+    std::vector<uint64_t> sim(nodes.size() * SIM_WORDS, 0);
+    for (int id : cone) {
+        const Node& node = nodes[id];
+        for (int w = 0; w < SIM_WORDS; w++) {
+            uint64_t& word = sim[id * SIM_WORDS + w];
+            if (id == 0) {
+                word = 0;
+            } else if (node.left < 0) {
+                word = random();
+            } else {
+                uint64_t l = sim[(node.left >> 1) * SIM_WORDS + w] ^ ((node.left & 1) ? ~0ULL : 0);
+                uint64_t r = sim[(node.right >> 1) * SIM_WORDS + w] ^ ((node.right & 1) ? ~0ULL : 0);
+                word = l & r;
+            }
+        }
+    }
+
+    std::vector<Node> old;
+    old.swap(nodes);
+    strash.clear();
+    inputOf.clear();
+    gateLit.clear();
+    nodes.push_back({-1, -1, -1});
+
+    // Signatures up to negation: the first pattern's value is false
+    std::map<std::vector<uint64_t>, int> classes;   // Signature → new literal of the first member
+    std::vector<int> renamed(old.size(), 0);
+    long long merged = 0, satCalls = 0, satFailures = 0;
+    for (int id : cone) {
+        const Node& node = old[id];
+        if (id == 0) {
+            renamed[id] = 0;
+        } else if (node.left < 0) {
+            renamed[id] = input(node.var);
+        } else {
+            renamed[id] = mkAnd(renamed[node.left >> 1] ^ (node.left & 1), renamed[node.right >> 1] ^ (node.right & 1));
+        }
+        if (aborted) return;
+
+        int phase = sim[id * SIM_WORDS] & 1;
+        std::vector<uint64_t> signature(sim.begin() + id * SIM_WORDS, sim.begin() + (id + 1) * SIM_WORDS);
+        if (phase) {
+            for (auto& word : signature) word = ~word;
+        }
+        auto [it, inserted] = classes.emplace(signature, renamed[id] ^ phase);
+        if (inserted || node.left < 0) continue;
+        int candidate = it->second ^ phase;
+        if (renamed[id] != candidate && equivalent(renamed[id], candidate, satCalls, satFailures)) {
+            renamed[id] = candidate;
+            merged++;
+        }
+        if (aborted) return;
+    }
+    for (int& root : roots) root = renamed[root >> 1] ^ (root & 1);
+    if (merged > 0) rebuild(roots);
+
+    stats.aigMerges += merged;
+    if (verbose) {
+        std::cout << "[AIG] SAT sweeping: " << merged << " of " << cone.size() << " nodes merged (" << satCalls
+                  << " SAT calls), " << coneOf(roots).size() << " nodes left" << std::endl;
+    }
+}
+
+// a ≡ b, proven on all input patterns or by an UNSAT miter a ⊕ b
+bool AIGSolver::equivalent(int a, int b, long long& satCalls, long long& satFailures) {
+    std::vector<int> cone = coneOf({a, b});
+    std::unordered_map<int, int> position;
+    std::vector<int> inputs;
+    for (size_t i = 0; i < cone.size(); i++) {
+        position[cone[i]] = i;
+        if (nodes[cone[i]].left < 0 && cone[i] != 0) inputs.push_back(cone[i]);
+    }
+
+    if (inputs.size() <= EXHAUSTIVE_VARS) {
+        // Input i follows bit i of the pattern number
+        static const uint64_t LOW[6] = {0xAAAAAAAAAAAAAAAAULL, 0xCCCCCCCCCCCCCCCCULL, 0xF0F0F0F0F0F0F0F0ULL,
+                                        0xFF00FF00FF00FF00ULL, 0xFFFF0000FFFF0000ULL, 0xFFFFFFFF00000000ULL};
+        size_t words = std::max<size_t>(1, ((size_t)1 << inputs.size()) / 64);
+        std::vector<uint64_t> value(cone.size() * words, 0);
+        std::unordered_map<int, int> inputIndex;
+        for (size_t i = 0; i < inputs.size(); i++) inputIndex[inputs[i]] = i;
+        for (size_t p = 0; p < cone.size(); p++) {
+            const Node& node = nodes[cone[p]];
+            for (size_t w = 0; w < words; w++) {
+                uint64_t& word = value[p * words + w];
+                if (cone[p] == 0) {
+                    word = 0;
+                } else if (node.left < 0) {
+                    int i = inputIndex[cone[p]];
+                    word = i < 6 ? LOW[i] : (((w >> (i - 6)) & 1) ? ~0ULL : 0);
+                } else {
+                    uint64_t l = value[position[node.left >> 1] * words + w] ^ ((node.left & 1) ? ~0ULL : 0);
+                    uint64_t r = value[position[node.right >> 1] * words + w] ^ ((node.right & 1) ? ~0ULL : 0);
+                    word = l & r;
+                }
+            }
+        }
+        uint64_t mask = inputs.size() >= 6 ? ~0ULL : (1ULL << (1 << inputs.size())) - 1;
+        for (size_t w = 0; w < words; w++) {
+            uint64_t va = value[position[a >> 1] * words + w] ^ ((a & 1) ? ~0ULL : 0);
+            uint64_t vb = value[position[b >> 1] * words + w] ^ ((b & 1) ? ~0ULL : 0);
+            if ((va ^ vb) & mask) return false;
+        }
+        return true;
+    }
+
+    if (satFailures >= SWEEP_MAX_SAT_FAILURES) return false;
+    satCalls++;
+
+    // Tseitin encoding of both cones (node i is variable i + 1), plus a ≠ b
+    auto literal = [&](int f) { return Literal((f >> 1) + 1, f & 1); };
+    QBFPreprocessor miter;
+    std::vector<int> vars;
+    for (int id : cone) vars.push_back(id + 1);
+    miter.addQuantifierBlock(Quantifier::EXISTS, vars);
+    for (int id : cone) {
+        const Node& node = nodes[id];
+        Literal z(id + 1, false);
+        if (id == 0) {
+            miter.addClause({z.complement()});
+        } else if (node.left >= 0) {
+            miter.addClause({z.complement(), literal(node.left)});
+            miter.addClause({z.complement(), literal(node.right)});
+            miter.addClause({z, literal(node.left).complement(), literal(node.right).complement()});
+        }
+    }
+    miter.addClause({literal(a), literal(b)});
+    miter.addClause({literal(a).complement(), literal(b).complement()});
+
+    QCDCLSolver solver;
+    double seconds = SWEEP_SAT_SECONDS;
+    if (timeLimit > 0) {
+        double left = std::chrono::duration<double>(deadline - std::chrono::steady_clock::now()).count();
+        if (left <= 0) return false;
+        seconds = std::min(seconds, left);
+    }
+    solver.setTimeLimit(seconds);
+    if (solver.solve(miter) == Result::UNSAT) return true;
+    satFailures++;
+    return false;
+}
+
+// ============================================================================
+// Outer-Block Reports
+// ============================================================================
+
+/*
+ * A winning assignment of the outer group's variables, if W has one:
+ * W_k = W, W_(i-1) = ∃x_i W_i, and W_i only depends on x_1..x_i, so once
+ * x_1..x_(i-1) are set with W_(i-1) true, some value of x_i keeps W_i
+ * true. Variables outside W's support are set to false.
+ */
+bool AIGSolver::findPlan(int winning, std::unordered_map<int, bool>& plan) {
+    std::vector<int> vars = supportOf(winning);
+    std::vector<int> chain(vars.size() + 1);
+    chain[vars.size()] = winning;
+    for (size_t i = vars.size(); i-- > 0;) {
+        chain[i] = quantify(chain[i + 1], vars[i], false);
+        if (aborted) return false;
+    }
+    if (chain[0] != 1) return false;
+
+    plan.clear();
+    if (!groups.empty()) {
+        for (int var : groups[0]) plan[var] = false;
+    }
+    for (size_t i = 0; i < vars.size(); i++) {
+        plan[vars[i]] = true;
+        if (!evaluate(chain[i + 1], plan)) plan[vars[i]] = false;
+    }
+
+    // Gates follow from their inputs
+    for (const auto& [var, gate] : gates) {
+        if (outer.isOuter(var)) plan[var] = evaluate(gateLit.at(var), plan);
+    }
+    return true;
+}
+
+/*
+ * Forced outer literals, as in QBFBackbone: each value of the winning
+ * assignment is a candidate; it is forced if W with it flipped has no
+ * winning assignment, and every other winning assignment found on the
+ * way rules out the candidates it disagrees with.
+ */
+void AIGSolver::reportOuter(Result result, int winning, std::unordered_map<int, bool>& plan) {
+    if (!outer.active()) return;
+    bool wasOverflow = overflow;
+    bool proven = false;
+    if (result == Result::SAT) {
+        proven = true;
+        std::vector<std::pair<int, bool>> candidates;
+        for (const auto& [var, value] : plan) {
+            if (outer.isOuter(var)) candidates.emplace_back(var, value);
+        }
+        std::sort(candidates.begin(), candidates.end());
+        for (size_t i = 0; i < candidates.size() && !aborted; i++) {
+            auto [var, value] = candidates[i];
+            if (var == 0) continue;  // Ruled out
+            auto gate = gateLit.find(var);
+            int lit = gate != gateLit.end() ? gate->second : input(var);
+            int flipped = mkAnd(winning, value ? lit ^ 1 : lit);
+            std::unordered_map<int, bool> other;
+            if (!findPlan(flipped, other)) {
+                if (aborted) break;
+                if (verbose) {
+                    std::cout << "[OUTER] x" << var << "=" << (value ? "true" : "false")
+                              << " is forced in every winning assignment" << std::endl;
+                }
+                outer.forcedFound(var, value);
+                continue;
+            }
+            for (size_t j = i + 1; j < candidates.size(); j++) {
+                auto it = other.find(candidates[j].first);
+                if (candidates[j].first != 0 && it != other.end() && it->second != candidates[j].second) {
+                    candidates[j].first = 0;
+                }
+            }
+        }
+        for (const auto& [var, value] : plan) assignments[var] = value;
+    }
+
+    // The answer stands; running out of nodes here only ends the report
+    overflow = wasOverflow;
+    outer.finish(proven, result == Result::UNSAT, [&](int var) {
+        auto it = assignments.find(var);
+        if (it != assignments.end()) return it->second ? 1 : 0;
+        return -1;
+    });
+}
+
+// ============================================================================
+// Main Entry Point
+// ============================================================================
+
+Result AIGSolver::solve(const QBFPreprocessor& preprocessor) {
+    stats = SolverStats();
+    stats.engine = "aig";
+    overflow = aborted = false;
+    allocations = 0;
+    gcThreshold = std::min(MIN_GC_NODES, 2 * nodeLimit);
+    sweepThreshold = std::min(FIRST_SWEEP_NODES, nodeLimit / 4);
+    if (timeLimit > 0) {
+        deadline = std::chrono::steady_clock::now() +
+                   std::chrono::duration_cast<std::chrono::steady_clock::duration>(
+                       std::chrono::duration<double>(timeLimit));
+    }
+    outer.reset(preprocessor, outerCallback);
+    assignments = preprocessor.getAssignments();
+    nodes.assign(1, {-1, -1, -1});
+    strash.clear();
+    inputOf.clear();
+
+    // Quantifier groups in prefix order (free variables are EXISTS)
+    std::unordered_map<int, Quantifier> quantifierOf;
+    for (const auto& block : preprocessor.getQuantifierBlocks()) {
+        for (int var : block.variables) quantifierOf[var] = block.type;
+    }
+    auto isUniversal = [&](int var) {
+        auto it = quantifierOf.find(var);
+        return it != quantifierOf.end() && it->second == Quantifier::FORALL;
+    };
+    std::vector<int> order = prefixVariableOrder(preprocessor);
+    std::unordered_map<int, int> groupOf;
+    std::vector<bool> universalGroup;
+    for (int var : order) {
+        if (universalGroup.empty() || isUniversal(var) != universalGroup.back()) universalGroup.push_back(isUniversal(var));
+        groupOf[var] = universalGroup.size() - 1;
+    }
+
+    detectGates(preprocessor, groupOf, universalGroup);
+    stats.aigGates = gates.size();
+    buildGates();
+
+    // The variables left to eliminate; without the gates between them,
+    // neighbouring groups of the same quantifier merge
+    groups.clear();
+    groupUniversal.clear();
+    for (int var : order) {
+        if (gateLit.count(var)) continue;
+        if (groups.empty() || isUniversal(var) != groupUniversal.back()) {
+            groups.emplace_back();
+            groupUniversal.push_back(isUniversal(var));
+        }
+        groups.back().push_back(var);
+    }
+
+    // The matrix: every clause that defines no gate, ANDed as a balanced tree
+    std::vector<bool> definition(preprocessor.getClauses().size(), false);
+    for (const auto& [var, gate] : gates) {
+        for (int c : gate.clauses) definition[c] = true;
+    }
+    std::vector<int> conjuncts;
+    for (size_t c = 0; c < preprocessor.getClauses().size(); c++) {
+        if (definition[c]) continue;
+        int clause = 0;
+        for (const auto& lit : preprocessor.getClauses()[c]) clause = mkOr(clause, literalOf(lit));
+        conjuncts.push_back(clause);
+    }
+    while (conjuncts.size() > 1) {
+        std::vector<int> next;
+        for (size_t i = 0; i + 1 < conjuncts.size(); i += 2) next.push_back(mkAnd(conjuncts[i], conjuncts[i + 1]));
+        if (conjuncts.size() % 2) next.push_back(conjuncts.back());
+        conjuncts.swap(next);
+    }
+    std::vector<int> roots = {conjuncts.empty() ? 1 : conjuncts[0]};
+    stats.aigPeakNodes = coneOf(roots).size();
+    if (verbose) {
+        size_t numVars = 0;
+        for (const auto& group : groups) numVars += group.size();
+        std::cout << "[SOLVE] AIG with " << stats.aigPeakNodes << " nodes: " << gates.size()
+                  << " gate definitions substituted, " << numVars << " variables in " << groups.size()
+                  << " quantifier blocks to eliminate" << std::endl;
+    }
+    if (!aborted) sweep(roots);
+
+    // Eliminate from the innermost group out; with outer reports, stop
+    // before the outer EXISTS group
+    int stop = (outer.active() && (groups.empty() || !groupUniversal[0])) ? 1 : 0;
+    for (int g = (int)groups.size() - 1; g >= stop && roots[0] > 1 && !aborted; g--) {
+        for (size_t i = groups[g].size(); i-- > 0 && roots[0] > 1;) {
+            int var = groups[g][i];
+            long long before = verbose ? coneOf(roots).size() : 0;
+            roots[0] = quantify(roots[0], var, groupUniversal[g]);
+            if (aborted || !safePoint(roots)) break;
+            if (verbose) {
+                std::cout << "[AIG] " << (groupUniversal[g] ? "FORALL x" : "EXISTS x") << var << ": " << before
+                          << " -> " << coneOf(roots).size() << " nodes" << std::endl;
+            }
+        }
+    }
+    stats.aigPeakNodes = std::max(stats.aigPeakNodes, (long long)coneOf(roots).size());
+
+    // What is left: the winning outer assignments
+    std::unordered_map<int, bool> plan;
+    bool refuted = roots[0] == 0;
+    if (!aborted && !refuted && stop == 1) {
+        buildGates();
+        refuted = !findPlan(roots[0], plan);
+    }
+
+    Result result = Result::SAT;
+    if (aborted) {
+        result = Result::UNKNOWN;
+        if (verbose) {
+            std::cout << (overflow ? "[AIG] Node limit reached (" + std::to_string(nodeLimit) + " nodes)"
+                                   : std::string("[TIMEOUT] Time limit reached"))
+                      << std::endl;
+        }
+    } else if (refuted) {
+        result = Result::UNSAT;
+    }
+    if (verbose && result != Result::UNKNOWN) {
+        std::cout << "[AIG] " << (result == Result::UNSAT ? "The matrix became false: false"
+                                  : stop == 1            ? "Winning outer assignments left: true"
+                                                         : "Every variable eliminated: true")
+                  << " (peak " << stats.aigPeakNodes << " nodes)" << std::endl;
+    }
+
+    if (!overflow) reportOuter(result, roots[0], plan);
+    return result;
+}
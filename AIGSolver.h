@@ -0,0 +1,162 @@
+/*
+ * AIGSolver.h - QBF by Quantifier Elimination on And-Inverter Graphs
+ *
+ * Formulas from hardware verification are circuits turned into CNF: each
+ * gate output g gets clauses saying g ↔ AND(a, b), g ↔ a ⊕ b, and so on.
+ * Read back as a circuit, the matrix is far smaller than its clauses,
+ * and the gate variables need no quantifier at all: g is whatever its
+ * inputs make it.
+ *
+ * AND-INVERTER GRAPH (AIG). Every function is built from two-input ANDs
+ * and negation. A node is an input variable or the AND of two LITERALS
+ * (node references with an optional negation bit), node 0 is the
+ * constant false:
+ *
+ *   a ∨ b = ¬(¬a ∧ ¬b)        a ⊕ b = ¬(a ∧ b) ∧ ¬(¬a ∧ ¬b)
+ *
+ * STRUCTURAL HASHING keeps one node per (left, right) pair, so identical
+ * subcircuits are built once, and CONSTANT PROPAGATION answers x ∧ 0,
+ * x ∧ 1, x ∧ x and x ∧ ¬x without a node.
+ *
+ * GATES. An existential variable g whose clauses define it as an AND, OR
+ * or XOR of variables quantified no later (the patterns of QCDCLSolver's
+ * dual propagation, plus two-input XOR) is replaced by its definition:
+ *
+ *   ∃g ((g ↔ φ) ∧ M)  =  M[g := φ]      (φ only uses variables g sees)
+ *
+ * The definition clauses disappear and the matrix becomes one AIG over
+ * the remaining variables.
+ *
+ * ELIMINATION. The variables are then eliminated from the innermost
+ * block out by COFACTORING: f[x=0] and f[x=1] are rebuilt from f's cone,
+ * sharing everything that does not depend on x, and combined:
+ *
+ *   ∃x f = f[x=0] ∨ f[x=1]        ∀x f = f[x=0] ∧ f[x=1]
+ *
+ * Each step can double the graph. Two nodes of different structure may
+ * still compute the same function, and SAT SWEEPING finds them: random
+ * simulation sorts the nodes into classes of equal signature (up to
+ * negation), and each candidate pair is proven equivalent - exhaustively
+ * when they depend on few inputs, by a SAT call (QCDCLSolver on a purely
+ * existential miter) otherwise - before one is merged into the other.
+ *
+ * Past the node limit the solve gives up (exceededNodeLimit()) and the
+ * caller falls back to the engine the features would pick (QCDCL).
+ *
+ * With an outer callback (QBFOuter.h) elimination stops before the outer
+ * EXISTS group; the AIG W that is left holds exactly for the winning
+ * outer assignments. Eliminating its variables one by one keeps the
+ * chain W = W_k, W_(k-1) = ∃x_k W_k, ..., from which a winning assignment
+ * is read off forwards; a literal is forced if W without it is false.
+ */
+
+#ifndef AIG_SOLVER_H
+#define AIG_SOLVER_H
+
+#include "QBFOuter.h"
+#include "QBFPreprocessor.h"
+#include "QBFSolver.h"
+#include <chrono>
+#include <cstdint>
+#include <unordered_map>
+#include <vector>
+
+class AIGSolver {
+public:
+    AIGSolver();
+
+    void setVerbose(bool enabled);
+
+    // Give up with Result::UNKNOWN after this many seconds (0 = no limit)
+    void setTimeLimit(double seconds);
+
+    // Give up with Result::UNKNOWN when the graph outgrows this many nodes
+    void setNodeLimit(long long nodes);
+
+    // Report the winning outer assignment and the forced outer literals
+    void setOuterCallback(const OuterCallback& callback);
+
+    Result solve(const QBFPreprocessor& preprocessor);
+
+    // UNKNOWN because of the node limit (not the time limit)
+    bool exceededNodeLimit() const { return overflow; }
+
+    // Outer variables of the winning assignment (with an outer callback)
+    const std::unordered_map<int, bool>& getAssignments() const { return assignments; }
+
+    const SolverStats& getStats() const { return stats; }
+
+private:
+    // AND of two literals (2 * node + negated), or an input (left = -1)
+    struct Node {
+        int left;
+        int right;
+        int var;   // Input variable, -1 for ANDs and the constant
+    };
+
+    // A gate definition found in the clauses: out ↔ AND(inputs) or
+    // out ↔ XOR(inputs), out possibly negated
+    struct Gate {
+        bool isXor = false;
+        bool negated = false;
+        std::vector<Literal> inputs;
+        std::vector<int> clauses;   // Definition clauses
+    };
+
+    std::vector<Node> nodes;
+    std::unordered_map<uint64_t, int> strash;   // (left, right) → node
+    std::unordered_map<int, int> inputOf;       // Variable → input node
+
+    std::vector<std::pair<int, Gate>> gates;    // Accepted gates, inputs before outputs
+    std::unordered_map<int, int> gateLit;       // Gate variable → its definition (built by buildGates)
+    std::vector<std::vector<int>> groups;       // Variables to eliminate, by quantifier group
+    std::vector<bool> groupUniversal;           // (gate variables are not eliminated)
+
+    long long nodeLimit;
+    long long gcThreshold;      // Rebuild the graph from the roots above this many nodes
+    long long sweepThreshold;   // Sweep above this many live nodes
+    bool overflow;
+    bool aborted;               // Node or time limit hit; mkAnd returns 0
+    long long allocations;      // New nodes since the last look at the clock
+    std::vector<int> visited;   // Stamps for coneOf()
+    int visitStamp;
+
+    bool verbose;
+    double timeLimit;
+    std::chrono::steady_clock::time_point deadline;
+
+    OuterCallback outerCallback;
+    OuterTracker outer;
+    std::unordered_map<int, bool> assignments;
+    SolverStats stats;
+
+    // Graph construction
+    int input(int var);
+    int mkAnd(int a, int b);
+    int mkOr(int a, int b) { return mkAnd(a ^ 1, b ^ 1) ^ 1; }
+    int mkXor(int a, int b) { return mkAnd(mkAnd(a, b) ^ 1, mkAnd(a ^ 1, b ^ 1) ^ 1); }
+    int literalOf(const Literal& lit);
+    std::vector<int> coneOf(const std::vector<int>& roots);
+    std::vector<int> supportOf(int f);
+    bool evaluate(int f, const std::unordered_map<int, bool>& values);
+
+    // Circuit reconstruction
+    void detectGates(const QBFPreprocessor& preprocessor, const std::unordered_map<int, int>& groupOf,
+                     const std::vector<bool>& universalGroup);
+    void buildGates();
+
+    // Elimination
+    int quantify(int f, int var, bool universal);
+    bool safePoint(std::vector<int>& roots);
+    void rebuild(std::vector<int>& roots);
+
+    // SAT sweeping
+    void sweep(std::vector<int>& roots);
+    bool equivalent(int a, int b, long long& satCalls, long long& satFailures);
+
+    // Outer-block reports
+    bool findPlan(int winning, std::unordered_map<int, bool>& plan);
+    void reportOuter(Result result, int winning, std::unordered_map<int, bool>& plan);
+};
+
+#endif // AIG_SOLVER_H
@@ -0,0 +1,818 @@
+/*
+ * BDDSolver.cpp - ROBDD package and quantifier elimination
+ */
+
+#include "BDDSolver.h"
+#include "QBFFeatures.h"
+#include <algorithm>
+#include <climits>
+#include <iostream>
+
+// Computed cache entries (a power of two): it starts small and grows
+// with the diagrams, up to the maximum
+static const size_t MIN_CACHE_SIZE = 1 << 14;
+static const size_t MAX_CACHE_SIZE = 1 << 22;
+
+// Collect garbage once this many nodes are allocated, at the least
+static const long long MIN_GC_NODES = 1 << 16;
+
+// First dynamic reordering at this many live nodes; later ones once the
+// live nodes have doubled since the last
+static const long long FIRST_REORDER_NODES = 10000;
+
+// Sifting: the variables with the most nodes, moved until the diagrams
+// grow by this factor, and at most this many level swaps per reordering
+static const size_t SIFT_MAX_VARS = 24;
+static const double SIFT_MAX_GROWTH = 1.2;
+static const long long SIFT_MAX_SWAPS = 2000;
+
+BDDSolver::BDDSolver()
+    : cacheEpoch(0), visitStamp(0), nodeLimit(1000000), gcThreshold(MIN_GC_NODES),
+      reorderThreshold(FIRST_REORDER_NODES), swapsLeft(0), counting(false), overflow(false), aborted(false),
+      verbose(false), timeLimit(0), opsSinceCheck(0) {}
+
+void BDDSolver::setVerbose(bool enabled) {
+    verbose = enabled;
+}
+
+void BDDSolver::setTimeLimit(double seconds) {
+    timeLimit = seconds;
+}
+
+void BDDSolver::setNodeLimit(long long value) {
+    nodeLimit = std::max(2LL, value);
+}
+
+void BDDSolver::setOuterCallback(const OuterCallback& callback) {
+    outerCallback = callback;
+}
+
+// ============================================================================
+// Nodes, Unique Table and Computed Cache
+// ============================================================================
+
+// Constants sit below every variable
+int BDDSolver::level(int f) const {
+    return f < 2 ? INT_MAX : levelOf[nodes[f].var];
+}
+
+static inline size_t hashPair(int lo, int hi) {
+    return (size_t)lo * 12582917u ^ (size_t)hi * 4256249u;
+}
+
+void BDDSolver::insertUnique(int f) {
+    Subtable& table = unique[nodes[f].var];
+    if (table.count + 1 > 2 * (int)table.buckets.size()) growSubtable(nodes[f].var);
+    size_t h = hashPair(nodes[f].lo, nodes[f].hi) & (table.buckets.size() - 1);
+    nodes[f].next = table.buckets[h];
+    table.buckets[h] = f;
+    table.count++;
+}
+
+void BDDSolver::growSubtable(int var) {
+    Subtable& table = unique[var];
+    std::vector<int> members;
+    for (int head : table.buckets) {
+        for (int f = head; f >= 0; f = nodes[f].next) members.push_back(f);
+    }
+    table.buckets.assign(table.buckets.size() * 2, -1);
+    for (int f : members) {
+        size_t h = hashPair(nodes[f].lo, nodes[f].hi) & (table.buckets.size() - 1);
+        nodes[f].next = table.buckets[h];
+        table.buckets[h] = f;
+    }
+}
+
+/*
+ * The node (var, lo, hi), built only if it does not exist yet. A test
+ * whose two outcomes agree is no test at all: mk(x, f, f) = f.
+ */
+int BDDSolver::mk(int var, int lo, int hi) {
+    if (lo == hi) return lo;
+    const Subtable& table = unique[var];
+    size_t h = hashPair(lo, hi) & (table.buckets.size() - 1);
+    for (int f = table.buckets[h]; f >= 0; f = nodes[f].next) {
+        if (nodes[f].lo == lo && nodes[f].hi == hi) return f;
+    }
+
+    int f;
+    if (!freeSlots.empty()) {
+        f = freeSlots.back();
+        freeSlots.pop_back();
+        nodes[f] = {var, lo, hi, -1};
+    } else {
+        f = nodes.size();
+        nodes.push_back({var, lo, hi, -1});
+    }
+    insertUnique(f);
+    if (counting) {
+        if (refs.size() < nodes.size()) refs.resize(nodes.size(), 0);
+        refs[f] = 0;
+        ref(lo);
+        ref(hi);
+    }
+    stats.bddPeakNodes = std::max(stats.bddPeakNodes, liveNodes() - 2);
+    return f;
+}
+
+/*
+ * Called once per recursive step of an operation: false once the node
+ * limit or the time limit is hit. The operations then unwind returning 0,
+ * and the caller sees aborted.
+ */
+bool BDDSolver::budget() {
+    if (aborted) return false;
+    if (liveNodes() >= nodeLimit) {
+        overflow = aborted = true;
+        return false;
+    }
+    if (timeLimit > 0 && ++opsSinceCheck >= 65536) {
+        opsSinceCheck = 0;
+        if (std::chrono::steady_clock::now() >= deadline) aborted = true;
+    }
+    return !aborted;
+}
+
+static inline size_t hashOp(int op, int a, int b, int c) {
+    return ((size_t)op * 0x9E3779B1u) ^ ((size_t)a * 0x85EBCA6Bu) ^ ((size_t)b * 0xC2B2AE35u) ^
+           ((size_t)c * 0x27D4EB2Fu);
+}
+
+int BDDSolver::cacheLookup(Op op, int a, int b, int c) const {
+    const CacheEntry& entry = cache[hashOp(op, a, b, c) & (cache.size() - 1)];
+    if (entry.epoch == cacheEpoch && entry.op == op && entry.a == a && entry.b == b && entry.c == c) {
+        return entry.result;
+    }
+    return -1;
+}
+
+void BDDSolver::cacheStore(Op op, int a, int b, int c, int result) {
+    cache[hashOp(op, a, b, c) & (cache.size() - 1)] = {cacheEpoch, op, a, b, c, result};
+}
+
+// ============================================================================
+// Operations
+// ============================================================================
+
+/*
+ * Shannon expansion on the topmost variable of the two arguments:
+ *   a ∧ b = mk(x, a[x=0] ∧ b[x=0], a[x=1] ∧ b[x=1])
+ * An argument that does not test x is its own cofactor.
+ */
+int BDDSolver::andOp(int a, int b) {
+    if (a == 0 || b == 0) return 0;
+    if (a == 1) return b;
+    if (b == 1 || a == b) return a;
+    if (a > b) std::swap(a, b);
+    int cached = cacheLookup(AND, a, b, 0);
+    if (cached >= 0) return cached;
+    if (!budget()) return 0;
+
+    int top = std::min(level(a), level(b));
+    int var = varAt[top];
+    int a0 = a, a1 = a, b0 = b, b1 = b;
+    if (level(a) == top) a0 = nodes[a].lo, a1 = nodes[a].hi;
+    if (level(b) == top) b0 = nodes[b].lo, b1 = nodes[b].hi;
+    int lo = andOp(a0, b0);
+    int hi = andOp(a1, b1);
+    if (aborted) return 0;
+    int result = mk(var, lo, hi);
+    cacheStore(AND, a, b, 0, result);
+    return result;
+}
+
+int BDDSolver::orOp(int a, int b) {
+    if (a == 1 || b == 1) return 1;
+    if (a == 0) return b;
+    if (b == 0 || a == b) return a;
+    if (a > b) std::swap(a, b);
+    int cached = cacheLookup(OR, a, b, 0);
+    if (cached >= 0) return cached;
+    if (!budget()) return 0;
+
+    int top = std::min(level(a), level(b));
+    int var = varAt[top];
+    int a0 = a, a1 = a, b0 = b, b1 = b;
+    if (level(a) == top) a0 = nodes[a].lo, a1 = nodes[a].hi;
+    if (level(b) == top) b0 = nodes[b].lo, b1 = nodes[b].hi;
+    int lo = orOp(a0, b0);
+    int hi = orOp(a1, b1);
+    if (aborted) return 0;
+    int result = mk(var, lo, hi);
+    cacheStore(OR, a, b, 0, result);
+    return result;
+}
+
+// ∃var f = f[var=0] ∨ f[var=1], ∀var f = f[var=0] ∧ f[var=1]
+int BDDSolver::quantify(int f, int var, bool exists) {
+    if (f < 2 || level(f) > levelOf[var]) return f;
+    Op op = exists ? EXISTS : FORALL;
+    int cached = cacheLookup(op, f, var, 0);
+    if (cached >= 0) return cached;
+    if (!budget()) return 0;
+
+    int top = nodes[f].var, lo = nodes[f].lo, hi = nodes[f].hi;
+    int result;
+    if (top == var) {
+        result = exists ? orOp(lo, hi) : andOp(lo, hi);
+    } else {
+        int qlo = quantify(lo, var, exists);
+        int qhi = quantify(hi, var, exists);
+        if (aborted) return 0;
+        result = mk(top, qlo, qhi);
+    }
+    if (aborted) return 0;
+    cacheStore(op, f, var, 0, result);
+    return result;
+}
+
+/*
+ * ∃var (a ∧ b) in one pass. Below var the product is never needed in
+ * full: at var's level the two halves are ORed right away, and a true
+ * first half makes the second one unnecessary.
+ */
+int BDDSolver::andExists(int a, int b, int var) {
+    if (a == 0 || b == 0) return 0;
+    if (a == 1 || a == b) return quantify(b, var, true);
+    if (b == 1) return quantify(a, var, true);
+    int top = std::min(level(a), level(b));
+    if (top > levelOf[var]) return andOp(a, b);
+    if (a > b) std::swap(a, b);
+    int cached = cacheLookup(AND_EXISTS, a, b, var);
+    if (cached >= 0) return cached;
+    if (!budget()) return 0;
+
+    int topVar = varAt[top];
+    int a0 = a, a1 = a, b0 = b, b1 = b;
+    if (level(a) == top) a0 = nodes[a].lo, a1 = nodes[a].hi;
+    if (level(b) == top) b0 = nodes[b].lo, b1 = nodes[b].hi;
+    int result;
+    if (topVar == var) {
+        int lo = andOp(a0, b0);
+        result = (lo == 1) ? 1 : orOp(lo, andOp(a1, b1));
+    } else {
+        int lo = andExists(a0, b0, var);
+        int hi = andExists(a1, b1, var);
+        if (aborted) return 0;
+        result = mk(topVar, lo, hi);
+    }
+    if (aborted) return 0;
+    cacheStore(AND_EXISTS, a, b, var, result);
+    return result;
+}
+
+// f with var fixed to value
+int BDDSolver::restrict(int f, int var, bool value) {
+    if (f < 2 || level(f) > levelOf[var]) return f;
+    if (nodes[f].var == var) return value ? nodes[f].hi : nodes[f].lo;
+    int cached = cacheLookup(RESTRICT, f, var, value);
+    if (cached >= 0) return cached;
+    if (!budget()) return 0;
+
+    int top = nodes[f].var;
+    int lo = restrict(nodes[f].lo, var, value);
+    int hi = restrict(nodes[f].hi, var, value);
+    if (aborted) return 0;
+    int result = mk(top, lo, hi);
+    cacheStore(RESTRICT, f, var, value, result);
+    return result;
+}
+
+/*
+ * A clause is a chain of nodes, built from its lowest literal up:
+ *   (x1 ∨ ¬x3) = mk(x1, mk(x3, 1, 0), 1)
+ */
+int BDDSolver::clauseToBDD(const Clause& clause, const std::unordered_map<int, int>& index) {
+    std::vector<std::pair<int, bool>> lits;  // (variable, negated)
+    for (const auto& lit : clause) lits.emplace_back(index.at(lit.variable), lit.isNegated);
+    std::sort(lits.begin(), lits.end(), [this](const std::pair<int, bool>& a, const std::pair<int, bool>& b) {
+        return levelOf[a.first] != levelOf[b.first] ? levelOf[a.first] > levelOf[b.first] : a.second < b.second;
+    });
+    int f = 0;
+    for (size_t i = 0; i < lits.size(); i++) {
+        if (i > 0 && lits[i].first == lits[i - 1].first) {
+            if (lits[i].second != lits[i - 1].second) return 1;  // Tautology
+            continue;
+        }
+        f = lits[i].second ? mk(lits[i].first, 1, f) : mk(lits[i].first, f, 1);
+    }
+    return f;
+}
+
+// ============================================================================
+// Garbage Collection
+// ============================================================================
+
+/*
+ * Mark every node reachable from a conjunct or a pinned result, free the
+ * others and rebuild the unique table from the survivors. Freed slots are
+ * reused by mk(), so the computed cache is emptied as well.
+ */
+long long BDDSolver::collect() {
+    std::vector<char> marked(nodes.size(), 0);
+    std::vector<int> stack;
+    for (const auto& conjunct : conjuncts) {
+        if (conjunct.root >= 0) stack.push_back(conjunct.root);
+    }
+    stack.insert(stack.end(), pinned.begin(), pinned.end());
+    while (!stack.empty()) {
+        int f = stack.back();
+        stack.pop_back();
+        if (f < 2 || marked[f]) continue;
+        marked[f] = 1;
+        stack.push_back(nodes[f].lo);
+        stack.push_back(nodes[f].hi);
+    }
+
+    for (auto& table : unique) {
+        std::fill(table.buckets.begin(), table.buckets.end(), -1);
+        table.count = 0;
+    }
+    freeSlots.clear();
+    for (int f = nodes.size() - 1; f >= 2; f--) {
+        if (marked[f]) {
+            insertUnique(f);
+        } else {
+            nodes[f].var = -2;
+            freeSlots.push_back(f);
+        }
+    }
+    cacheEpoch++;
+
+    // Now that the cache is empty anyway, let it grow with the diagrams
+    long long live = liveNodes() - 2;
+    if (live > (long long)cache.size() && cache.size() < MAX_CACHE_SIZE) {
+        size_t size = cache.size();
+        while ((long long)size < live && size < MAX_CACHE_SIZE) size *= 2;
+        cache.assign(size, CacheEntry());
+    }
+    return live;
+}
+
+// Size and support of a conjunct, by one walk over its nodes
+void BDDSolver::measure(Conjunct& conjunct) {
+    if (visited.size() < nodes.size()) visited.resize(nodes.size(), 0);
+    visitStamp++;
+    conjunct.size = 0;
+    conjunct.support.clear();
+    std::vector<int> stack = {conjunct.root};
+    while (!stack.empty()) {
+        int f = stack.back();
+        stack.pop_back();
+        if (f < 2 || visited[f] == visitStamp) continue;
+        visited[f] = visitStamp;
+        conjunct.size++;
+        conjunct.support.push_back(nodes[f].var);
+        stack.push_back(nodes[f].lo);
+        stack.push_back(nodes[f].hi);
+    }
+    std::sort(conjunct.support.begin(), conjunct.support.end());
+    conjunct.support.erase(std::unique(conjunct.support.begin(), conjunct.support.end()), conjunct.support.end());
+}
+
+// ============================================================================
+// Dynamic Reordering
+// ============================================================================
+
+/*
+ * While sifting, references are counted, so a swap frees the nodes it
+ * orphans at once and the live count is the exact size after each swap
+ * (a full collect() per swap would cost as much as the diagrams).
+ */
+void BDDSolver::ref(int f) {
+    if (f >= 2) refs[f]++;
+}
+
+void BDDSolver::deref(int f) {
+    if (f < 2 || --refs[f] > 0) return;
+    Subtable& table = unique[nodes[f].var];
+    int* link = &table.buckets[hashPair(nodes[f].lo, nodes[f].hi) & (table.buckets.size() - 1)];
+    while (*link != f) link = &nodes[*link].next;
+    *link = nodes[f].next;
+    table.count--;
+    int lo = nodes[f].lo, hi = nodes[f].hi;
+    nodes[f].var = -2;
+    freeSlots.push_back(f);
+    deref(lo);
+    deref(hi);
+}
+
+/*
+ * Exchange the variables x (at lvl) and y (at lvl + 1) in place. An
+ * x-node f that tests y below it is rewritten to test y first:
+ *
+ *        f: x                    f: y
+ *         /   \                   /   \
+ *       y       y       →       x       x
+ *      / \     / \             / \     / \
+ *    f00 f01 f10 f11         f00 f10 f01 f11
+ *
+ * f keeps its index and its function, so every parent, conjunct and
+ * cache entry stays valid. x-nodes that do not test y, and the y-nodes,
+ * simply change level; y-nodes that only the rewritten nodes used are
+ * freed.
+ */
+void BDDSolver::swapLevels(int lvl) {
+    int x = varAt[lvl], y = varAt[lvl + 1];
+    Subtable& table = unique[x];
+    std::vector<int> members;
+    for (int head : table.buckets) {
+        for (int f = head; f >= 0; f = nodes[f].next) members.push_back(f);
+    }
+    std::fill(table.buckets.begin(), table.buckets.end(), -1);
+    table.count = 0;
+
+    std::vector<int> moved;
+    for (int f : members) {
+        int lo = nodes[f].lo, hi = nodes[f].hi;
+        bool testsY = (lo >= 2 && nodes[lo].var == y) || (hi >= 2 && nodes[hi].var == y);
+        if (testsY) {
+            moved.push_back(f);
+        } else {
+            insertUnique(f);
+        }
+    }
+
+    std::swap(varAt[lvl], varAt[lvl + 1]);
+    levelOf[x] = lvl + 1;
+    levelOf[y] = lvl;
+
+    for (int f : moved) {
+        int f0 = nodes[f].lo, f1 = nodes[f].hi;
+        int f00 = f0, f01 = f0, f10 = f1, f11 = f1;
+        if (f0 >= 2 && nodes[f0].var == y) f00 = nodes[f0].lo, f01 = nodes[f0].hi;
+        if (f1 >= 2 && nodes[f1].var == y) f10 = nodes[f1].lo, f11 = nodes[f1].hi;
+        int lo = mk(x, f00, f10);
+        int hi = mk(x, f01, f11);
+        ref(lo);
+        ref(hi);
+        deref(f0);
+        deref(f1);
+        nodes[f].var = y;
+        nodes[f].lo = lo;
+        nodes[f].hi = hi;
+        insertUnique(f);
+    }
+    swapsLeft--;
+}
+
+/*
+ * Move var through the levels first..last of its group, one swap at a
+ * time, and leave it where the diagrams were smallest. A direction is
+ * abandoned once they grow by SIFT_MAX_GROWTH.
+ */
+void BDDSolver::siftVariable(int var, int first, int last) {
+    long long best = liveNodes();
+    int bestLevel = levelOf[var];
+
+    while (levelOf[var] < last && swapsLeft > 0) {
+        swapLevels(levelOf[var]);
+        if (liveNodes() < best) best = liveNodes(), bestLevel = levelOf[var];
+        if (liveNodes() > best * SIFT_MAX_GROWTH) break;
+    }
+    while (levelOf[var] > first && swapsLeft > 0) {
+        swapLevels(levelOf[var] - 1);
+        if (liveNodes() < best) best = liveNodes(), bestLevel = levelOf[var];
+        if (liveNodes() > best * SIFT_MAX_GROWTH) break;
+    }
+    while (levelOf[var] < bestLevel) swapLevels(levelOf[var]);
+    while (levelOf[var] > bestLevel) swapLevels(levelOf[var] - 1);
+}
+
+/*
+ * Sift the variables of each quantifier group within the group's levels,
+ * those with the most nodes first.
+ */
+void BDDSolver::sift() {
+    long long before = collect();
+    stats.bddReorderings++;
+    swapsLeft = SIFT_MAX_SWAPS;
+
+    // Count references: from nodes, conjuncts and pinned results
+    refs.assign(nodes.size(), 0);
+    for (size_t f = 2; f < nodes.size(); f++) {
+        if (nodes[f].var < 0) continue;
+        ref(nodes[f].lo);
+        ref(nodes[f].hi);
+    }
+    for (const auto& conjunct : conjuncts) {
+        if (conjunct.root >= 0) ref(conjunct.root);
+    }
+    for (int f : pinned) ref(f);
+    counting = true;
+
+    for (const auto& group : groups) {
+        if (group.size() < 2) continue;
+        int first = INT_MAX, last = -1;
+        std::vector<int> candidates;
+        for (int var : group) {
+            first = std::min(first, levelOf[var]);
+            last = std::max(last, levelOf[var]);
+            if (unique[var].count > 0) candidates.push_back(var);
+        }
+        std::stable_sort(candidates.begin(), candidates.end(),
+                         [this](int a, int b) { return unique[a].count > unique[b].count; });
+        if (candidates.size() > SIFT_MAX_VARS) candidates.resize(SIFT_MAX_VARS);
+        for (int var : candidates) {
+            if (swapsLeft <= 0) break;
+            siftVariable(var, first, last);
+        }
+    }
+
+    counting = false;
+    long long after = collect();
+    for (auto& conjunct : conjuncts) {
+        if (conjunct.root >= 0) measure(conjunct);
+    }
+    if (verbose) {
+        std::cout << "[BDD] Reordered within quantifier blocks: " << before << " -> " << after << " nodes"
+                  << std::endl;
+    }
+}
+
+// ============================================================================
+// Quantifier Elimination
+// ============================================================================
+
+// Constant-1 conjuncts say nothing and are dropped
+void BDDSolver::addConjunct(int root) {
+    if (root == 1) return;
+    Conjunct conjunct{root, 0, {}};
+    measure(conjunct);
+    for (int var : conjunct.support) occurrences[var].push_back(conjuncts.size());
+    conjuncts.push_back(std::move(conjunct));
+}
+
+// Slots of dead conjuncts stay, so the occurrence lists keep their meaning
+void BDDSolver::removeConjunct(int id) {
+    conjuncts[id].root = -1;
+    conjuncts[id].support.clear();
+}
+
+/*
+ * Live conjuncts mentioning var. Quantification only shrinks supports,
+ * so an occurrence list may hold stale entries but never misses one;
+ * they are dropped here.
+ */
+std::vector<int> BDDSolver::bucketOf(int var) {
+    std::vector<int>& list = occurrences[var];
+    list.erase(std::remove_if(list.begin(), list.end(), [&](int id) {
+        const auto& support = conjuncts[id].support;
+        return !std::binary_search(support.begin(), support.end(), var);
+    }), list.end());
+    return list;
+}
+
+/*
+ * Between operations every intermediate result is a conjunct or pinned:
+ * collect garbage and reorder here. False once a limit is hit.
+ */
+bool BDDSolver::safePoint() {
+    if (timeLimit > 0 && std::chrono::steady_clock::now() >= deadline) aborted = true;
+    if (aborted) return false;
+    if (liveNodes() > gcThreshold) {
+        long long live = collect();
+        gcThreshold = std::min(std::max(MIN_GC_NODES, 2 * live), nodeLimit * 3 / 4);
+        if (live > reorderThreshold) {
+            sift();
+            reorderThreshold = std::max(reorderThreshold, 2 * (liveNodes() - 2));
+        }
+    }
+    return true;
+}
+
+/*
+ * ∀ distributes over ∧: quantify each conjunct on its own. False if a
+ * conjunct becomes 0 (FORALL wins) or a limit is hit.
+ */
+bool BDDSolver::eliminateUniversal(int g) {
+    std::vector<bool> inGroup(varName.size(), false);
+    for (int var : groups[g]) inGroup[var] = true;
+    std::vector<int> touched;
+    for (int var : groups[g]) {
+        for (int id : bucketOf(var)) touched.push_back(id);
+    }
+    std::sort(touched.begin(), touched.end());
+    touched.erase(std::unique(touched.begin(), touched.end()), touched.end());
+
+    for (int id : touched) {
+        int f = conjuncts[id].root;
+        for (int var : conjuncts[id].support) {
+            if (inGroup[var]) f = quantify(f, var, false);
+        }
+        if (aborted) return false;
+        if (f == 1) {
+            removeConjunct(id);
+            continue;
+        }
+        conjuncts[id].root = f;
+        measure(conjuncts[id]);
+        if (f == 0) return false;
+        if (!safePoint()) return false;
+    }
+
+    if (verbose) {
+        std::cout << "[BDD] FORALL block (" << groups[g].size() << " variables): " << touched.size()
+                  << " conjuncts quantified, " << liveNodes() - 2 << " nodes" << std::endl;
+    }
+    return true;
+}
+
+/*
+ * One variable at a time, the one whose bucket (the conjuncts mentioning
+ * it) has the fewest nodes: AND the bucket smallest first, fusing the last
+ * AND with the quantification. False if the result is 0 (EXISTS loses)
+ * or a limit is hit.
+ */
+bool BDDSolver::eliminateExistential(int g) {
+    std::vector<int> remaining = groups[g];
+    while (!remaining.empty()) {
+        // Cheapest bucket
+        size_t best = 0;
+        long long bestCost = LLONG_MAX;
+        for (size_t i = 0; i < remaining.size(); i++) {
+            long long cost = 0;
+            for (int id : bucketOf(remaining[i])) cost += conjuncts[id].size;
+            if (cost < bestCost) best = i, bestCost = cost;
+        }
+        int var = remaining[best];
+        remaining.erase(remaining.begin() + best);
+
+        std::vector<int> bucket = bucketOf(var);
+        if (bucket.empty()) continue;
+        std::sort(bucket.begin(), bucket.end(),
+                  [this](int a, int b) { return conjuncts[a].size < conjuncts[b].size; });
+
+        // Members stay conjuncts (and so alive) until the result is in
+        std::vector<int> roots;
+        for (int id : bucket) roots.push_back(conjuncts[id].root);
+        pinned.push_back(roots[0]);
+        for (size_t k = 1; k + 1 < roots.size() && pinned.back() != 0; k++) {
+            pinned.back() = andOp(pinned.back(), roots[k]);
+            if (aborted || !safePoint()) return false;
+        }
+        int result = roots.size() >= 2 ? andExists(pinned.back(), roots.back(), var)
+                                       : quantify(pinned.back(), var, true);
+        pinned.pop_back();
+        if (aborted) return false;
+
+        for (int id : bucket) removeConjunct(id);
+        addConjunct(result);
+
+        if (verbose) {
+            std::cout << "[BDD] EXISTS " << varString(var) << ": " << bucket.size() << " conjuncts ("
+                      << bestCost << " nodes) -> " << (result < 2 ? std::to_string(result)
+                                                                  : std::to_string(conjuncts.back().size) + " nodes")
+                      << std::endl;
+        }
+        if (result == 0) return false;
+        if (!safePoint()) return false;
+    }
+    return true;
+}
+
+/*
+ * Outer-block report from W, the set of winning outer assignments: x is
+ * forced true when W ∧ ¬x = 0, and any path from W's root to 1 is a
+ * winning assignment (variables it skips are don't-care).
+ */
+void BDDSolver::reportOuter(Result result, int winning) {
+    if (!outer.active()) return;
+    std::unordered_map<int, bool> path;
+    if (result == Result::SAT && winning >= 2) {
+        pinned.push_back(winning);
+        for (size_t var = 0; var < varName.size(); var++) {
+            if (varGroup[var] != 0 || !outer.isOuter(varName[var])) continue;
+            for (bool value : {false, true}) {
+                if (restrict(winning, var, !value) == 0 && !aborted) {
+                    if (verbose) {
+                        std::cout << "[OUTER] " << varString(var) << "=" << (value ? "true" : "false")
+                                  << " is forced in every winning assignment" << std::endl;
+                    }
+                    outer.forcedFound(varName[var], value);
+                }
+            }
+        }
+        pinned.pop_back();
+        for (int f = winning; f >= 2;) {
+            bool value = nodes[f].hi != 0;
+            path[varName[nodes[f].var]] = value;
+            f = value ? nodes[f].hi : nodes[f].lo;
+        }
+        for (const auto& [var, value] : path) assignments[var] = value;
+    }
+    outer.finish(result == Result::SAT, result == Result::UNSAT, [&](int var) {
+        auto it = assignments.find(var);
+        if (it != assignments.end()) return it->second ? 1 : 0;
+        return -1;
+    });
+}
+
+// ============================================================================
+// Main Entry Point
+// ============================================================================
+
+Result BDDSolver::solve(const QBFPreprocessor& preprocessor) {
+    stats = SolverStats();
+    stats.engine = "bdd";
+    overflow = aborted = false;
+    opsSinceCheck = 0;
+    // A small node limit brings collection and reordering forward
+    gcThreshold = std::min(MIN_GC_NODES, nodeLimit * 3 / 4);
+    reorderThreshold = std::min(FIRST_REORDER_NODES, nodeLimit / 4);
+    if (timeLimit > 0) {
+        deadline = std::chrono::steady_clock::now() +
+                   std::chrono::duration_cast<std::chrono::steady_clock::duration>(
+                       std::chrono::duration<double>(timeLimit));
+    }
+    outer.reset(preprocessor, outerCallback);
+    assignments = preprocessor.getAssignments();
+
+    // Variables in prefix order; consecutive blocks of the same quantifier
+    // (after preprocessing emptied the ones between) form one group
+    std::unordered_map<int, Quantifier> quantifierOf;
+    for (const auto& block : preprocessor.getQuantifierBlocks()) {
+        for (int var : block.variables) quantifierOf[var] = block.type;
+    }
+    varName = prefixVariableOrder(preprocessor);
+    int numVars = varName.size();
+    std::unordered_map<int, int> index;
+    varUniversal.assign(numVars, false);
+    varGroup.assign(numVars, 0);
+    groups.clear();
+    for (int var = 0; var < numVars; var++) {
+        index[varName[var]] = var;
+        auto it = quantifierOf.find(varName[var]);
+        varUniversal[var] = (it != quantifierOf.end() && it->second == Quantifier::FORALL);
+        if (groups.empty() || varUniversal[var] != varUniversal[groups.back()[0]]) groups.emplace_back();
+        groups.back().push_back(var);
+        varGroup[var] = groups.size() - 1;
+    }
+    levelOf.resize(numVars);
+    varAt.resize(numVars);
+    for (int var = 0; var < numVars; var++) levelOf[var] = varAt[var] = var;
+
+    nodes.assign(2, {-1, 0, 0, -1});
+    freeSlots.clear();
+    unique.assign(numVars, Subtable());
+    for (auto& table : unique) table.buckets.assign(16, -1);
+    cache.assign(MIN_CACHE_SIZE, CacheEntry());
+    cacheEpoch = 0;
+    conjuncts.clear();
+    occurrences.assign(numVars, {});
+    pinned.clear();
+    visited.clear();
+
+    for (const auto& clause : preprocessor.getClauses()) addConjunct(clauseToBDD(clause, index));
+    stats.bddPeakNodes = liveNodes() - 2;
+    if (verbose) {
+        std::cout << "[SOLVE] BDD with " << conjuncts.size() << " clause diagrams over " << numVars
+                  << " variables, " << groups.size() << " quantifier blocks" << std::endl;
+    }
+
+    // Eliminate from the innermost group out; with outer reports, stop
+    // before the outer EXISTS group
+    int stop = (outer.active() && !groups.empty() && !varUniversal[groups[0][0]]) ? 1 : 0;
+    bool refuted = std::any_of(conjuncts.begin(), conjuncts.end(),
+                               [](const Conjunct& conjunct) { return conjunct.root == 0; });
+    for (int g = (int)groups.size() - 1; g >= stop && !refuted && !aborted; g--) {
+        bool ok = varUniversal[groups[g][0]] ? eliminateUniversal(g) : eliminateExistential(g);
+        if (!ok && !aborted) refuted = true;
+    }
+
+    // The winning outer assignments: everything that is left
+    int winning = 1;
+    if (stop == 1 && !refuted && !aborted) {
+        pinned.push_back(1);
+        for (const auto& conjunct : conjuncts) {
+            if (conjunct.root < 0) continue;
+            pinned.back() = andOp(pinned.back(), conjunct.root);
+            if (aborted || !safePoint()) break;
+        }
+        winning = pinned.back();
+        pinned.pop_back();
+        if (winning == 0) refuted = true;
+    }
+
+    Result result = Result::SAT;
+    if (aborted) {
+        result = Result::UNKNOWN;
+        if (verbose) {
+            std::cout << (overflow ? "[BDD] Node limit reached (" + std::to_string(nodeLimit) + " nodes)"
+                                   : std::string("[TIMEOUT] Time limit reached"))
+                      << std::endl;
+        }
+    } else if (refuted) {
+        result = Result::UNSAT;
+    }
+    if (verbose && result != Result::UNKNOWN) {
+        std::cout << "[BDD] " << (result == Result::UNSAT ? "A conjunct became 0: false"
+                                  : stop == 1            ? "Winning outer assignments left: true"
+                                                         : "Every variable eliminated: true")
+                  << " (peak " << stats.bddPeakNodes << " nodes)" << std::endl;
+    }
+
+    // A caller falling back to another engine gets its reports from there
+    if (!overflow) reportOuter(result, winning);
+    return result;
+}
@@ -0,0 +1,202 @@
+/*
+ * BDDSolver.h - QBF by Quantifier Elimination on Binary Decision Diagrams
+ *
+ * Search engines (QBFSolver, QCDCLSolver) walk the game tree. A BDD engine
+ * instead computes with whole Boolean functions: the matrix is turned into
+ * a conjunction of BDDs, one per clause, and the quantifiers are removed
+ * from the inside out until only a constant is left.
+ *
+ *   ∃y f  =  f[y=0] ∨ f[y=1]        ∀u f  =  f[u=0] ∧ f[u=1]
+ *
+ * A REDUCED ORDERED BDD (ROBDD) is a DAG whose inner nodes test one
+ * variable each, in one fixed order along every path, with no two nodes
+ * alike and no node whose two children are the same. Every function then
+ * has exactly one ROBDD, so "is it 0?" is a pointer comparison. Two tables
+ * keep it that way cheaply:
+ *
+ *   UNIQUE TABLE    (var, lo, hi) → node, so mk() never builds a twin
+ *   COMPUTED CACHE  (op, a, b) → result, so each pair of subgraphs is
+ *                   combined once (apply is then O(|a|·|b|), not 2^n)
+ *
+ * ELIMINATION. Building the whole matrix first would usually blow up, so
+ * the clauses stay separate CONJUNCTS for as long as possible:
+ *
+ *   ∀u: distributes over ∧, so each conjunct mentioning u is quantified
+ *       on its own:  ∀u (A ∧ B) = ∀u A ∧ ∀u B
+ *   ∃y: only the conjuncts mentioning y (its BUCKET) are combined:
+ *       ∃y (A ∧ B ∧ C) = (∃y (A ∧ B)) ∧ C  if C does not mention y,
+ *       and the last AND is fused with the quantification (andExists),
+ *       so the product is never built in full. Within a block the
+ *       variable with the smallest bucket goes first.
+ *
+ * A constant-0 conjunct ends the solve (UNSAT); when every variable is
+ * gone, the formula is true.
+ *
+ * VARIABLE ORDER. BDD sizes depend heavily on the order. It starts as the
+ * quantifier prefix (outermost variables on top, so the variables
+ * eliminated first sit at the bottom, where quantifying is cheap), and
+ * within a block by first appearance in the clauses. When the diagrams
+ * grow, the variables of each block are SIFTED: moved level by level
+ * through their block by swapping adjacent levels in place, and left
+ * where the diagrams were smallest. Variables never leave their block,
+ * so the order stays compatible with the prefix.
+ *
+ * The engine suits NARROW formulas (few clauses cross any cut of the
+ * variable order, see FormulaFeatures::cutWidth), where the diagrams stay
+ * small. Elsewhere they can grow exponentially: past the node limit the
+ * solve gives up (exceededNodeLimit()) and the caller falls back to the
+ * engine the formula features would pick (QCDCL, search on tiny ones).
+ *
+ * With an outer callback (QBFOuter.h) elimination stops before the outer
+ * EXISTS block: the conjunction of what is left is then exactly the set
+ * of winning outer assignments, from which a winning one and the forced
+ * literals are read off.
+ */
+
+#ifndef BDD_SOLVER_H
+#define BDD_SOLVER_H
+
+#include "QBFOuter.h"
+#include "QBFPreprocessor.h"
+#include "QBFSolver.h"
+#include <chrono>
+#include <unordered_map>
+#include <vector>
+
+class BDDSolver {
+public:
+    BDDSolver();
+
+    void setVerbose(bool enabled);
+
+    // Give up with Result::UNKNOWN after this many seconds (0 = no limit)
+    void setTimeLimit(double seconds);
+
+    // Give up with Result::UNKNOWN when more nodes than this are in use
+    void setNodeLimit(long long nodes);
+
+    // Report the winning outer assignment and the forced outer literals
+    void setOuterCallback(const OuterCallback& callback);
+
+    Result solve(const QBFPreprocessor& preprocessor);
+
+    // UNKNOWN because of the node limit (not the time limit)
+    bool exceededNodeLimit() const { return overflow; }
+
+    // Outer variables of the winning assignment (with an outer callback)
+    const std::unordered_map<int, bool>& getAssignments() const { return assignments; }
+
+    const SolverStats& getStats() const { return stats; }
+
+private:
+    // Node 0 and node 1 are the constants; inner nodes test var
+    struct Node {
+        int var;   // Index into levelOf (-1 = constant, -2 = free slot)
+        int lo;    // Child for var = 0
+        int hi;    // Child for var = 1
+        int next;  // Next node in the same unique-table chain
+    };
+
+    // One unique subtable per variable, so a level swap touches only two
+    struct Subtable {
+        std::vector<int> buckets;  // Chain heads (-1 = empty)
+        int count = 0;
+    };
+
+    enum Op { AND, OR, EXISTS, FORALL, AND_EXISTS, RESTRICT };
+
+    struct CacheEntry {
+        int epoch = -1;  // Entries of older epochs are empty
+        int op = 0;
+        int a = 0, b = 0, c = 0;
+        int result = 0;
+    };
+
+    // A clause BDD or a combination of them, with the variables it mentions
+    struct Conjunct {
+        int root;  // -1 = gone (combined into another or quantified to 1)
+        int size;
+        std::vector<int> support;
+    };
+
+    // Formula in BDD variables 0..n-1 (original numbers in varName)
+    std::vector<int> varName;
+    std::vector<bool> varUniversal;
+    std::vector<int> varGroup;                  // Quantifier group, 0 = outermost
+    std::vector<std::vector<int>> groups;       // Variables of each group
+    std::vector<int> levelOf;                   // Variable → level (0 = top)
+    std::vector<int> varAt;                     // Level → variable
+
+    std::vector<Node> nodes;
+    std::vector<int> freeSlots;
+    std::vector<Subtable> unique;
+    std::vector<CacheEntry> cache;
+    int cacheEpoch;             // Bumped by collect(): freed nodes get reused
+
+    std::vector<Conjunct> conjuncts;
+    std::vector<std::vector<int>> occurrences;  // Variable → conjuncts mentioning it
+    std::vector<int> pinned;   // Intermediate results kept alive by collect()
+    std::vector<int> visited;  // Stamps for measure()
+    int visitStamp;
+
+    long long nodeLimit;
+    long long gcThreshold;       // Collect garbage above this many nodes
+    long long reorderThreshold;  // Sift above this many live nodes
+    long long swapsLeft;         // Level swaps left in the current sift()
+    std::vector<int> refs;       // Reference counts, kept only while sifting
+    bool counting;
+    bool overflow;
+    bool aborted;              // Node or time limit hit; operations return 0
+
+    bool verbose;
+    double timeLimit;
+    std::chrono::steady_clock::time_point deadline;
+    long long opsSinceCheck;
+
+    OuterCallback outerCallback;
+    OuterTracker outer;
+    std::unordered_map<int, bool> assignments;
+    SolverStats stats;
+
+    // Diagram construction
+    int level(int f) const;
+    int mk(int var, int lo, int hi);
+    void insertUnique(int f);
+    void growSubtable(int var);
+    bool budget();
+    int cacheLookup(Op op, int a, int b, int c) const;
+    void cacheStore(Op op, int a, int b, int c, int result);
+
+    // Operations
+    int andOp(int a, int b);
+    int orOp(int a, int b);
+    int quantify(int f, int var, bool exists);
+    int andExists(int a, int b, int var);
+    int restrict(int f, int var, bool value);
+    int clauseToBDD(const Clause& clause, const std::unordered_map<int, int>& index);
+
+    // Memory: mark from the conjuncts and pinned nodes, free the rest
+    long long liveNodes() const { return (long long)nodes.size() - (long long)freeSlots.size(); }
+    long long collect();
+    void measure(Conjunct& conjunct);
+
+    // Dynamic reordering within quantifier groups
+    void ref(int f);
+    void deref(int f);
+    void swapLevels(int level);
+    void siftVariable(int var, int first, int last);
+    void sift();
+
+    // Elimination
+    bool eliminateUniversal(int group);
+    bool eliminateExistential(int group);
+    void addConjunct(int root);
+    void removeConjunct(int id);
+    std::vector<int> bucketOf(int var);
+    bool safePoint();
+    void reportOuter(Result result, int winning);
+
+    std::string varString(int var) const { return "x" + std::to_string(varName[var]); }
+};
+
+#endif // BDD_SOLVER_H
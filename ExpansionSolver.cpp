@@ -0,0 +1,507 @@
+/*
+ * ExpansionSolver.cpp - Resolution and universal expansion on the clauses
+ */
+
+#include "ExpansionSolver.h"
+#include "QCDCLSolver.h"
+#include <algorithm>
+#include <iostream>
+#include <set>
+
+ExpansionSolver::ExpansionSolver()
+    : liveClauses(0), falsified(false), clauseLimit(200000), overflow(false), aborted(false),
+      clausesSinceCheck(0), verbose(false), timeLimit(0) {}
+
+void ExpansionSolver::setVerbose(bool enabled) {
+    verbose = enabled;
+}
+
+void ExpansionSolver::setTimeLimit(double seconds) {
+    timeLimit = seconds;
+}
+
+void ExpansionSolver::setClauseLimit(long long limit) {
+    clauseLimit = std::max(1LL, limit);
+}
+
+void ExpansionSolver::setOuterCallback(const OuterCallback& callback) {
+    outerCallback = callback;
+}
+
+int ExpansionSolver::newVariable(int blockLevel, bool isUniversal) {
+    int var = level.size();
+    level.push_back(blockLevel);
+    universal.push_back(isUniversal);
+    mark.push_back(0);
+    occurrences.resize(2 * level.size());
+    filed.resize(2 * level.size());
+    counts.resize(2 * level.size(), 0);
+    return var;
+}
+
+// ============================================================================
+// Clause Database
+// ============================================================================
+
+// Live clauses containing lit (removed ones are dropped from the list here)
+const std::vector<int>& ExpansionSolver::occurrencesOf(const Literal& lit) {
+    auto& list = occurrences[key(lit)];
+    list.erase(std::remove_if(list.begin(), list.end(), [&](int c) { return !alive[c]; }), list.end());
+    return list;
+}
+
+uint64_t ExpansionSolver::signature(const Clause& clause) {
+    uint64_t sig = 0;
+    for (const auto& lit : clause) sig |= 1ULL << (key(lit) % 64);
+    return sig;
+}
+
+/*
+ * Some live clause is a subset of clause (its literals are marked). Every
+ * clause is filed under one of its literals, which such a clause shares
+ * with this one, so only the lists of this clause's literals are looked
+ * at; a literal in the signature that clause lacks rules one out without
+ * a scan.
+ */
+bool ExpansionSolver::subsumed(const Clause& clause, uint64_t sig) {
+    for (const auto& lit : clause) {
+        auto& list = filed[key(lit)];
+        list.erase(std::remove_if(list.begin(), list.end(), [&](int c) { return !alive[c]; }), list.end());
+        for (int c : list) {
+            if (clauses[c].size() > clause.size() || (signatures[c] & ~sig) != 0) continue;
+            bool subset = std::all_of(clauses[c].begin(), clauses[c].end(), [&](const Literal& other) {
+                return mark[other.variable] == (other.isNegated ? -1 : 1);
+            });
+            if (subset) return true;
+        }
+    }
+    return false;
+}
+
+// Remove the live clauses that contain clause (its literals are marked)
+void ExpansionSolver::removeSubsumed(const Clause& clause, uint64_t sig) {
+    const Literal* rarest = &clause[0];
+    for (const auto& lit : clause) {
+        if (counts[key(lit)] < counts[key(*rarest)]) rarest = &lit;
+    }
+    std::vector<int> list = occurrencesOf(*rarest);
+    for (int c : list) {
+        if (clauses[c].size() < clause.size() || (sig & ~signatures[c]) != 0) continue;
+        size_t shared = std::count_if(clauses[c].begin(), clauses[c].end(), [&](const Literal& other) {
+            return mark[other.variable] == (other.isNegated ? -1 : 1);
+        });
+        if (shared == clause.size()) removeClause(c);
+    }
+}
+
+/*
+ * Add a clause after normalizing it: sorted, no duplicates, no
+ * tautologies, universally reduced, and not subsumed. Clauses it subsumes
+ * are removed.
+ */
+void ExpansionSolver::addClause(Clause clause) {
+    if (aborted || falsified) return;
+    std::sort(clause.begin(), clause.end(), [](const Literal& a, const Literal& b) {
+        return a.variable != b.variable ? a.variable < b.variable : a.isNegated < b.isNegated;
+    });
+    clause.erase(std::unique(clause.begin(), clause.end()), clause.end());
+    for (size_t i = 1; i < clause.size(); i++) {
+        if (clause[i].variable == clause[i - 1].variable) return;
+    }
+
+    // FORALL plays the universals quantified after every existential false
+    int innermost = -1;
+    for (const auto& lit : clause) {
+        if (!universal[lit.variable]) innermost = std::max(innermost, level[lit.variable]);
+    }
+    clause.erase(std::remove_if(clause.begin(), clause.end(), [&](const Literal& lit) {
+        return universal[lit.variable] && level[lit.variable] > innermost;
+    }), clause.end());
+    if (clause.empty()) {
+        falsified = true;
+        return;
+    }
+
+    uint64_t sig = signature(clause);
+    for (const auto& lit : clause) mark[lit.variable] = lit.isNegated ? -1 : 1;
+    bool redundant = subsumed(clause, sig);
+    if (!redundant) removeSubsumed(clause, sig);
+    for (const auto& lit : clause) mark[lit.variable] = 0;
+    if (redundant) return;
+
+    int id = clauses.size();
+    const Literal* rarest = &clause[0];
+    for (const auto& lit : clause) {
+        if (counts[key(lit)] < counts[key(*rarest)]) rarest = &lit;
+    }
+    filed[key(*rarest)].push_back(id);
+    for (const auto& lit : clause) {
+        occurrences[key(lit)].push_back(id);
+        counts[key(lit)]++;
+    }
+    if (clause.size() == 1) units.push_back(id);
+    signatures.push_back(sig);
+    clauses.push_back(std::move(clause));
+    alive.push_back(true);
+    liveClauses++;
+    stats.elimPeakClauses = std::max(stats.elimPeakClauses, liveClauses);
+    if (liveClauses > clauseLimit) overflow = aborted = true;
+    if (++clausesSinceCheck >= 1024) {
+        clausesSinceCheck = 0;
+        budget();
+    }
+}
+
+void ExpansionSolver::removeClause(int id) {
+    if (!alive[id]) return;
+    alive[id] = false;
+    for (const auto& lit : clauses[id]) counts[key(lit)]--;
+    liveClauses--;
+}
+
+// ============================================================================
+// Simplification
+// ============================================================================
+
+// Make lit true: its clauses go, the clauses of ¬lit lose it
+void ExpansionSolver::assign(const Literal& lit) {
+    std::vector<int> satisfied = occurrencesOf(lit);
+    for (int c : satisfied) removeClause(c);
+    std::vector<int> shortened = occurrencesOf(lit.complement());
+    for (int c : shortened) removeClause(c);
+    for (int c : shortened) {
+        Clause rest;
+        for (const auto& other : clauses[c]) {
+            if (other.variable != lit.variable) rest.push_back(other);
+        }
+        addClause(rest);
+    }
+}
+
+/*
+ * Unit clauses and pure literals, until neither is left. A unit on an
+ * outer variable is forced in every winning assignment; pure literals on
+ * outer variables are left alone while reporting, since they only pick
+ * one of the winning values.
+ */
+void ExpansionSolver::simplify() {
+    bool changed = true;
+    while (changed && !falsified && !aborted) {
+        changed = false;
+        while (!units.empty() && !falsified && !aborted) {
+            int c = units.back();
+            units.pop_back();
+            if (!alive[c]) continue;
+            Literal lit = clauses[c][0];
+            if (outer.active() && outer.isOuter(lit.variable)) {
+                if (verbose) {
+                    std::cout << "[OUTER] " << varString(lit.variable) << "=" << (lit.isNegated ? "false" : "true")
+                              << " is forced in every winning assignment" << std::endl;
+                }
+                outer.forcedFound(lit.variable, !lit.isNegated);
+                assignments[lit.variable] = !lit.isNegated;
+            }
+            assign(lit);
+            stats.propagations++;
+        }
+        for (int var = 1; var < static_cast<int>(level.size()) && !falsified && !aborted; var++) {
+            int positive = counts[2 * var], negative = counts[2 * var + 1];
+            if ((positive > 0) == (negative > 0)) continue;
+            if (!universal[var] && outer.active() && outer.isOuter(var)) continue;
+            // EXISTS satisfies every clause of a pure literal, FORALL none
+            bool value = (positive > 0) != universal[var];
+            if (!universal[var] && outer.isOuter(var)) assignments[var] = value;
+            assign(Literal(var, !value));
+            changed = true;
+        }
+    }
+}
+
+// ============================================================================
+// Elimination Steps
+// ============================================================================
+
+bool ExpansionSolver::budget() {
+    if (timeLimit > 0 && std::chrono::steady_clock::now() >= deadline) aborted = true;
+    return !aborted;
+}
+
+// Replace the clauses of var by their resolvents on var
+void ExpansionSolver::resolve(int var) {
+    std::vector<int> positive = occurrencesOf(Literal(var, false));
+    std::vector<int> negative = occurrencesOf(Literal(var, true));
+    for (int c : positive) removeClause(c);
+    for (int c : negative) removeClause(c);
+    for (int p : positive) {
+        for (int n : negative) {
+            Clause resolvent;
+            for (const auto& lit : clauses[p]) {
+                if (lit.variable != var) resolvent.push_back(lit);
+            }
+            for (const auto& lit : clauses[n]) {
+                if (lit.variable != var) resolvent.push_back(lit);
+            }
+            addClause(resolvent);
+            if (aborted || falsified) return;
+        }
+    }
+}
+
+/*
+ * ∀u ∃E φ = ∃E φ[u=0] ∧ ∃E' φ[u=1]. The clauses with a variable of E (and
+ * with u, which universal reduction keeps only next to one of E) are
+ * rebuilt: with u false under the old names, and with u true under fresh
+ * copies of E.
+ */
+void ExpansionSolver::expand(int var, const std::vector<int>& inner) {
+    std::set<int> scope;
+    for (int e : inner) {
+        for (bool negated : {false, true}) {
+            const auto& list = occurrencesOf(Literal(e, negated));
+            scope.insert(list.begin(), list.end());
+        }
+    }
+    for (bool negated : {false, true}) {
+        const auto& list = occurrencesOf(Literal(var, negated));
+        scope.insert(list.begin(), list.end());
+    }
+
+    std::unordered_map<int, int> copyOf;
+    for (int e : inner) copyOf[e] = newVariable(level[e], false);
+    for (int c : scope) removeClause(c);
+    for (int c : scope) {
+        bool positive = false, negative = false;
+        for (const auto& lit : clauses[c]) {
+            if (lit.variable == var) (lit.isNegated ? negative : positive) = true;
+        }
+        Clause falseSide, trueSide;
+        for (const auto& lit : clauses[c]) {
+            if (lit.variable == var) continue;
+            falseSide.push_back(lit);
+            auto it = copyOf.find(lit.variable);
+            trueSide.emplace_back(it != copyOf.end() ? it->second : lit.variable, lit.isNegated);
+        }
+        if (!negative) addClause(falseSide);
+        if (!positive) addClause(trueSide);
+        if (aborted || falsified) return;
+    }
+}
+
+// ============================================================================
+// The Existential Remainder
+// ============================================================================
+
+/*
+ * SAT call on the remaining clauses (all existential) plus the assumed
+ * literals; cube receives the literals of a satisfying assignment that
+ * every clause needs (the others are don't-care).
+ */
+bool ExpansionSolver::remainderSatisfiable(const std::vector<Literal>& assumed, std::vector<Literal>& cube) {
+    QBFPreprocessor query;
+    std::vector<int> vars;
+    for (int var = 1; var < static_cast<int>(level.size()); var++) {
+        if (occurs(var)) vars.push_back(var);
+    }
+    for (const auto& lit : assumed) {
+        if (!occurs(lit.variable)) vars.push_back(lit.variable);
+    }
+    query.addQuantifierBlock(Quantifier::EXISTS, vars);
+    for (size_t c = 0; c < clauses.size(); c++) {
+        if (alive[c]) query.addClause(clauses[c]);
+    }
+    for (const auto& lit : assumed) query.addClause({lit});
+
+    QCDCLSolver solver;
+    if (timeLimit > 0) {
+        double left = std::chrono::duration<double>(deadline - std::chrono::steady_clock::now()).count();
+        if (left <= 0) {
+            aborted = true;
+            return false;
+        }
+        solver.setTimeLimit(left);
+    }
+    Result result = solver.solve(query);
+    if (result == Result::UNKNOWN) aborted = true;
+    cube = result == Result::SAT ? solver.getWinningLiterals() : std::vector<Literal>();
+    return result == Result::SAT;
+}
+
+/*
+ * Forced outer literals, as in QBFBackbone: each value of the winning
+ * assignment is a candidate; it is forced if the remainder is unsatisfiable
+ * with it flipped, and every assignment found on the way rules out the
+ * candidates it disagrees with (or leaves open).
+ */
+Result ExpansionSolver::solveRemainder() {
+    std::vector<Literal> cube;
+    bool satisfiable = remainderSatisfiable({}, cube);
+    if (aborted) return Result::UNKNOWN;
+    if (!satisfiable) return Result::UNSAT;
+    if (!outer.active()) return Result::SAT;
+
+    std::vector<Literal> plan;
+    for (const auto& lit : cube) {
+        if (outer.isOuter(lit.variable)) plan.push_back(lit);
+    }
+    std::vector<bool> candidate(plan.size(), true);
+    for (size_t i = 0; i < plan.size() && !aborted; i++) {
+        if (!candidate[i]) continue;
+        std::vector<Literal> other;
+        if (!remainderSatisfiable({plan[i].complement()}, other)) {
+            if (aborted) break;
+            if (verbose) {
+                std::cout << "[OUTER] " << varString(plan[i].variable) << "="
+                          << (plan[i].isNegated ? "false" : "true") << " is forced in every winning assignment"
+                          << std::endl;
+            }
+            outer.forcedFound(plan[i].variable, !plan[i].isNegated);
+            continue;
+        }
+        for (size_t j = i + 1; j < plan.size(); j++) {
+            candidate[j] = candidate[j] && std::find(other.begin(), other.end(), plan[j]) != other.end();
+        }
+    }
+    for (const auto& lit : plan) assignments[lit.variable] = !lit.isNegated;
+    return Result::SAT;
+}
+
+// ============================================================================
+// Main Entry Point
+// ============================================================================
+
+Result ExpansionSolver::solve(const QBFPreprocessor& preprocessor) {
+    stats = SolverStats();
+    stats.engine = "expand";
+    overflow = aborted = falsified = false;
+    clausesSinceCheck = 0;
+    if (timeLimit > 0) {
+        deadline = std::chrono::steady_clock::now() +
+                   std::chrono::duration_cast<std::chrono::steady_clock::duration>(
+                       std::chrono::duration<double>(timeLimit));
+    }
+    outer.reset(preprocessor, outerCallback);
+    assignments = preprocessor.getAssignments();
+    clauses.clear();
+    alive.clear();
+    occurrences.clear();
+    counts.clear();
+    filed.clear();
+    signatures.clear();
+    level.clear();
+    universal.clear();
+    mark.clear();
+    units.clear();
+    liveClauses = 0;
+
+    // Blocks count from 1 outwards in; free variables are level 0
+    int maxVar = 0;
+    for (const auto& block : preprocessor.getQuantifierBlocks()) {
+        for (int var : block.variables) maxVar = std::max(maxVar, var);
+    }
+    for (const auto& clause : preprocessor.getClauses()) {
+        for (const auto& lit : clause) maxVar = std::max(maxVar, lit.variable);
+    }
+    while (static_cast<int>(level.size()) <= maxVar) newVariable(0, false);
+    const auto& blocks = preprocessor.getQuantifierBlocks();
+    for (size_t b = 0; b < blocks.size(); b++) {
+        for (int var : blocks[b].variables) {
+            level[var] = b + 1;
+            universal[var] = blocks[b].type == Quantifier::FORALL;
+        }
+    }
+    for (const auto& clause : preprocessor.getClauses()) addClause(clause);
+    if (verbose) {
+        std::cout << "[SOLVE] Resolution and expansion: " << liveClauses << " clauses, limit " << clauseLimit
+                  << std::endl;
+    }
+
+    Result result = Result::UNKNOWN;
+    while (budget()) {
+        simplify();
+        if (falsified) {
+            result = Result::UNSAT;
+            break;
+        }
+        if (aborted) break;
+
+        // U: the innermost universals; E: the existentials after them
+        int innermost = -1;
+        for (int var = 1; var < static_cast<int>(level.size()); var++) {
+            if (universal[var] && occurs(var)) innermost = std::max(innermost, level[var]);
+        }
+        if (innermost < 0) {
+            result = solveRemainder();
+            break;
+        }
+        std::vector<int> inner, universals;
+        for (int var = 1; var < static_cast<int>(level.size()); var++) {
+            if (!occurs(var)) continue;
+            if (!universal[var] && level[var] > innermost) inner.push_back(var);
+            if (universal[var] && level[var] == innermost) universals.push_back(var);
+        }
+
+        // Price every step by the clauses it adds
+        int bestResolve = 0, bestExpand = 0;
+        long long resolveCost = 0, expandCost = 0;
+        for (int var : inner) {
+            long long p = counts[2 * var], n = counts[2 * var + 1];
+            long long cost = p * n - p - n;
+            if (bestResolve == 0 || cost < resolveCost) {
+                bestResolve = var;
+                resolveCost = cost;
+            }
+        }
+        std::set<int> scope;
+        for (int var : inner) {
+            for (bool negated : {false, true}) {
+                const auto& list = occurrencesOf(Literal(var, negated));
+                scope.insert(list.begin(), list.end());
+            }
+        }
+        for (int var : universals) {
+            long long cost = static_cast<long long>(scope.size()) - counts[2 * var] - counts[2 * var + 1];
+            if (bestExpand == 0 || cost < expandCost) {
+                bestExpand = var;
+                expandCost = cost;
+            }
+        }
+
+        if (bestResolve != 0 && resolveCost <= expandCost) {
+            if (verbose) {
+                std::cout << "[ELIM] Resolve " << varString(bestResolve) << ": " << counts[2 * bestResolve]
+                          << " × " << counts[2 * bestResolve + 1] << " clauses (predicted "
+                          << (resolveCost >= 0 ? "+" : "") << resolveCost << ")" << std::endl;
+            }
+            resolve(bestResolve);
+            stats.resolvedVars++;
+        } else {
+            if (verbose) {
+                std::cout << "[ELIM] Expand " << varString(bestExpand) << ": " << scope.size()
+                          << " clauses in the scope of " << inner.size()
+                          << (inner.size() == 1 ? " EXISTS variable" : " EXISTS variables") << " (predicted "
+                          << (expandCost >= 0 ? "+" : "") << expandCost << ")" << std::endl;
+            }
+            expand(bestExpand, inner);
+            stats.expandedVars++;
+        }
+        if (verbose && !aborted && !falsified) std::cout << "[ELIM] " << liveClauses << " clauses" << std::endl;
+    }
+
+    if (verbose) {
+        if (overflow) {
+            std::cout << "[ELIM] Clause limit reached (" << clauseLimit << " clauses)" << std::endl;
+        } else if (result == Result::UNKNOWN) {
+            std::cout << "[TIMEOUT] Time limit reached" << std::endl;
+        } else {
+            std::cout << "[ELIM] " << (result == Result::SAT ? "Remainder satisfiable: true" : "Empty clause: false")
+                      << " (" << stats.resolvedVars << " resolved, " << stats.expandedVars << " expanded, peak "
+                      << stats.elimPeakClauses << " clauses)" << std::endl;
+        }
+    }
+    outer.finish(result == Result::SAT, result == Result::UNSAT, [&](int var) {
+        auto it = assignments.find(var);
+        if (it != assignments.end()) return it->second ? 1 : 0;
+        return -1;
+    });
+    return result;
+}
@@ -0,0 +1,144 @@
+/*
+ * ExpansionSolver.h - QBF by Resolution and Universal Expansion
+ *
+ * Search engines branch on the outermost variables first. Elimination
+ * engines work from the other end: the innermost variable is the one
+ * whose quantifier can be removed without looking at the rest of the
+ * prefix. This engine (after Quantor) eliminates on the clauses
+ * themselves, one variable at a time, so the formula stays in CNF and the
+ * only resource is the number of clauses.
+ *
+ * UNIVERSAL REDUCTION keeps the innermost block existential: a universal
+ * literal is dropped from a clause when no existential of the clause is
+ * quantified after it (FORALL would simply play it false). Let E be the
+ * existentials after the last remaining universal block U. Two steps are
+ * possible:
+ *
+ *   RESOLUTION of x in E. ∃x is eliminated by replacing the clauses with
+ *   x and with ¬x by all their non-tautological resolvents:
+ *
+ *     ∃x ((x ∨ A1) ∧ ... ∧ (¬x ∨ B1) ∧ ... ∧ R)  =  (A1 ∨ B1) ∧ ... ∧ R
+ *
+ *   EXPANSION of u in U. ∀u ∃E φ = ∃E φ[u=0] ∧ ∃E' φ[u=1]: the clauses
+ *   that mention E are copied, with E renamed to fresh variables E' in
+ *   the copy, and u is set to false in the original and true in the copy.
+ *   Clauses outside E's scope are shared.
+ *
+ * COST MODEL. Each step is priced by the number of clauses it adds:
+ *
+ *   resolve x:  |x| · |¬x| - |x| - |¬x|      (resolvents minus the clauses
+ *                                             they replace, an upper bound)
+ *   expand u:   |clauses with E| - |clauses with u or ¬u|
+ *
+ * and the cheapest step is taken. Once U is expanded away, E merges with
+ * the EXISTS block before U and the formula has one alternation less.
+ *
+ * After every step the new clauses are simplified: subsumption both ways
+ * (a clause containing another is dropped), unit clauses, and pure
+ * literals. When no universal is left, the existential remainder goes to
+ * a SAT call (QCDCLSolver on a single EXISTS block).
+ *
+ * Past the clause limit the solve gives up (exceededClauseLimit()) and the
+ * caller falls back to the engine the features would pick: memory stays
+ * bounded.
+ *
+ * Every step keeps the formula equivalent as a function of the outer
+ * variables, which are never eliminated. With an outer callback
+ * (QBFOuter.h) the final SAT call gives a winning outer assignment, and
+ * one more call per outer literal, with the literal flipped, tells
+ * whether it is forced; units on outer variables are forced at once.
+ */
+
+#ifndef EXPANSION_SOLVER_H
+#define EXPANSION_SOLVER_H
+
+#include "QBFOuter.h"
+#include "QBFPreprocessor.h"
+#include "QBFSolver.h"
+#include <chrono>
+#include <cstdint>
+#include <unordered_map>
+#include <vector>
+
+class ExpansionSolver {
+public:
+    ExpansionSolver();
+
+    void setVerbose(bool enabled);
+
+    // Give up with Result::UNKNOWN after this many seconds (0 = no limit)
+    void setTimeLimit(double seconds);
+
+    // Give up with Result::UNKNOWN when the matrix outgrows this many clauses
+    void setClauseLimit(long long clauses);
+
+    // Report the winning outer assignment and the forced outer literals
+    void setOuterCallback(const OuterCallback& callback);
+
+    Result solve(const QBFPreprocessor& preprocessor);
+
+    // UNKNOWN because of the clause limit (not the time limit)
+    bool exceededClauseLimit() const { return overflow; }
+
+    // Outer variables of the winning assignment (with an outer callback)
+    const std::unordered_map<int, bool>& getAssignments() const { return assignments; }
+
+    const SolverStats& getStats() const { return stats; }
+
+private:
+    std::vector<Clause> clauses;               // Sorted literals; removed ones stay
+    std::vector<bool> alive;
+    std::vector<std::vector<int>> occurrences; // Literal key → clauses (may list removed ones)
+    std::vector<int> counts;                   // Literal key → live clauses
+    std::vector<std::vector<int>> filed;       // Literal key → clauses filed under it (their rarest)
+    std::vector<uint64_t> signatures;          // Clause → bit per literal key mod 64
+    std::vector<int> level;                    // Variable → quantifier block (0: free)
+    std::vector<bool> universal;
+    std::vector<signed char> mark;             // Literals of the clause being subsumption-checked
+    std::vector<int> units;                    // Unit clauses not yet propagated
+    long long liveClauses;
+    bool falsified;                            // An empty clause was derived
+
+    long long clauseLimit;
+    bool overflow;
+    bool aborted;                              // Clause or time limit hit
+    long long clausesSinceCheck;
+
+    bool verbose;
+    double timeLimit;
+    std::chrono::steady_clock::time_point deadline;
+
+    OuterCallback outerCallback;
+    OuterTracker outer;
+    std::unordered_map<int, bool> assignments;
+    SolverStats stats;
+
+    static int key(const Literal& lit) { return 2 * lit.variable + (lit.isNegated ? 1 : 0); }
+    int newVariable(int blockLevel, bool isUniversal);
+    bool occurs(int var) const { return counts[2 * var] + counts[2 * var + 1] > 0; }
+
+    // Clause database
+    void addClause(Clause clause);
+    void removeClause(int id);
+    const std::vector<int>& occurrencesOf(const Literal& lit);
+    static uint64_t signature(const Clause& clause);
+    bool subsumed(const Clause& clause, uint64_t sig);
+    void removeSubsumed(const Clause& clause, uint64_t sig);
+
+    // Simplification
+    void assign(const Literal& lit);
+    void simplify();
+
+    // Elimination steps
+    void resolve(int var);
+    void expand(int var, const std::vector<int>& inner);
+    bool budget();
+
+    // The existential remainder
+    Result solveRemainder();
+    bool remainderSatisfiable(const std::vector<Literal>& assumed, std::vector<Literal>& cube);
+
+    std::string varString(int var) const { return "x" + std::to_string(var); }
+};
+
+#endif // EXPANSION_SOLVER_H
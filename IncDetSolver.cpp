@@ -0,0 +1,590 @@
+/*
+ * IncDetSolver.cpp - Skolem functions by propagation, decisions and SAT checks
+ */
+
+#include "IncDetSolver.h"
+#include "QCDCLSolver.h"
+#include <algorithm>
+#include <iostream>
+#include <map>
+#include <set>
+#include <sstream>
+
+IncDetSolver::IncDetSolver()
+    : decisionLevel(0), conflictLimit(100000), unsupported(false), overLimit(false), aborted(false),
+      verbose(false), timeLimit(0) {}
+
+void IncDetSolver::setVerbose(bool enabled) {
+    verbose = enabled;
+}
+
+void IncDetSolver::setTimeLimit(double seconds) {
+    timeLimit = seconds;
+}
+
+void IncDetSolver::setConflictLimit(long long conflicts) {
+    conflictLimit = std::max(0LL, conflicts);
+}
+
+void IncDetSolver::setOuterCallback(const OuterCallback& callback) {
+    outerCallback = callback;
+}
+
+// ============================================================================
+// Determination
+// ============================================================================
+
+bool IncDetSolver::isDetermined(int var) const {
+    return isUniversal.count(var) || position.count(var);
+}
+
+// Clauses of var whose other variables are all determined
+std::vector<int> IncDetSolver::antecedents(int var) const {
+    std::vector<int> result;
+    auto it = occurrences.find(var);
+    if (it == occurrences.end()) return result;
+    for (int c : it->second) {
+        bool ready = std::all_of(clauses[c].begin(), clauses[c].end(), [&](const Literal& lit) {
+            return lit.variable == var || isDetermined(lit.variable);
+        });
+        if (ready) result.push_back(c);
+    }
+    return result;
+}
+
+void IncDetSolver::determine(int var, int defaultValue) {
+    Definition definition{var, decisionLevel, defaultValue, {}, {}};
+    for (int c : antecedents(var)) {
+        for (const auto& lit : clauses[c]) {
+            if (lit.variable != var) continue;
+            (lit.isNegated ? definition.negative : definition.positive).push_back(c);
+        }
+    }
+    position[var] = trail.size();
+    trail.push_back(definition);
+}
+
+// Undo every variable determined above level
+void IncDetSolver::backtrack(int level) {
+    while (!trail.empty() && trail.back().level > level) {
+        position.erase(trail.back().var);
+        trail.pop_back();
+    }
+    decisionLevel = level;
+}
+
+/*
+ * The undetermined variable with the most antecedents (its function is
+ * pinned down the most already), ties to the prefix order. Its default
+ * is the sign it has in more of its other clauses, which it will help
+ * satisfy once they become antecedents of later variables.
+ */
+int IncDetSolver::pickDecision(int& value) const {
+    int best = 0;
+    size_t bestCount = 0;
+    for (int var : existentials) {
+        if (position.count(var)) continue;
+        size_t count = antecedents(var).size();
+        if (best == 0 || count > bestCount) {
+            best = var;
+            bestCount = count;
+        }
+    }
+    int positive = 0, negative = 0;
+    std::vector<int> ants = antecedents(best);
+    for (int c : occurrences.at(best)) {
+        if (std::find(ants.begin(), ants.end(), c) != ants.end()) continue;
+        for (const auto& lit : clauses[c]) {
+            if (lit.variable == best) (lit.isNegated ? negative : positive)++;
+        }
+    }
+    value = positive > negative ? 1 : 0;
+    return best;
+}
+
+// ============================================================================
+// SAT Checks
+// ============================================================================
+
+/*
+ * Encode the functions var depends on (the determined variables of its
+ * antecedents, their antecedents, and so on) as clauses, with one
+ * auxiliary variable per antecedent (its other literals are all false)
+ * and one per forcing condition (some antecedent of that sign is),
+ * then ask QCDCL about the purely existential result.
+ */
+Result IncDetSolver::check(int var, const std::vector<int>& ants, bool bothForced,
+                           std::unordered_map<int, bool>& model) {
+    int nextAux = 0;
+    std::set<int> used;
+    for (const auto& clause : clauses) {
+        for (const auto& lit : clause) nextAux = std::max(nextAux, lit.variable);
+    }
+    nextAux++;
+
+    std::vector<Clause> cnf;
+    auto forcing = [&](int target, const std::vector<int>& list) {
+        int f = nextAux++;
+        Clause any = {Literal(f, true)};
+        for (int c : list) {
+            int a = nextAux++;
+            Clause all = {Literal(a, false)};
+            for (const auto& lit : clauses[c]) {
+                if (lit.variable == target) continue;
+                cnf.push_back({Literal(a, true), lit.complement()});
+                all.push_back(lit);
+            }
+            cnf.push_back(all);
+            cnf.push_back({Literal(a, true), Literal(f, false)});
+            any.push_back(Literal(a, false));
+        }
+        cnf.push_back(any);
+        return f;
+    };
+
+    // The functions in the cone of var's antecedents
+    std::vector<bool> needed(trail.size(), false);
+    for (int c : ants) {
+        for (const auto& lit : clauses[c]) {
+            auto it = position.find(lit.variable);
+            if (lit.variable != var && it != position.end()) needed[it->second] = true;
+        }
+    }
+    for (size_t i = trail.size(); i-- > 0;) {
+        const Definition& d = trail[i];
+        if (!needed[i] || d.var == var) continue;
+        for (const auto* list : {&d.positive, &d.negative}) {
+            for (int c : *list) {
+                for (const auto& lit : clauses[c]) {
+                    auto it = position.find(lit.variable);
+                    if (lit.variable != d.var && it != position.end()) needed[it->second] = true;
+                }
+            }
+        }
+        Literal v(d.var, false);
+        int t = forcing(d.var, d.positive);
+        if (d.defaultValue == 1) {
+            // v = forcedTrue ∨ ¬forcedFalse
+            int n = forcing(d.var, d.negative);
+            cnf.push_back({Literal(t, true), v});
+            cnf.push_back({Literal(n, false), v});
+            cnf.push_back({v.complement(), Literal(t, false), Literal(n, true)});
+        } else {
+            // v = forcedTrue
+            cnf.push_back({Literal(t, true), v});
+            cnf.push_back({v.complement(), Literal(t, false)});
+        }
+    }
+
+    std::vector<int> positive, negative;
+    for (int c : ants) {
+        for (const auto& lit : clauses[c]) {
+            if (lit.variable == var) (lit.isNegated ? negative : positive).push_back(c);
+        }
+    }
+    int t = forcing(var, positive);
+    int n = forcing(var, negative);
+    cnf.push_back({Literal(t, !bothForced)});
+    cnf.push_back({Literal(n, !bothForced)});
+
+    QBFPreprocessor query;
+    for (const auto& clause : cnf) {
+        for (const auto& lit : clause) used.insert(lit.variable);
+    }
+    query.addQuantifierBlock(Quantifier::EXISTS, std::vector<int>(used.begin(), used.end()));
+    for (const auto& clause : cnf) query.addClause(clause);
+
+    QCDCLSolver solver;
+    if (timeLimit > 0) {
+        double left = std::chrono::duration<double>(deadline - std::chrono::steady_clock::now()).count();
+        if (left <= 0) {
+            aborted = true;
+            return Result::UNKNOWN;
+        }
+        solver.setTimeLimit(left);
+    }
+    stats.satCalls++;
+    Result result = solver.solve(query);
+    if (result == Result::UNKNOWN) aborted = true;
+
+    // The winning cube satisfies every clause whatever the rest is, so
+    // missing universals may be false
+    model.clear();
+    if (result == Result::SAT) {
+        for (const auto& lit : solver.getWinningLiterals()) {
+            if (isUniversal.count(lit.variable)) model[lit.variable] = !lit.isNegated;
+        }
+    }
+    return result;
+}
+
+// ============================================================================
+// Conflicts
+// ============================================================================
+
+bool IncDetSolver::forces(int clause, int var, const std::unordered_map<int, bool>& values) const {
+    for (const auto& lit : clauses[clause]) {
+        if (lit.variable == var) continue;
+        auto it = values.find(lit.variable);
+        bool value = it != values.end() && it->second;
+        if (value != lit.isNegated) return false;
+    }
+    return true;
+}
+
+std::unordered_map<int, bool> IncDetSolver::evaluate(const std::unordered_map<int, bool>& universalValues) const {
+    std::unordered_map<int, bool> values;
+    for (int var : universals) {
+        auto it = universalValues.find(var);
+        values[var] = it != universalValues.end() && it->second;
+    }
+    for (const Definition& d : trail) {
+        bool forcedTrue = std::any_of(d.positive.begin(), d.positive.end(),
+                                      [&](int c) { return forces(c, d.var, values); });
+        bool forcedFalse = std::any_of(d.negative.begin(), d.negative.end(),
+                                       [&](int c) { return forces(c, d.var, values); });
+        values[d.var] = forcedTrue || (d.defaultValue == 1 && !forcedFalse);
+    }
+    return values;
+}
+
+/*
+ * Resolve the two clauses that force var both ways, then every variable
+ * that is forced at the model with its forcing clause, latest first.
+ * Every literal stays false at the model, so no resolvent is a
+ * tautology.
+ */
+bool IncDetSolver::analyze(int var, const std::unordered_map<int, bool>& model) {
+    std::unordered_map<int, bool> values = evaluate(model);
+    auto forcingClause = [&](int v, bool value) {
+        const Definition& d = trail[position.at(v)];
+        for (int c : value ? d.positive : d.negative) {
+            if (forces(c, v, values)) return c;
+        }
+        return -1;
+    };
+    int up = forcingClause(var, true), down = forcingClause(var, false);
+    if (up < 0 || down < 0) {
+        aborted = true;  // The model does not show the conflict; cannot happen
+        return true;
+    }
+
+    std::map<int, bool> learned;   // Variable → negated
+    auto addAll = [&](int c, int pivot) {
+        for (const auto& lit : clauses[c]) {
+            if (lit.variable != pivot) learned[lit.variable] = lit.isNegated;
+        }
+    };
+    addAll(up, var);
+    addAll(down, var);
+    while (true) {
+        int pivot = 0, antecedent = -1;
+        for (const auto& [v, negated] : learned) {
+            if (isUniversal.count(v) || (pivot != 0 && position.at(v) < position.at(pivot))) continue;
+            int c = forcingClause(v, values.at(v));
+            if (c < 0) continue;
+            pivot = v;
+            antecedent = c;
+        }
+        if (pivot == 0) break;
+        learned.erase(pivot);
+        addAll(antecedent, pivot);
+    }
+
+    Clause clause;
+    int latest = 0;
+    for (const auto& [v, negated] : learned) {
+        clause.emplace_back(v, negated);
+        if (!isUniversal.count(v) && (latest == 0 || position.at(v) > position.at(latest))) latest = v;
+    }
+    if (verbose) {
+        std::ostringstream text;
+        for (size_t i = 0; i < clause.size(); i++) {
+            text << (i ? " ∨ " : "") << (clause[i].isNegated ? "¬" : "") << varString(clause[i].variable);
+        }
+        std::cout << "[ID] Conflict on " << varString(var) << ": learned (" << text.str() << ")" << std::endl;
+    }
+    if (latest == 0) return false;
+
+    stats.learnedClauses++;
+    clauses.push_back(clause);
+    for (const auto& lit : clause) occurrences[lit.variable].push_back(clauses.size() - 1);
+    backtrack(trail[position.at(latest)].level - 1);
+    return true;
+}
+
+// ============================================================================
+// Certificates
+// ============================================================================
+
+std::unordered_map<int, bool> IncDetSolver::evaluateCertificate(
+    const std::unordered_map<int, bool>& universalValues) const {
+    std::unordered_map<int, bool> values = evaluate(universalValues);
+    std::unordered_map<int, bool> result;
+    for (int var : prefixExistentials) {
+        auto it = values.find(var);
+        auto f = fixed.find(var);
+        result[var] = it != values.end() ? it->second : f != fixed.end() && f->second;
+    }
+    return result;
+}
+
+/*
+ * ASCII AIGER: "aag M I L O A", one line per input, output and AND gate,
+ * then the symbol table. Literal 2i (+1 negated) is variable i; 0 and 1
+ * are the constants.
+ */
+void IncDetSolver::writeCertificate(std::ostream& out) const {
+    std::unordered_map<int, int> literalOf;
+    int next = 1;
+    for (int var : prefixUniversals) literalOf[var] = 2 * next++;
+
+    std::vector<std::vector<int>> ands;
+    auto mkAnd = [&](int a, int b) {
+        if (a == 0 || b == 0 || a == (b ^ 1)) return 0;
+        if (a == 1 || a == b) return b;
+        if (b == 1) return a;
+        ands.push_back({2 * next, a, b});
+        return 2 * next++;
+    };
+    auto literal = [&](const Literal& lit) {
+        auto it = literalOf.find(lit.variable);
+        int a = it != literalOf.end() ? it->second : 0;
+        return lit.isNegated ? a ^ 1 : a;
+    };
+    auto forcing = [&](const Definition& d, const std::vector<int>& list) {
+        int none = 1;   // No antecedent has all other literals false
+        for (int c : list) {
+            int all = 1;
+            for (const auto& lit : clauses[c]) {
+                if (lit.variable != d.var) all = mkAnd(all, literal(lit) ^ 1);
+            }
+            none = mkAnd(none, all ^ 1);
+        }
+        return none ^ 1;
+    };
+    for (const Definition& d : trail) {
+        int t = forcing(d, d.positive);
+        literalOf[d.var] = d.defaultValue == 1 ? mkAnd(t ^ 1, forcing(d, d.negative)) ^ 1 : t;
+    }
+
+    out << "aag " << next - 1 << " " << prefixUniversals.size() << " 0 " << prefixExistentials.size() << " "
+        << ands.size() << "\n";
+    for (int var : prefixUniversals) out << literalOf[var] << "\n";
+    for (int var : prefixExistentials) {
+        auto it = literalOf.find(var);
+        auto f = fixed.find(var);
+        out << (it != literalOf.end() ? it->second : (f != fixed.end() && f->second) ? 1 : 0) << "\n";
+    }
+    for (const auto& gate : ands) out << gate[0] << " " << gate[1] << " " << gate[2] << "\n";
+    for (size_t i = 0; i < prefixUniversals.size(); i++) out << "i" << i << " " << varString(prefixUniversals[i]) << "\n";
+    for (size_t i = 0; i < prefixExistentials.size(); i++) {
+        out << "o" << i << " " << varString(prefixExistentials[i]) << "\n";
+    }
+    out << "c\nSkolem functions found by incremental determinization\n";
+}
+
+// ============================================================================
+// Main Entry Point
+// ============================================================================
+
+Result IncDetSolver::solve(const QBFPreprocessor& preprocessor) {
+    stats = SolverStats();
+    stats.engine = "incdet";
+    unsupported = overLimit = aborted = false;
+    if (timeLimit > 0) {
+        deadline = std::chrono::steady_clock::now() +
+                   std::chrono::duration_cast<std::chrono::steady_clock::duration>(
+                       std::chrono::duration<double>(timeLimit));
+    }
+    outer.reset(preprocessor, outerCallback);
+    clauses.clear();
+    occurrences.clear();
+    universals.clear();
+    existentials.clear();
+    isUniversal.clear();
+    prefixUniversals.clear();
+    prefixExistentials.clear();
+    trail.clear();
+    position.clear();
+    decisionLevel = 0;
+    fixed = preprocessor.getAssignments();
+
+    // The matrix without duplicate literals and tautologies
+    std::set<int> occurring;
+    for (const auto& clause : preprocessor.getClauses()) {
+        std::map<int, bool> lits;
+        bool tautology = false;
+        for (const auto& lit : clause) {
+            auto [it, inserted] = lits.emplace(lit.variable, lit.isNegated);
+            if (!inserted && it->second != lit.isNegated) tautology = true;
+        }
+        if (tautology) continue;
+        Clause kept;
+        for (const auto& [var, negated] : lits) {
+            kept.emplace_back(var, negated);
+            occurring.insert(var);
+        }
+        clauses.push_back(kept);
+    }
+
+    // ∀∃ only: no occurring existential (free variables included) before
+    // an occurring universal
+    std::set<int> bound;
+    bool existentialSeen = false;
+    for (const auto& block : preprocessor.getQuantifierBlocks()) {
+        for (int var : block.variables) {
+            bound.insert(var);
+            if (block.type == Quantifier::FORALL) {
+                prefixUniversals.push_back(var);
+                if (!occurring.count(var)) continue;
+                if (existentialSeen) unsupported = true;
+                universals.push_back(var);
+                isUniversal[var] = true;
+            } else {
+                prefixExistentials.push_back(var);
+                if (occurring.count(var)) {
+                    existentialSeen = true;
+                    existentials.push_back(var);
+                }
+            }
+        }
+    }
+    std::vector<int> free;
+    for (int var : occurring) {
+        if (!bound.count(var)) free.push_back(var);
+    }
+    for (const auto& [var, value] : fixed) {
+        if (!bound.count(var) && !occurring.count(var)) free.push_back(var);
+    }
+    std::sort(free.begin(), free.end());
+    if (!free.empty() && !universals.empty()) unsupported = true;
+    for (int var : free) {
+        prefixExistentials.push_back(var);
+        if (occurring.count(var)) existentials.push_back(var);
+    }
+    if (unsupported) {
+        if (verbose) std::cout << "[ID] Not a ∀∃ prefix: nothing to do" << std::endl;
+        return Result::UNKNOWN;
+    }
+
+    for (size_t c = 0; c < clauses.size(); c++) {
+        for (const auto& lit : clauses[c]) occurrences[lit.variable].push_back(c);
+    }
+    if (verbose) {
+        std::cout << "[SOLVE] Incremental determinization: " << universals.size() << " universals, "
+                  << existentials.size() << " existentials, " << clauses.size() << " clauses" << std::endl;
+    }
+
+    // A clause without existentials is false once reduced
+    Result result = Result::UNKNOWN;
+    for (const auto& clause : clauses) {
+        if (std::none_of(clause.begin(), clause.end(), [&](const Literal& lit) { return !isUniversal.count(lit.variable); })) {
+            result = Result::UNSAT;
+        }
+    }
+
+    std::vector<int> queue(existentials.begin(), existentials.end());
+    std::set<int> queued(queue.begin(), queue.end());
+    auto touch = [&](int var) {
+        for (int c : occurrences[var]) {
+            for (const auto& lit : clauses[c]) {
+                if (!isDetermined(lit.variable) && queued.insert(lit.variable).second) queue.push_back(lit.variable);
+            }
+        }
+    };
+
+    // Conflict check for the variable just determined; false: UNSAT or stopped
+    std::unordered_map<int, bool> model;
+    auto consistent = [&](int var) {
+        const Definition& d = trail.back();
+        std::vector<int> ants = d.positive;
+        ants.insert(ants.end(), d.negative.begin(), d.negative.end());
+        if (d.positive.empty() || d.negative.empty() || check(var, ants, true, model) != Result::SAT) return !aborted;
+
+        stats.conflicts++;
+        if (!analyze(var, model)) {
+            result = Result::UNSAT;
+            return false;
+        }
+        if (stats.conflicts >= conflictLimit) {
+            overLimit = aborted = true;
+            return false;
+        }
+        // The learned clause is a new antecedent: look at everything again
+        for (int v : existentials) {
+            if (!isDetermined(v) && queued.insert(v).second) queue.push_back(v);
+        }
+        if (verbose) std::cout << "[ID] Backtrack to level " << decisionLevel << std::endl;
+        return !aborted;
+    };
+
+    while (result == Result::UNKNOWN && !aborted) {
+        // Propagation: determine every deterministic variable
+        while (!queue.empty() && !aborted) {
+            int var = queue.back();
+            queue.pop_back();
+            queued.erase(var);
+            if (isDetermined(var)) continue;
+            std::vector<int> ants = antecedents(var);
+            bool positive = false, negative = false;
+            for (int c : ants) {
+                for (const auto& lit : clauses[c]) {
+                    if (lit.variable == var) (lit.isNegated ? negative : positive) = true;
+                }
+            }
+            if (!positive || !negative || check(var, ants, false, model) != Result::UNSAT) continue;
+
+            determine(var, -1);
+            stats.detPropagated++;
+            if (verbose) {
+                std::cout << "[ID] " << varString(var) << " is deterministic (" << ants.size()
+                          << " antecedents, level " << decisionLevel << ")" << std::endl;
+            }
+            if (!consistent(var)) break;
+            if (isDetermined(var)) touch(var);
+        }
+        if (result != Result::UNKNOWN || aborted) break;
+        if (!queue.empty()) continue;
+
+        if (trail.size() == existentials.size()) {
+            result = Result::SAT;
+            break;
+        }
+
+        // Stuck: decide
+        int value = 0;
+        int var = pickDecision(value);
+        decisionLevel++;
+        determine(var, value);
+        stats.detDecided++;
+        if (verbose) {
+            std::cout << "[ID] Decide " << varString(var) << " = " << (value ? "true" : "false")
+                      << " where not forced (level " << decisionLevel << ")" << std::endl;
+        }
+        if (consistent(var) && isDetermined(var)) touch(var);
+    }
+
+    if (aborted && result == Result::UNKNOWN) {
+        if (verbose) {
+            std::cout << (overLimit ? "[ID] Conflict limit reached (" + std::to_string(conflictLimit) + " conflicts)"
+                                    : std::string("[TIMEOUT] Time limit reached"))
+                      << std::endl;
+        }
+    } else if (verbose) {
+        std::cout << "[ID] " << (result == Result::SAT ? "Every existential determined: true"
+                                                       : "Learned a clause without existentials: false")
+                  << " (" << stats.detPropagated << " propagated, " << stats.detDecided << " decided, "
+                  << stats.satCalls << " SAT calls)" << std::endl;
+    }
+
+    // Only a formula without universals has an outer EXISTS block here:
+    // its functions are constants
+    std::unordered_map<int, bool> values;
+    if (result == Result::SAT) values = evaluateCertificate({});
+    outer.finish(result == Result::SAT, result == Result::UNSAT, [&](int var) {
+        auto it = values.find(var);
+        return it != values.end() ? (it->second ? 1 : 0) : -1;
+    });
+    return result;
+}
@@ -0,0 +1,164 @@
+/*
+ * IncDetSolver.h - 2QBF by Incremental Determinization
+ *
+ * A ∀∃ formula  ∀X ∃Y φ  is true exactly when every y in Y has a SKOLEM
+ * FUNCTION - a Boolean function of X - such that φ holds for every X
+ * once each y is replaced by its function. Search engines never build
+ * these functions; incremental determinization (as in CADET) builds them
+ * one variable at a time and uses a SAT solver to check each step.
+ *
+ * DETERMINED VARIABLES. The universals are determined from the start. A
+ * clause is an ANTECEDENT of y when every other variable in it was
+ * determined before y; if all its other literals are false, it FORCES y:
+ *
+ *   forcedTrue(y)  = some (y ∨ C) with C false
+ *   forcedFalse(y) = some (¬y ∨ C) with C false
+ *
+ * y is determined with the function y = forcedTrue(y), which every
+ * Skolem function has to agree with wherever y is forced.
+ *
+ * PROPAGATION. y is DETERMINISTIC when it is forced one way or the other
+ * for every X; then its function is the only one possible (a UNIQUE
+ * DEFINITION, typically a gate output). Whether it is takes one SAT call:
+ *
+ *   SAT? (functions so far) ∧ ¬forcedTrue(y) ∧ ¬forcedFalse(y)
+ *
+ * UNSAT means deterministic. Propagation determines variables this way
+ * for as long as it can.
+ *
+ * CONFLICTS. Each newly determined y also gets the opposite check: can y
+ * be forced both ways?  A model of
+ *
+ *   (functions so far) ∧ forcedTrue(y) ∧ forcedFalse(y)
+ *
+ * is a universal assignment x* under which no function works. The two
+ * forcing clauses are resolved on y, and every variable in the result
+ * that was forced at x* is resolved away with its forcing clause (latest
+ * determined first). What is left is learned: its literals are all false
+ * at x*, and it only keeps universals and DECISION variables.
+ *
+ * DECISIONS. When propagation is stuck, an undetermined y is decided: it
+ * takes a default value wherever its antecedents do not force it,
+ * y = forcedTrue(y) ∨ (¬forcedFalse(y) ∧ default). A learned clause
+ * undoes its latest decision and everything determined after it; the
+ * clause is then an antecedent of that variable, and forces the other
+ * value at x*. A learned clause with no existential literal left is
+ * false for x* whatever Y does (universal reduction), so the formula is
+ * false.
+ *
+ * When every variable is determined without a conflict, every clause is
+ * an antecedent of its last determined variable and therefore satisfied:
+ * the functions are a SKOLEM CERTIFICATE, written as an AIGER circuit by
+ * writeCertificate().
+ *
+ * The engine handles prefixes in which every existential comes after
+ * every universal (∀∃, and ∃ alone); for others unsupportedPrefix() is
+ * set at once. Past the conflict limit it gives up
+ * (exceededConflictLimit()); the caller then falls back to the engine
+ * the formula features would pick.
+ */
+
+#ifndef INC_DET_SOLVER_H
+#define INC_DET_SOLVER_H
+
+#include "QBFOuter.h"
+#include "QBFPreprocessor.h"
+#include "QBFSolver.h"
+#include <chrono>
+#include <ostream>
+#include <unordered_map>
+#include <vector>
+
+class IncDetSolver {
+public:
+    IncDetSolver();
+
+    void setVerbose(bool enabled);
+
+    // Give up with Result::UNKNOWN after this many seconds (0 = no limit)
+    void setTimeLimit(double seconds);
+
+    // Give up with Result::UNKNOWN after this many conflicts
+    void setConflictLimit(long long conflicts);
+
+    // Report the winning outer assignment (formulas without universals)
+    void setOuterCallback(const OuterCallback& callback);
+
+    Result solve(const QBFPreprocessor& preprocessor);
+
+    // UNKNOWN because the prefix is not ∀∃, or because of the conflict
+    // limit (not the time limit)
+    bool unsupportedPrefix() const { return unsupported; }
+    bool exceededConflictLimit() const { return overLimit; }
+
+    // After SAT: the Skolem functions' values for a universal assignment
+    // (missing universals are false), for every existential variable of
+    // the formula, including those fixed by preprocessing
+    std::unordered_map<int, bool> evaluateCertificate(const std::unordered_map<int, bool>& universals) const;
+
+    // After SAT: the Skolem functions as an ASCII AIGER circuit, inputs
+    // the universal variables, outputs the existential ones
+    void writeCertificate(std::ostream& out) const;
+
+    const SolverStats& getStats() const { return stats; }
+
+private:
+    // How a determined existential got its function
+    struct Definition {
+        int var;
+        int level;                 // Decisions before it on the trail
+        int defaultValue;          // -1: propagated; 0/1: decided
+        std::vector<int> positive; // Antecedents (y ∨ C)
+        std::vector<int> negative; // Antecedents (¬y ∨ C)
+    };
+
+    std::vector<Clause> clauses;               // Matrix, then learned clauses
+    std::unordered_map<int, std::vector<int>> occurrences;   // Variable → clauses
+    std::vector<int> universals;
+    std::vector<int> existentials;
+    std::unordered_map<int, bool> isUniversal;
+    std::unordered_map<int, bool> fixed;       // Assigned by preprocessing
+    std::vector<int> prefixUniversals;         // All universals of the prefix
+    std::vector<int> prefixExistentials;       // All existentials of the prefix
+
+    std::vector<Definition> trail;             // Determined existentials, in order
+    std::unordered_map<int, int> position;     // Variable → index in trail
+    int decisionLevel;
+
+    long long conflictLimit;
+    bool unsupported;
+    bool overLimit;
+    bool aborted;                              // Time limit hit
+
+    bool verbose;
+    double timeLimit;
+    std::chrono::steady_clock::time_point deadline;
+
+    OuterCallback outerCallback;
+    OuterTracker outer;
+    SolverStats stats;
+
+    // Determination
+    bool isDetermined(int var) const;
+    std::vector<int> antecedents(int var) const;
+    void determine(int var, int defaultValue);
+    void backtrack(int level);
+    int pickDecision(int& value) const;
+
+    // SAT checks over the functions of the determined variables. With
+    // both forced: can var be forced both ways (conflict)? Otherwise:
+    // can it be forced neither way (not deterministic)? model receives
+    // the universal values of a SAT answer
+    Result check(int var, const std::vector<int>& ants, bool bothForced, std::unordered_map<int, bool>& model);
+
+    // Function values for a universal assignment
+    std::unordered_map<int, bool> evaluate(const std::unordered_map<int, bool>& universalValues) const;
+    bool forces(int clause, int var, const std::unordered_map<int, bool>& values) const;
+
+    // Clause learned from a conflict of var at model; false: the formula is false
+    bool analyze(int var, const std::unordered_map<int, bool>& model);
+
+    std::string varString(int var) const { return "x" + std::to_string(var); }
+};
+
+#endif // INC_DET_SOLVER_H
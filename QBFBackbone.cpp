@@ -0,0 +1,124 @@
+/*
+ * QBFBackbone.cpp - Outer backbone by assumption calls on one QCDCL solver
+ */
+
+#include "QBFBackbone.h"
+#include "QCDCLSolver.h"
+#include <algorithm>
+#include <chrono>
+#include <iostream>
+#include <unordered_map>
+
+void QBFBackbone::setSymmetries(const SymmetryInfo& value) {
+    symmetries = value;
+}
+
+void QBFBackbone::setDualPropagation(bool enabled) {
+    dual = enabled;
+}
+
+void QBFBackbone::setVerbose(bool enabled) {
+    verbose = enabled;
+}
+
+void QBFBackbone::setTimeLimit(double seconds) {
+    timeLimit = seconds;
+}
+
+Result QBFBackbone::compute(const QBFPreprocessor& preprocessor) {
+    auto start = std::chrono::steady_clock::now();
+    backbone.clear();
+    undecided.clear();
+    complete = false;
+    calls = filtered = levelZero = 0;
+
+    QCDCLSolver solver;
+    solver.setVerbose(verbose);
+    solver.setSymmetries(symmetries);
+    solver.setDualPropagation(dual);
+    solver.setTimeLimit(timeLimit);
+    Result result = solver.solve(preprocessor);
+    calls++;
+    stats = solver.getStats();
+    if (result != Result::SAT) {
+        complete = (result == Result::UNSAT);
+        return result;
+    }
+
+    // Values of a winning assignment, by variable
+    auto planOf = [&]() {
+        std::unordered_map<int, bool> plan;
+        for (const auto& lit : solver.getWinningLiterals()) plan[lit.variable] = !lit.isNegated;
+        return plan;
+    };
+
+    // Outer variables fixed by preprocessing are forced; the first
+    // winning assignment names the candidates among the others
+    const auto& fixed = preprocessor.getAssignments();
+    std::unordered_map<int, bool> plan = planOf();
+    std::vector<Literal> candidates;
+    for (int var : outerBlockVariables(preprocessor)) {
+        auto it = fixed.find(var);
+        if (it != fixed.end()) {
+            backbone.emplace_back(var, !it->second);
+            continue;
+        }
+        auto planned = plan.find(var);
+        if (planned != plan.end()) candidates.emplace_back(var, !planned->second);
+    }
+
+    size_t next = 0;
+    for (; next < candidates.size(); next++) {
+        const Literal& lit = candidates[next];
+        if (lit.variable == 0) continue;  // Dropped
+        int forced = solver.levelZeroValue(lit.variable);
+        if (forced >= 0) {
+            if (forced == (lit.isNegated ? 0 : 1)) {
+                backbone.push_back(lit);
+                levelZero++;
+            }
+            continue;
+        }
+
+        if (timeLimit > 0) {
+            double left = timeLimit - std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+            if (left <= 0) break;
+            solver.setTimeLimit(left);
+        }
+        if (verbose) {
+            std::cout << "[BACKBONE] Assuming x" << lit.variable << (lit.isNegated ? "=true" : "=false")
+                      << std::endl;
+        }
+        Result answer = solver.solveAssuming({lit.complement()});
+        calls++;
+        if (answer == Result::UNKNOWN) break;
+        if (answer == Result::UNSAT) {
+            backbone.push_back(lit);
+            continue;
+        }
+
+        // Another winning assignment: it rules out every candidate it
+        // does not agree with
+        plan = planOf();
+        for (size_t i = next + 1; i < candidates.size(); i++) {
+            Literal& other = candidates[i];
+            if (other.variable == 0) continue;
+            auto planned = plan.find(other.variable);
+            if (planned == plan.end() || planned->second == other.isNegated) {
+                other.variable = 0;
+                filtered++;
+            }
+        }
+    }
+    for (; next < candidates.size(); next++) {
+        if (candidates[next].variable != 0) undecided.push_back(candidates[next]);
+    }
+    complete = undecided.empty();
+
+    auto byVariable = [](const Literal& a, const Literal& b) { return a.variable < b.variable; };
+    std::sort(backbone.begin(), backbone.end(), byVariable);
+    SolverStats last = solver.getStats();  // Counters add up over the calls
+    last.engine = stats.engine;
+    stats = last;
+    return result;
+}
@@ -0,0 +1,87 @@
+/*
+ * QBFBackbone.h - Literals Forced in Every Winning Outer Assignment
+ *
+ * Callers of a QBF solver often only act on the OUTERMOST existential
+ * block (see QBFOuter.h). Of its literals, the most useful ones are the
+ * BACKBONE: literals that hold in every winning outer assignment. They
+ * are moves EXISTS is forced to make, whatever strategy it follows, so a
+ * caller can commit to them without looking at any strategy.
+ *
+ *   ∃x1 x2 x3 ∀u ∃y:  x1 must be true, x2 may be either, x3 must be false
+ *   → backbone {x1=true, x3=false}
+ *
+ * ALGORITHM: one QCDCL solver answers every question, with assumptions.
+ *
+ *   1. Solve the formula. UNSAT: nothing wins, so there is no backbone.
+ *      SAT: the winning cube is a first winning assignment. The outer
+ *      literals it plays are the CANDIDATES. A variable it leaves open is
+ *      a don't-care, and so is not in the backbone.
+ *   2. For each candidate l, solve again ASSUMING ¬l:
+ *        UNSAT  no winning assignment contains ¬l: l is in the backbone
+ *        SAT    the new winning cube is another winning assignment; every
+ *               candidate it contradicts or leaves open is dropped
+ *   3. A candidate that is already implied at decision level 0 is in the
+ *      backbone without a call of its own.
+ *
+ * Each call keeps the clauses and cubes learned by the earlier ones
+ * (QCDCLSolver::solveAssuming): they are implied by the formula alone. A
+ * clause learned while refuting ¬l, such as (l), often settles the next
+ * candidates at level 0.
+ *
+ * PREPROCESSING must leave the outer variables frozen (freezeOuterBlock
+ * before preprocess()). Pure literal elimination picks one winning value
+ * and hides the other. Unit propagation only fixes values that every
+ * winning assignment has, and those are in the backbone.
+ */
+
+#ifndef QBF_BACKBONE_H
+#define QBF_BACKBONE_H
+
+#include "QBFOuter.h"
+#include "QBFPreprocessor.h"
+#include "QBFSolver.h"
+#include "QBFSymmetry.h"
+#include <vector>
+
+class QBFBackbone {
+public:
+    // Symmetry breaking must not touch the outer block (its clauses would
+    // rule out winning assignments); universal symmetries are fine
+    void setSymmetries(const SymmetryInfo& symmetries);
+    void setDualPropagation(bool enabled);
+    void setVerbose(bool enabled);
+
+    // For all calls together; an unfinished backbone is reported as such
+    void setTimeLimit(double seconds);
+
+    // Solve the formula and compute the outer backbone if it is true
+    Result compute(const QBFPreprocessor& preprocessor);
+
+    // Backbone literals sorted by variable. If the time ran out, these are
+    // the ones proven so far and getUndecided() lists the rest.
+    const std::vector<Literal>& getBackbone() const { return backbone; }
+    const std::vector<Literal>& getUndecided() const { return undecided; }
+    bool isComplete() const { return complete; }
+
+    // Statistics of the first solve, plus the assumption calls
+    const SolverStats& getStats() const { return stats; }
+    long long getCalls() const { return calls; }
+    long long getFiltered() const { return filtered; }
+    long long getLevelZero() const { return levelZero; }
+
+private:
+    SymmetryInfo symmetries;
+    bool dual = false;
+    bool verbose = false;
+    double timeLimit = 0;
+
+    std::vector<Literal> backbone;
+    std::vector<Literal> undecided;
+    bool complete = false;
+    SolverStats stats;
+    long long calls = 0;      // Solver calls, the first one included
+    long long filtered = 0;   // Candidates dropped by a winning cube
+    long long levelZero = 0;  // Candidates proven by a level-0 implication
+};
+
+#endif // QBF_BACKBONE_H
@@ -0,0 +1,451 @@
+/*
+ * QBFCache.cpp - Fingerprint computation and the result cache
+ */
+
+#include "QBFCache.h"
+#include <algorithm>
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <filesystem>
+#include <fstream>
+#include <iterator>
+#include <map>
+#include <set>
+#include <unistd.h>
+#include <vector>
+
+// Bump when the fingerprint definition changes, so old entries are not reused
+static const uint64_t FINGERPRINT_VERSION = 3;
+
+// ============================================================================
+// Hashing
+// ============================================================================
+
+/*
+ * SplitMix64 finalizer: a fixed, well-mixing 64-bit hash. We do not use
+ * std::hash because its values may differ between builds, and cache files
+ * must stay valid across builds.
+ */
+static uint64_t mix(uint64_t x) {
+    x += 0x9e3779b97f4a7c15ULL;
+    x = (x ^ (x >> 30)) * 0xbf58476d1ce4e5b9ULL;
+    x = (x ^ (x >> 27)) * 0x94d049bb133111ebULL;
+    return x ^ (x >> 31);
+}
+
+// Hash a sequence of values (order matters; sort first for a multiset)
+static uint64_t hashSequence(uint64_t seed, const std::vector<uint64_t>& values) {
+    uint64_t h = mix(seed ^ values.size());
+    for (uint64_t v : values) h = mix(h ^ v);
+    return h;
+}
+
+// ============================================================================
+// Canonical Form
+// ============================================================================
+
+namespace {
+
+// The normalized formula on dense variable indices 0..n-1
+struct NormalizedFormula {
+    std::vector<std::vector<int>> clauses;   // Literals as 2*index + negated
+    std::vector<int> level;                  // Index → quantifier level
+    std::vector<bool> levelUniversal;
+};
+
+/*
+ * An ordered partition of the vertices: elems lists them cell by cell,
+ * a cell is named by its first position, and the order of the cells is
+ * the order the labeling will number them in.
+ */
+struct Partition {
+    std::vector<int> elems;     // Position → vertex
+    std::vector<int> pos;       // Vertex → position
+    std::vector<int> cellOf;    // Vertex → first position of its cell
+    std::vector<int> cellEnd;   // First position of a cell → one past its last
+};
+
+class CanonicalLabeling {
+public:
+    explicit CanonicalLabeling(const NormalizedFormula& formula)
+        : f(formula), numLits(2 * formula.level.size()), nodes(0), work(0), exhausted(false) {
+        size_t size = f.level.size();
+        for (const auto& clause : f.clauses) size += clause.size();
+        // Every leaf prints the whole formula once
+        nodeBudget = std::max<size_t>(1, std::min<size_t>(256, 1000000 / (size + 1)));
+        workBudget = 20 * size + 1000000;
+
+        /*
+         * The graph: a vertex per literal and per clause, a literal joined
+         * to its clauses and to its complement. Stored as adjacency ranges.
+         */
+        size_t numVertices = numLits + f.clauses.size();
+        std::vector<int> degree(numVertices, 0);
+        for (size_t c = 0; c < f.clauses.size(); c++) {
+            for (int lit : f.clauses[c]) {
+                degree[lit]++;
+                degree[numLits + c]++;
+            }
+        }
+        for (size_t lit = 0; lit < numLits; lit++) degree[lit]++;
+        adjStart.assign(numVertices + 1, 0);
+        for (size_t v = 0; v < numVertices; v++) adjStart[v + 1] = adjStart[v] + degree[v];
+        adj.resize(adjStart[numVertices]);
+        std::vector<int> fill(adjStart.begin(), adjStart.end() - 1);
+        for (size_t c = 0; c < f.clauses.size(); c++) {
+            for (int lit : f.clauses[c]) {
+                adj[fill[lit]++] = numLits + c;
+                adj[fill[numLits + c]++] = lit;
+            }
+        }
+        for (size_t lit = 0; lit < numLits; lit++) adj[fill[lit]++] = lit ^ 1;
+        count.assign(numVertices, 0);
+    }
+
+    std::string run() {
+        /*
+         * Initial cells: the clauses, then the literals by quantifier
+         * level, positive before negative.
+         */
+        size_t numVertices = count.size();
+        auto key = [&](int v) {
+            return v >= (int)numLits ? 0 : 1 + 2 * f.level[v >> 1] + (v & 1);
+        };
+        Partition p;
+        p.elems.resize(numVertices);
+        for (size_t v = 0; v < numVertices; v++) p.elems[v] = v;
+        std::stable_sort(p.elems.begin(), p.elems.end(), [&](int a, int b) { return key(a) < key(b); });
+        p.pos.resize(numVertices);
+        p.cellOf.resize(numVertices);
+        p.cellEnd.assign(numVertices, 0);
+        std::vector<int> queue;
+        for (size_t i = 0; i < numVertices; i++) {
+            p.pos[p.elems[i]] = i;
+            bool first = i == 0 || key(p.elems[i]) != key(p.elems[i - 1]);
+            p.cellOf[p.elems[i]] = first ? i : p.cellOf[p.elems[i - 1]];
+            p.cellEnd[p.cellOf[p.elems[i]]] = i + 1;
+            if (first) queue.push_back(i);
+        }
+
+        search(p, queue);
+        if (exhausted) {
+            // Too big to canonicalize: the formula as numbered in the input
+            std::vector<int> order(f.level.size());
+            for (size_t v = 0; v < order.size(); v++) order[v] = v;
+            return certificate(order);
+        }
+        return best;
+    }
+
+private:
+    const NormalizedFormula& f;
+    size_t numLits;
+    std::vector<int> adjStart, adj;
+    std::vector<int> count;      // Scratch: neighbours in the current splitter
+    size_t nodes, nodeBudget;
+    size_t work, workBudget;
+    bool exhausted;
+    std::string best;
+
+    /*
+     * Refine until every vertex of a cell has as many neighbours in each
+     * cell as the others (an equitable partition). A cell from the queue
+     * is a SPLITTER: only the cells of its neighbours can split, by their
+     * neighbour count, into subcells ordered by that count. Of the new
+     * subcells, all but the largest join the queue (the largest is
+     * implied by the others), so each vertex is looked at O(log n) times
+     * and a long chain refines in near-linear time, not one round per
+     * link. Returns false when the work budget runs out.
+     */
+    bool refine(Partition& p, std::vector<int> queue) {
+        std::vector<bool> queued(p.elems.size(), false);
+        for (int s : queue) queued[s] = true;
+        std::vector<int> touched;
+        std::vector<std::pair<int, int>> byCell;
+        for (size_t head = 0; head < queue.size(); head++) {
+            int s = queue[head];
+            queued[s] = false;
+            for (int i = s; i < p.cellEnd[s]; i++) {
+                int u = p.elems[i];
+                for (int k = adjStart[u]; k < adjStart[u + 1]; k++) {
+                    if (count[adj[k]]++ == 0) touched.push_back(adj[k]);
+                }
+                work += adjStart[u + 1] - adjStart[u];
+            }
+
+            // The touched vertices, cell by cell
+            byCell.clear();
+            for (int w : touched) byCell.push_back({p.cellOf[w], w});
+            std::sort(byCell.begin(), byCell.end());
+            for (size_t i = 0; i < byCell.size();) {
+                size_t j = i;
+                while (j < byCell.size() && byCell[j].first == byCell[i].first) j++;
+                split(p, byCell[i].first, byCell.begin() + i, byCell.begin() + j, queue, queued);
+                i = j;
+            }
+
+            for (int w : touched) count[w] = 0;
+            touched.clear();
+            if (work > workBudget) {
+                exhausted = true;
+                return false;
+            }
+        }
+        return true;
+    }
+
+    // Split cell c by the neighbour counts of its touched vertices [from, to):
+    // untouched vertices first, then by count
+    using TouchedIt = std::vector<std::pair<int, int>>::iterator;
+    void split(Partition& p, int c, TouchedIt from, TouchedIt to, std::vector<int>& queue,
+               std::vector<bool>& queued) {
+        int end = p.cellEnd[c];
+        if (end - c == 1) return;
+        // Move the touched vertices to the back of the cell
+        int back = end;
+        for (auto it = from; it != to; ++it) {
+            int v = it->second;
+            back--;
+            int other = p.elems[back];
+            std::swap(p.elems[p.pos[v]], p.elems[back]);
+            p.pos[other] = p.pos[v];
+            p.pos[v] = back;
+        }
+        std::sort(p.elems.begin() + back, p.elems.begin() + end,
+                  [&](int a, int b) { return count[a] < count[b]; });
+        for (int i = back; i < end; i++) p.pos[p.elems[i]] = i;
+        work += end - back;
+        if (back == c && count[p.elems[c]] == count[p.elems[end - 1]]) return;  // No split
+
+        // The new cell boundaries
+        std::vector<int> starts;
+        if (back > c) starts.push_back(c);
+        for (int i = back; i < end; i++) {
+            if (i == back || count[p.elems[i]] != count[p.elems[i - 1]]) starts.push_back(i);
+        }
+        for (size_t k = 0; k < starts.size(); k++) {
+            int cellEnd = k + 1 < starts.size() ? starts[k + 1] : end;
+            p.cellEnd[starts[k]] = cellEnd;
+            for (int i = std::max(starts[k], back); i < cellEnd; i++) p.cellOf[p.elems[i]] = starts[k];
+        }
+
+        size_t largest = 0;
+        for (size_t k = 1; k < starts.size(); k++) {
+            int size = p.cellEnd[starts[k]] - starts[k];
+            if (size > p.cellEnd[starts[largest]] - starts[largest]) largest = k;
+        }
+        for (size_t k = 0; k < starts.size(); k++) {
+            if (queued[starts[k]] || (!queued[c] && k == largest)) continue;
+            queued[starts[k]] = true;
+            queue.push_back(starts[k]);
+        }
+    }
+
+    /*
+     * Print the formula with variable order[i] numbered i + 1: the prefix
+     * shape, the level of every number, then the sorted clauses.
+     */
+    std::string certificate(const std::vector<int>& order) {
+        std::vector<int> number(order.size());
+        for (size_t i = 0; i < order.size(); i++) number[order[i]] = i + 1;
+
+        std::string text = "q";
+        for (bool isUniversal : f.levelUniversal) text += isUniversal ? " a" : " e";
+        text += "\nl";
+        for (int v : order) text += " " + std::to_string(f.level[v]);
+        text += "\n";
+
+        std::vector<std::vector<int>> renamed;
+        for (const auto& clause : f.clauses) {
+            std::vector<int> lits;
+            for (int lit : clause) lits.push_back((lit & 1) ? -number[lit >> 1] : number[lit >> 1]);
+            std::sort(lits.begin(), lits.end());
+            renamed.push_back(lits);
+            work += lits.size();
+        }
+        std::sort(renamed.begin(), renamed.end());
+        for (const auto& clause : renamed) {
+            for (int lit : clause) text += std::to_string(lit) + " ";
+            text += "0\n";
+        }
+        return text;
+    }
+
+    /*
+     * Refine; at a partition with a cell of several vertices,
+     * individualize each member of the smallest such cell in turn (move
+     * it to a cell of its own in front) and recurse. Every choice depends
+     * only on the cells, so the smallest certificate over all leaves is
+     * the same for every renaming. Variables are numbered in the order of
+     * their positive literals; past the node budget the vertices still
+     * sharing a cell keep the order refinement left them in.
+     */
+    void search(Partition p, const std::vector<int>& queue) {
+        nodes++;
+        if (!refine(p, queue)) return;
+
+        int target = -1;
+        for (size_t i = 0; i < p.elems.size(); i = p.cellEnd[i]) {
+            int size = p.cellEnd[i] - i;
+            if (size > 1 && (target < 0 || size < p.cellEnd[target] - target)) target = i;
+        }
+
+        if (target < 0 || nodes >= nodeBudget) {
+            std::vector<int> order(f.level.size());
+            for (size_t v = 0; v < order.size(); v++) order[v] = v;
+            std::sort(order.begin(), order.end(), [&](int a, int b) { return p.pos[2 * a] < p.pos[2 * b]; });
+            std::string text = certificate(order);
+            if (best.empty() || text < best) best = std::move(text);
+            return;
+        }
+
+        std::vector<int> members(p.elems.begin() + target, p.elems.begin() + p.cellEnd[target]);
+        std::sort(members.begin(), members.end());
+        for (int v : members) {
+            if (exhausted || (nodes >= nodeBudget && !best.empty())) return;
+            Partition child = p;
+            int end = child.cellEnd[target];
+            int other = child.elems[target];
+            std::swap(child.elems[target], child.elems[child.pos[v]]);
+            child.pos[other] = child.pos[v];
+            child.pos[v] = target;
+            child.cellEnd[target] = target + 1;
+            child.cellEnd[target + 1] = end;
+            for (int i = target + 1; i < end; i++) child.cellOf[child.elems[i]] = target + 1;
+            search(std::move(child), {target});
+        }
+    }
+};
+
+}  // namespace
+
+std::string canonicalForm(const QBFPreprocessor& preprocessor) {
+    /*
+     * Normalize the matrix: sorted literals without duplicates, no
+     * tautologies, no duplicate clauses. None of this changes the meaning.
+     */
+    std::set<std::vector<int>> clauseSet;
+    for (const auto& clause : preprocessor.getClauses()) {
+        std::vector<int> lits;
+        for (const auto& lit : clause) lits.push_back(lit.isNegated ? -lit.variable : lit.variable);
+        std::sort(lits.begin(), lits.end());
+        lits.erase(std::unique(lits.begin(), lits.end()), lits.end());
+
+        bool tautology = false;
+        for (int lit : lits) {
+            if (lit > 0 && std::binary_search(lits.begin(), lits.end(), -lit)) tautology = true;
+        }
+        if (!tautology) clauseSet.insert(lits);
+    }
+
+    // Variables occurring in the matrix get dense indices
+    std::map<int, int> index;
+    for (const auto& lits : clauseSet) {
+        for (int lit : lits) index.emplace(std::abs(lit), 0);
+    }
+    int next = 0;
+    for (auto& [var, i] : index) i = next++;
+
+    NormalizedFormula formula;
+    for (const auto& lits : clauseSet) {
+        std::vector<int> clause;
+        for (int lit : lits) clause.push_back(2 * index[std::abs(lit)] + (lit < 0 ? 1 : 0));
+        formula.clauses.push_back(clause);
+    }
+
+    /*
+     * Normalize the prefix: keep only occurring variables, treat free
+     * variables as outermost existentials and merge adjacent blocks of the
+     * same quantifier. Level numbers then only reflect the alternations.
+     */
+    formula.level.assign(index.size(), -1);
+    auto place = [&](int var, Quantifier q) {
+        auto it = index.find(var);
+        if (it == index.end() || formula.level[it->second] >= 0) return;
+        bool isUniversal = (q == Quantifier::FORALL);
+        if (formula.levelUniversal.empty() || formula.levelUniversal.back() != isUniversal) {
+            formula.levelUniversal.push_back(isUniversal);
+        }
+        formula.level[it->second] = formula.levelUniversal.size() - 1;
+    };
+
+    std::set<int> bound;
+    for (const auto& block : preprocessor.getQuantifierBlocks()) {
+        bound.insert(block.variables.begin(), block.variables.end());
+    }
+    for (const auto& [var, i] : index) {
+        if (!bound.count(var)) place(var, Quantifier::EXISTS);
+    }
+    for (const auto& block : preprocessor.getQuantifierBlocks()) {
+        for (int var : block.variables) place(var, block.type);
+    }
+
+    return CanonicalLabeling(formula).run();
+}
+
+std::string computeFingerprint(const std::string& canonical) {
+    std::vector<uint64_t> bytes = {FINGERPRINT_VERSION};
+    for (unsigned char c : canonical) bytes.push_back(c);
+    char hex[17];
+    std::snprintf(hex, sizeof(hex), "%016llx",
+                  (unsigned long long)hashSequence(0xf1a9e4, bytes));
+    return hex;
+}
+
+// ============================================================================
+// Result Cache
+// ============================================================================
+
+ResultCache::ResultCache(const std::string& dir) : directory(dir) {}
+
+std::string ResultCache::entryPath(const std::string& fingerprint) const {
+    return directory + "/" + fingerprint + ".result";
+}
+
+/*
+ * The entry holds the result line and then the canonical form it was
+ * computed for. Different formulas can share a fingerprint (a hash
+ * collision, or a labeling cut short by its budget), so a hit only counts
+ * if the stored form is exactly this one.
+ */
+bool ResultCache::lookup(const std::string& fingerprint, const std::string& canonical, Result& result) const {
+    std::ifstream in(entryPath(fingerprint));
+    std::string line;
+    if (!in || !std::getline(in, line)) return false;
+
+    std::string stored((std::istreambuf_iterator<char>(in)), std::istreambuf_iterator<char>());
+    if (stored != canonical) return false;  // Another formula with this fingerprint
+
+    if (line == "SATISFIABLE") {
+        result = Result::SAT;
+        return true;
+    }
+    if (line == "UNSATISFIABLE") {
+        result = Result::UNSAT;
+        return true;
+    }
+    return false;  // Corrupt or foreign entry: treat as a miss
+}
+
+bool ResultCache::store(const std::string& fingerprint, const std::string& canonical, Result result) const {
+    std::error_code ec;
+    std::filesystem::create_directories(directory, ec);
+    if (ec) return false;
+
+    // Write to a private temporary file, then atomically rename it
+    std::string path = entryPath(fingerprint);
+    std::string temp = path + ".tmp." + std::to_string(getpid());
+    {
+        std::ofstream out(temp);
+        if (!out) return false;
+        out << (result == Result::SAT ? "SATISFIABLE" : "UNSATISFIABLE") << "\n" << canonical;
+        if (!out) return false;
+    }
+    std::filesystem::rename(temp, path, ec);
+    if (ec) {
+        std::filesystem::remove(temp, ec);
+        return false;
+    }
+    return true;
+}
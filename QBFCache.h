@@ -0,0 +1,73 @@
+/*
+ * QBFCache.h - Formula Fingerprints and an On-Disk Result Cache
+ *
+ * The same formula is often solved again, sometimes with its variables
+ * renamed or its clauses shuffled. We compute a FINGERPRINT that does not
+ * change under such edits and use it as the key of a result cache stored
+ * as one small file per formula in a directory.
+ *
+ * CANONICAL FORM (individualization-refinement):
+ *   The formula is a graph: one vertex per literal, one per clause, an
+ *   edge from each clause to its literals and from x to ¬x. Vertices are
+ *   kept in an ordered partition of cells.
+ *   1. Start with one cell for the clauses and one per quantifier level
+ *      and sign (∀x1 ∃x2,x3: x1 in "level 0, FORALL", x2 and x3 together).
+ *   2. Take a SPLITTER cell from a queue and count, for every vertex next
+ *      to it, how many of its neighbours lie in the splitter. Cells whose
+ *      members got different counts split, ordered by count.
+ *   3. Queue the new cells and go back to 2 until the queue is empty. Only
+ *      neighbours of the splitter are touched, and as in Hopcroft's DFA
+ *      minimization the largest piece of a split cell need not be queued.
+ *   4. If some cell still holds several literals, try each one of the
+ *      smallest such cell in turn: move it to a cell of its own, queue
+ *      that cell and go back to 2.
+ *   Once every cell holds one vertex, number the variables in cell order
+ *   and print the renamed formula; the smallest print over all branches
+ *   is the canonical form, and its hash the fingerprint.
+ *
+ * Refinement alone (steps 1-3) is not enough: a 6-cycle and two triangles
+ * of x ≠ y constraints look the same to it, but only one is satisfiable.
+ * Step 4 tells them apart. It branches a lot on very symmetric formulas,
+ * so the search has a node budget; past it, the remaining ties are broken
+ * by cell position. Refinement has a work budget too; past it, we give up
+ * on canonical numbering and print the formula as numbered in the input.
+ * In both cases a renamed copy may miss the cache. The entry stores the
+ * canonical form and a hit must match it exactly, so a cut-off search or
+ * a hash collision never returns another formula's result.
+ */
+
+#ifndef QBF_CACHE_H
+#define QBF_CACHE_H
+
+#include "QBFPreprocessor.h"
+#include "QBFSolver.h"
+#include <string>
+
+// The normalized formula with its variables renumbered canonically
+std::string canonicalForm(const QBFPreprocessor& preprocessor);
+
+// Hash of a canonical form as a 16-digit hex string
+std::string computeFingerprint(const std::string& canonical);
+
+/*
+ * Directory-based key-value store: <directory>/<fingerprint>.result holds
+ * "SATISFIABLE" or "UNSATISFIABLE" and the canonical form. Entries are written to a temporary
+ * file and renamed, so concurrent solver runs never see partial entries.
+ */
+class ResultCache {
+private:
+    std::string directory;
+
+    std::string entryPath(const std::string& fingerprint) const;
+
+public:
+    explicit ResultCache(const std::string& directory);
+
+    // Returns true and sets result if exactly this canonical form is cached
+    bool lookup(const std::string& fingerprint, const std::string& canonical, Result& result) const;
+
+    // Store a result; returns false if the directory is not writable
+    bool store(const std::string& fingerprint, const std::string& canonical, Result result) const;
+};
+
+#endif // QBF_CACHE_H
@@ -0,0 +1,292 @@
+/*
+ * QBFDelta.cpp - ddmin over clauses, variables, literals and the prefix
+ */
+
+#include "QBFDelta.h"
+#include "QBFTrace.h"
+#include <algorithm>
+#include <thread>
+#include <unordered_map>
+#include <unordered_set>
+#include <utility>
+#include <vector>
+
+namespace {
+
+// Builds candidate number k of a reduction step from the current formula
+using CandidateMaker = std::function<QBFFormula(size_t)>;
+
+// Remove every occurrence of a variable; clauses left empty are dropped
+QBFFormula withoutVariable(const QBFFormula& formula, int var) {
+    QBFFormula result;
+    result.blocks = formula.blocks;
+    for (auto& block : result.blocks) {
+        auto& vars = block.variables;
+        vars.erase(std::remove(vars.begin(), vars.end(), var), vars.end());
+    }
+    for (const auto& clause : formula.clauses) {
+        Clause kept;
+        for (const auto& lit : clause) {
+            if (lit.variable != var) kept.push_back(lit);
+        }
+        if (!kept.empty() || clause.empty()) result.clauses.push_back(kept);
+    }
+    return result;
+}
+
+// Prefix variables in order, then free variables in order of appearance
+std::vector<int> variablesInOrder(const QBFFormula& formula) {
+    std::vector<int> order;
+    std::unordered_set<int> seen;
+    for (const auto& block : formula.blocks) {
+        for (int var : block.variables) {
+            if (seen.insert(var).second) order.push_back(var);
+        }
+    }
+    for (const auto& clause : formula.clauses) {
+        for (const auto& lit : clause) {
+            if (seen.insert(lit.variable).second) order.push_back(lit.variable);
+        }
+    }
+    return order;
+}
+
+class Reducer {
+public:
+    Reducer(const QBFFormula& formula, const FailureTest& stillFails, const DeltaOptions& options)
+        : formula(formula), stillFails(stillFails), options(options) {}
+
+    QBFFormula run() {
+        bool changed = true;
+        while (changed) {
+            changed = false;
+            changed |= reduceClauses();
+            changed |= reduceVariables();
+            changed |= reduceLiterals();
+            changed |= mergeBlocks();
+            changed |= reducePrefix();
+        }
+        renumber();
+        return formula;
+    }
+
+private:
+    QBFFormula formula;             // Smallest failing formula so far
+    const FailureTest& stillFails;
+    const DeltaOptions& options;
+
+    void accept(QBFFormula&& candidate) {
+        formula = std::move(candidate);
+        if (options.onReduced) options.onReduced(formula);
+    }
+
+    /*
+     * Test candidates 0..count-1 in order and accept the first one that
+     * still fails; its index is stored in `index`. Waves of
+     * options.threads candidates run concurrently, so some candidates
+     * after the winner may be tested for nothing - the price of keeping
+     * the result independent of the thread count.
+     */
+    bool acceptFirstFailing(size_t count, const CandidateMaker& make, size_t& index) {
+        size_t waveSize = std::max(1, options.threads);
+        for (size_t start = 0; start < count; start += waveSize) {
+            size_t size = std::min(count - start, waveSize);
+            std::vector<QBFFormula> candidates(size);
+            std::vector<char> fails(size, 0);
+            auto test = [&](size_t i) {
+                TraceScope traced("candidate", "delta", "index", start + i);
+                candidates[i] = make(start + i);
+                fails[i] = stillFails(candidates[i]);
+            };
+
+            if (size == 1) {
+                test(0);
+            } else {
+                std::vector<std::thread> workers;
+                for (size_t i = 0; i < size; i++) {
+                    workers.emplace_back([&test, i]() {
+                        traceThreadName("worker " + std::to_string(i + 1));
+                        test(i);
+                    });
+                }
+                for (auto& worker : workers) worker.join();
+            }
+
+            for (size_t i = 0; i < size; i++) {
+                if (fails[i]) {
+                    index = start + i;
+                    accept(std::move(candidates[i]));
+                    return true;
+                }
+            }
+        }
+        return false;
+    }
+
+    // Clause-level ddmin; returns true if anything was removed
+    bool reduceClauses() {
+        bool changed = false;
+        size_t chunks = 2;
+
+        while (formula.clauses.size() >= 2) {
+            size_t size = formula.clauses.size();
+            chunks = std::min(chunks, size);
+            size_t chunkSize = (size + chunks - 1) / chunks;
+            size_t numChunks = (size + chunkSize - 1) / chunkSize;
+
+            size_t index;
+            bool removed = acceptFirstFailing(numChunks, [&](size_t k) {
+                QBFFormula candidate = formula;
+                auto first = candidate.clauses.begin() + k * chunkSize;
+                auto last = candidate.clauses.begin() + std::min((k + 1) * chunkSize, size);
+                candidate.clauses.erase(first, last);
+                return candidate;
+            }, index);
+
+            if (removed) {
+                changed = true;
+                chunks = std::max<size_t>(chunks - 1, 2);  // Complement found: keep granularity
+            } else if (chunks < size) {
+                chunks = std::min(size, chunks * 2);       // Nothing removable: go finer
+            } else {
+                break;                                     // Single clauses all needed
+            }
+        }
+
+        // A lone clause may still be removable
+        if (formula.clauses.size() == 1) {
+            size_t index;
+            changed |= acceptFirstFailing(1, [&](size_t) {
+                QBFFormula candidate = formula;
+                candidate.clauses.clear();
+                return candidate;
+            }, index);
+        }
+        return changed;
+    }
+
+    // Try removing each variable with all its occurrences
+    bool reduceVariables() {
+        bool changed = false;
+        size_t cursor = 0;
+        while (true) {
+            std::vector<int> vars = variablesInOrder(formula);
+            if (cursor >= vars.size()) break;
+
+            size_t index;
+            if (!acceptFirstFailing(vars.size() - cursor, [&](size_t k) {
+                    return withoutVariable(formula, vars[cursor + k]);
+                }, index)) {
+                break;
+            }
+            changed = true;
+            cursor += index;  // Earlier variables were needed; later ones shifted down
+        }
+        return changed;
+    }
+
+    // Try removing each literal (clauses are kept non-empty)
+    bool reduceLiterals() {
+        bool changed = false;
+        std::pair<size_t, size_t> cursor{0, 0};
+        while (true) {
+            // Removable positions (clause, literal) from the cursor on
+            std::vector<std::pair<size_t, size_t>> positions;
+            for (size_t c = cursor.first; c < formula.clauses.size(); c++) {
+                if (formula.clauses[c].size() < 2) continue;
+                size_t first = (c == cursor.first) ? cursor.second : 0;
+                for (size_t i = first; i < formula.clauses[c].size(); i++) positions.push_back({c, i});
+            }
+
+            size_t index;
+            if (!acceptFirstFailing(positions.size(), [&](size_t k) {
+                    QBFFormula candidate = formula;
+                    auto& clause = candidate.clauses[positions[k].first];
+                    clause.erase(clause.begin() + positions[k].second);
+                    return candidate;
+                }, index)) {
+                break;
+            }
+            changed = true;
+            cursor = positions[index];  // The next literal moved into this slot
+        }
+        return changed;
+    }
+
+    // Try merging each pair of adjacent blocks into the outer one
+    bool mergeBlocks() {
+        bool changed = false;
+        size_t cursor = 0;
+        while (cursor + 1 < formula.blocks.size()) {
+            size_t index;
+            if (!acceptFirstFailing(formula.blocks.size() - 1 - cursor, [&](size_t k) {
+                    QBFFormula candidate = formula;
+                    size_t b = cursor + k;
+                    auto& vars = candidate.blocks[b].variables;
+                    const auto& inner = candidate.blocks[b + 1].variables;
+                    vars.insert(vars.end(), inner.begin(), inner.end());
+                    candidate.blocks.erase(candidate.blocks.begin() + b + 1);
+                    return candidate;
+                }, index)) {
+                break;
+            }
+            changed = true;
+            cursor += index;  // The merged block may merge again with its new neighbor
+        }
+        return changed;
+    }
+
+    // Drop prefix variables that occur in no clause, then empty blocks
+    bool reducePrefix() {
+        std::unordered_set<int> occurring;
+        for (const auto& clause : formula.clauses) {
+            for (const auto& lit : clause) occurring.insert(lit.variable);
+        }
+
+        QBFFormula candidate = formula;
+        for (auto& block : candidate.blocks) {
+            auto& vars = block.variables;
+            vars.erase(std::remove_if(vars.begin(), vars.end(),
+                                      [&](int var) { return !occurring.count(var); }),
+                       vars.end());
+        }
+        candidate.blocks.erase(std::remove_if(candidate.blocks.begin(), candidate.blocks.end(),
+                                              [](const QuantifierBlock& b) { return b.variables.empty(); }),
+                               candidate.blocks.end());
+
+        size_t before = 0, after = 0;
+        for (const auto& block : formula.blocks) before += block.variables.size() + 1;
+        for (const auto& block : candidate.blocks) after += block.variables.size() + 1;
+        if (after == before || !stillFails(candidate)) return false;
+        accept(std::move(candidate));
+        return true;
+    }
+
+    // Renumber the variables 1..n in prefix order (free variables last)
+    void renumber() {
+        std::unordered_map<int, int> newNumber;
+        bool identity = true;
+        for (int var : variablesInOrder(formula)) {
+            int number = newNumber.size() + 1;
+            newNumber[var] = number;
+            identity &= (var == number);
+        }
+        if (identity) return;
+
+        QBFFormula candidate = formula;
+        for (auto& block : candidate.blocks) {
+            for (int& var : block.variables) var = newNumber[var];
+        }
+        for (auto& clause : candidate.clauses) {
+            for (auto& lit : clause) lit.variable = newNumber[lit.variable];
+        }
+        if (stillFails(candidate)) accept(std::move(candidate));
+    }
+};
+
+}  // namespace
+
+QBFFormula minimizeFormula(const QBFFormula& formula, const FailureTest& stillFails,
+                           const DeltaOptions& options) {
+    return Reducer(formula, stillFails, options).run();
+}
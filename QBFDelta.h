@@ -0,0 +1,52 @@
+/*
+ * QBFDelta.h - Delta Debugging for QBF Formulas
+ *
+ * A fuzzer finds a formula on which some solver configuration is wrong,
+ * or a user finds one on which the solver is pathologically slow, but
+ * most of the formula is irrelevant to the problem. Delta debugging
+ * (ddmin) shrinks it while a test still "fails":
+ *
+ *   1. Split the clauses into n chunks and try removing each chunk.
+ *      If the test still fails, keep the smaller formula; otherwise
+ *      double n. Stop when single clauses cannot be removed.
+ *   2. Try removing whole variables (every occurrence, and the variable
+ *      from the prefix). Clauses left empty are dropped.
+ *   3. Try removing single literals from the remaining clauses.
+ *   4. Try merging adjacent quantifier blocks (the inner block takes the
+ *      quantifier of the outer one), which removes alternations.
+ *   5. Drop prefix variables that no longer occur, then empty blocks.
+ *
+ * Steps repeat until nothing changes. The result is 1-minimal: removing
+ * any single clause, literal or variable, or merging any two adjacent
+ * blocks, makes the failure disappear. A last step renumbers the
+ * variables 1..n if the test still fails afterwards.
+ *
+ * PARALLEL EVALUATION:
+ * ====================
+ * Each step produces a list of candidates and keeps the first one that
+ * still fails. With threads > 1 the candidates are tested in waves of
+ * that many, each on its own thread, and the lowest failing index of a
+ * wave wins. The result is therefore the same as with one thread, as long
+ * as the test itself is deterministic (a decision count is, a wall-clock
+ * time is not quite). The test must be safe to call concurrently.
+ */
+
+#ifndef QBF_DELTA_H
+#define QBF_DELTA_H
+
+#include "QDIMACS.h"
+#include <functional>
+
+// Returns true if the formula still shows the behavior being minimized
+using FailureTest = std::function<bool(const QBFFormula&)>;
+
+struct DeltaOptions {
+    int threads = 1;                                   // Candidates tested at once
+    std::function<void(const QBFFormula&)> onReduced;  // Called after each accepted candidate
+};
+
+// Shrink a failing formula; stillFails(formula) must be true on entry
+QBFFormula minimizeFormula(const QBFFormula& formula, const FailureTest& stillFails,
+                           const DeltaOptions& options = DeltaOptions());
+
+#endif // QBF_DELTA_H
@@ -0,0 +1,149 @@
+/*
+ * QBFEnumerate.cpp - Winning outer cubes by blocking clauses on one QCDCL solver
+ */
+
+#include "QBFEnumerate.h"
+#include "QCDCLSolver.h"
+#include <algorithm>
+#include <chrono>
+#include <iostream>
+#include <unordered_set>
+
+void QBFEnumerate::setSymmetries(const SymmetryInfo& value) {
+    symmetries = value;
+}
+
+void QBFEnumerate::setDualPropagation(bool enabled) {
+    dual = enabled;
+}
+
+void QBFEnumerate::setVerbose(bool enabled) {
+    verbose = enabled;
+}
+
+void QBFEnumerate::setCubeCallback(const CubeCallback& callback) {
+    onCube = callback;
+}
+
+void QBFEnumerate::setLimit(long long value) {
+    limit = std::max(0LL, value);
+}
+
+void QBFEnumerate::setTimeLimit(double seconds) {
+    timeLimit = seconds;
+}
+
+Result QBFEnumerate::enumerate(const QBFPreprocessor& preprocessor) {
+    auto start = std::chrono::steady_clock::now();
+    cubes.clear();
+    complete = false;
+    calls = shrunk = 0;
+
+    QCDCLSolver solver;
+    solver.setVerbose(verbose);
+    solver.setSymmetries(symmetries);
+    solver.setDualPropagation(dual);
+    solver.setTimeLimit(timeLimit);
+    Result result = solver.solve(preprocessor);
+    calls++;
+    stats = solver.getStats();
+    if (result != Result::SAT) {
+        complete = (result == Result::UNSAT);
+        return result;
+    }
+
+    // Outer variables fixed by preprocessing are in every cube
+    std::vector<int> outerVars = outerBlockVariables(preprocessor);
+    std::unordered_set<int> outerSet(outerVars.begin(), outerVars.end());
+    outerSize = outerSet.size();
+    std::vector<Literal> fixed;
+    const auto& assignments = preprocessor.getAssignments();
+    for (int var : outerSet) {
+        auto it = assignments.find(var);
+        if (it != assignments.end()) fixed.emplace_back(var, !it->second);
+    }
+
+    // One more solver call within the time limit; false = out of time
+    auto ask = [&](const std::vector<Literal>& assumed, Result& answer) {
+        if (timeLimit > 0) {
+            double left = timeLimit - std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+            if (left <= 0) return false;
+            solver.setTimeLimit(left);
+        }
+        answer = solver.solveAssuming(assumed);
+        calls++;
+        return answer != Result::UNKNOWN;
+    };
+
+    // Outer literals of the last winning cube
+    auto winningOuter = [&]() {
+        std::vector<Literal> lits;
+        for (const auto& lit : solver.getWinningLiterals()) {
+            if (outerSet.count(lit.variable)) lits.push_back(lit);
+        }
+        return lits;
+    };
+
+    bool outOfTime = false;
+    for (;;) {
+        std::vector<Literal> cube = winningOuter();
+
+        // Shrink: drop l if the cube with l flipped wins as well
+        for (size_t i = 0; i < cube.size() && !outOfTime;) {
+            std::vector<Literal> flipped = cube;
+            flipped[i] = flipped[i].complement();
+            Result answer;
+            if (!ask(flipped, answer)) {
+                outOfTime = true;
+                break;
+            }
+            bool inside = (answer == Result::SAT);
+            if (inside) {
+                for (const auto& lit : winningOuter()) {
+                    inside = inside && std::any_of(flipped.begin(), flipped.end(), [&](const Literal& other) {
+                        return other.variable == lit.variable && other.isNegated == lit.isNegated;
+                    });
+                }
+            }
+            if (inside) {
+                if (verbose) {
+                    std::cout << "[ENUM] Both values of x" << cube[i].variable << " win: dropped" << std::endl;
+                }
+                cube.erase(cube.begin() + i);
+                shrunk++;
+            } else {
+                i++;
+            }
+        }
+
+        // A cube found before running out of time is still winning
+        std::vector<Literal> reported = cube;
+        reported.insert(reported.end(), fixed.begin(), fixed.end());
+        std::sort(reported.begin(), reported.end(),
+                  [](const Literal& a, const Literal& b) { return a.variable < b.variable; });
+        cubes.push_back(reported);
+        if (onCube) onCube(reported);
+
+        // An empty cube: every outer assignment wins
+        if (cube.empty()) {
+            complete = true;
+            break;
+        }
+        if (outOfTime || (limit > 0 && static_cast<long long>(cubes.size()) >= limit)) break;
+
+        std::vector<Literal> blocking;
+        for (const auto& lit : cube) blocking.push_back(lit.complement());
+        solver.addOuterClause(blocking);
+        Result answer;
+        if (!ask({}, answer)) break;
+        if (answer == Result::UNSAT) {
+            complete = true;
+            break;
+        }
+    }
+
+    SolverStats last = solver.getStats();  // Counters add up over the calls
+    last.engine = stats.engine;
+    stats = last;
+    return result;
+}
@@ -0,0 +1,96 @@
+/*
+ * QBFEnumerate.h - All Winning Assignments of the Outer Block
+ *
+ * A SAT answer comes with one winning outer assignment (see QBFOuter.h).
+ * A planner often wants the ALTERNATIVES: every outer assignment with
+ * which EXISTS wins. Listing them one full assignment at a time is
+ * hopeless (a single don't-care variable doubles the list), so they are
+ * listed as WINNING CUBES: partial assignments whose every completion
+ * wins.
+ *
+ *   ∃x1 x2 x3 ∀u ∃y:  cubes {x1=true}, {x1=false x2=true x3=false}
+ *   → 4 + 1 = 5 of the 8 outer assignments win
+ *
+ * ALGORITHM: one QCDCL solver, asked again and again.
+ *
+ *   1. Solve. The outer literals of the winning cube are a first cube W.
+ *   2. SHRINK W: for each literal l of W, solve assuming W with l
+ *      flipped. If that wins too, with a winning cube W' inside those
+ *      literals, then both values of l win and l is dropped from W.
+ *      (Every completion of W without l either contains l and completes
+ *      W, or contains ¬l and completes W'.)
+ *   3. Report W, then BLOCK it: add the clause ¬W, so EXISTS must play
+ *      something else, and solve again. UNSAT: every winning assignment
+ *      has been listed.
+ *
+ * Learned clauses stay valid when a blocking clause is added, and so do
+ * learned cubes that satisfy it (QCDCLSolver::addOuterClause); the rest
+ * of the database carries over from one round to the next. Each reported
+ * cube contradicts all earlier ones, so no assignment is listed twice.
+ *
+ * Preprocessing must leave the outer block frozen (freezeOuterBlock), so
+ * pure literal elimination does not hide winning values. Outer variables
+ * fixed by unit propagation are part of every cube.
+ */
+
+#ifndef QBF_ENUMERATE_H
+#define QBF_ENUMERATE_H
+
+#include "QBFOuter.h"
+#include "QBFPreprocessor.h"
+#include "QBFSolver.h"
+#include "QBFSymmetry.h"
+#include <functional>
+#include <vector>
+
+// Called with each winning cube as it is found (literals sorted by variable)
+using CubeCallback = std::function<void(const std::vector<Literal>&)>;
+
+class QBFEnumerate {
+public:
+    // Symmetry breaking must not touch the outer block (its clauses would
+    // remove winning assignments); universal symmetries are fine
+    void setSymmetries(const SymmetryInfo& symmetries);
+    void setDualPropagation(bool enabled);
+    void setVerbose(bool enabled);
+    void setCubeCallback(const CubeCallback& callback);
+
+    // Stop after this many cubes (0 = list all)
+    void setLimit(long long cubes);
+
+    // For all calls together
+    void setTimeLimit(double seconds);
+
+    // Solve the formula and list its winning outer cubes if it is true
+    Result enumerate(const QBFPreprocessor& preprocessor);
+
+    const std::vector<std::vector<Literal>>& getCubes() const { return cubes; }
+
+    // Every winning outer assignment is covered by a listed cube
+    bool isComplete() const { return complete; }
+
+    // Outer variables (fixed ones included), to count covered assignments
+    int getOuterSize() const { return outerSize; }
+
+    // Statistics of the first solve, plus the later calls
+    const SolverStats& getStats() const { return stats; }
+    long long getCalls() const { return calls; }
+    long long getShrunk() const { return shrunk; }
+
+private:
+    SymmetryInfo symmetries;
+    bool dual = false;
+    bool verbose = false;
+    CubeCallback onCube;
+    long long limit = 0;
+    double timeLimit = 0;
+
+    std::vector<std::vector<Literal>> cubes;
+    bool complete = false;
+    int outerSize = 0;
+    SolverStats stats;
+    long long calls = 0;   // Solver calls, the first one included
+    long long shrunk = 0;  // Literals dropped from winning cubes
+};
+
+#endif // QBF_ENUMERATE_H
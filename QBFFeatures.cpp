@@ -0,0 +1,397 @@
+/*
+ * QBFFeatures.cpp - Feature extraction and engine selection
+ *
+ * The features are computed in a single pass over the clauses plus a pass
+ * over the prefix, so this costs far less than the preprocessing before it.
+ * The tree width is the exception: min-fill gives up as soon as the width
+ * passes the engine's cap, which bounds its work on wide formulas.
+ */
+
+#include "QBFFeatures.h"
+#include <algorithm>
+#include <climits>
+#include <set>
+#include <sstream>
+#include <tuple>
+#include <unordered_map>
+#include <unordered_set>
+
+// Formulas with at most this many variables go to the recursive search:
+// its full 2^n tree is cheaper than QCDCL's bookkeeping.
+static const int TINY_FORMULA_VARS = 16;
+
+// Circuits in CNF are mostly binary clauses (a 2-input gate is two binary
+// clauses and one ternary): enough of them and QCDCL looks for gates.
+static const double DUAL_MIN_BINARY_RATIO = 0.5;
+
+// A FORALL block this large makes the prefix order expensive: every
+// existential after it waits for all of its variables. QCDCL then learns
+// the dependencies that matter instead.
+static const int DEP_MIN_FORALL_BLOCK = 24;
+
+// Narrow formulas go to the BDD engine: with at most this many clauses
+// across every cut of the variable order, the diagrams of the eliminated
+// part stay small (a BDD over a cut of width w has at most 2^w nodes per
+// level in the worst case, far fewer in practice).
+static const int BDD_MAX_CUT_WIDTH = 12;
+
+// Formulas that decompose into small pieces go to the tree-decomposition
+// engine: its tables have at most 2^(width+1) entries, so up to this
+// width every table fits in 4 KB. Wider formulas are not measured further.
+static const int TREEDP_MAX_WIDTH = 14;
+
+// Preprocessing rescans the clause list every round, and subsumption
+// compares clauses that share a literal: past this many clauses both cost
+// real time, so rounds that gain little stop and subsumption gets a
+// smaller share of the budget.
+static const int LARGE_FORMULA_CLAUSES = 100000;
+static const double LARGE_FORMULA_MIN_GAIN = 0.01;
+static const long long LARGE_FORMULA_SUBSUMPTION_TICKS = 20000000;
+
+std::vector<int> prefixVariableOrder(const QBFPreprocessor& preprocessor) {
+    const auto& clauses = preprocessor.getClauses();
+    std::unordered_map<int, int> firstSeen;
+    for (const auto& clause : clauses) {
+        for (const auto& lit : clause) firstSeen.emplace(lit.variable, (int)firstSeen.size());
+    }
+    auto byAppearance = [&](int a, int b) { return firstSeen[a] < firstSeen[b]; };
+
+    std::vector<int> order;
+    std::unordered_set<int> bound;
+    std::vector<std::vector<int>> blocks;
+    for (const auto& block : preprocessor.getQuantifierBlocks()) {
+        blocks.emplace_back();
+        for (int var : block.variables) {
+            bound.insert(var);
+            if (firstSeen.count(var)) blocks.back().push_back(var);
+        }
+    }
+    for (const auto& [var, position] : firstSeen) {
+        if (!bound.count(var)) order.push_back(var);
+    }
+    std::sort(order.begin(), order.end(), byAppearance);
+    for (auto& block : blocks) {
+        std::sort(block.begin(), block.end(), byAppearance);
+        order.insert(order.end(), block.begin(), block.end());
+    }
+    return order;
+}
+
+/*
+ * Min-fill on the primal graph (variables adjacent when they share a
+ * clause). Eliminating v connects its neighbours pairwise, which changes
+ * the fill of v's neighbours and of their neighbours only; those are
+ * re-scored, the rest keep their place in the group's ordered set.
+ */
+std::vector<int> prefixEliminationOrder(const QBFPreprocessor& preprocessor, int maxWidth, int& width) {
+    std::vector<int> order = prefixVariableOrder(preprocessor);
+    int n = order.size();
+    width = 0;
+
+    // A clause is a clique of the primal graph
+    std::unordered_map<int, int> position;
+    for (int i = 0; i < n; i++) position[order[i]] = i;
+    std::vector<std::unordered_set<int>> adjacent(n);
+    for (const auto& clause : preprocessor.getClauses()) {
+        if ((int)clause.size() > maxWidth + 1) {
+            width = maxWidth + 1;
+            return {};
+        }
+        for (size_t i = 0; i < clause.size(); i++) {
+            for (size_t j = i + 1; j < clause.size(); j++) {
+                int a = position[clause[i].variable], b = position[clause[j].variable];
+                if (a == b) continue;
+                adjacent[a].insert(b);
+                adjacent[b].insert(a);
+            }
+        }
+    }
+
+    // Groups: runs of the same quantifier (free variables are EXISTS)
+    std::unordered_map<int, Quantifier> quantifierOf;
+    for (const auto& block : preprocessor.getQuantifierBlocks()) {
+        for (int var : block.variables) quantifierOf[var] = block.type;
+    }
+    std::vector<int> group(n, 0);
+    for (int i = 1; i < n; i++) {
+        auto universal = [&](int at) {
+            auto it = quantifierOf.find(order[at]);
+            return it != quantifierOf.end() && it->second == Quantifier::FORALL;
+        };
+        group[i] = group[i - 1] + (universal(i) != universal(i - 1) ? 1 : 0);
+    }
+
+    // (fill, degree, position); a variable with too many neighbours is
+    // never worth scoring: eliminating it would exceed the width anyway
+    using Key = std::tuple<long long, int, int>;
+    auto score = [&](int v) {
+        int degree = adjacent[v].size();
+        if (degree > maxWidth) return Key(LLONG_MAX, degree, v);
+        std::vector<int> neighbours(adjacent[v].begin(), adjacent[v].end());
+        long long fill = 0;
+        for (size_t i = 0; i < neighbours.size(); i++) {
+            for (size_t j = i + 1; j < neighbours.size(); j++) {
+                if (!adjacent[neighbours[i]].count(neighbours[j])) fill++;
+            }
+        }
+        return Key(fill, degree, v);
+    };
+
+    std::vector<int> elimination;
+    std::vector<Key> keyOf(n);
+    std::vector<bool> eliminated(n, false);
+    for (int end = n; end > 0;) {
+        int begin = end;
+        while (begin > 0 && group[begin - 1] == group[end - 1]) begin--;
+        std::set<Key> candidates;
+        for (int v = begin; v < end; v++) candidates.insert(keyOf[v] = score(v));
+
+        while (!candidates.empty()) {
+            int v = std::get<2>(*candidates.begin());
+            candidates.erase(candidates.begin());
+            int degree = adjacent[v].size();
+            if (degree > maxWidth) {
+                width = maxWidth + 1;
+                return {};
+            }
+            width = std::max(width, degree);
+            elimination.push_back(order[v]);
+            eliminated[v] = true;
+
+            std::vector<int> neighbours(adjacent[v].begin(), adjacent[v].end());
+            for (int a : neighbours) {
+                adjacent[a].erase(v);
+                for (int b : neighbours) {
+                    if (a != b) adjacent[a].insert(b);
+                }
+            }
+            adjacent[v].clear();
+
+            std::unordered_set<int> touched(neighbours.begin(), neighbours.end());
+            for (int a : neighbours) touched.insert(adjacent[a].begin(), adjacent[a].end());
+            for (int u : touched) {
+                if (u < begin || u >= end || eliminated[u]) continue;
+                candidates.erase(keyOf[u]);
+                candidates.insert(keyOf[u] = score(u));
+            }
+        }
+        end = begin;
+    }
+    return elimination;
+}
+
+// Most clauses spanning a cut between two neighbours of the order
+static int computeCutWidth(const QBFPreprocessor& preprocessor) {
+    std::vector<int> order = prefixVariableOrder(preprocessor);
+    std::unordered_map<int, int> position;
+    for (size_t i = 0; i < order.size(); i++) position[order[i]] = i;
+
+    // +1 where a clause starts spanning cuts, -1 where it stops
+    std::vector<int> delta(order.size() + 1, 0);
+    for (const auto& clause : preprocessor.getClauses()) {
+        if (clause.empty()) continue;
+        int first = INT_MAX, last = -1;
+        for (const auto& lit : clause) {
+            first = std::min(first, position[lit.variable]);
+            last = std::max(last, position[lit.variable]);
+        }
+        delta[first]++;
+        delta[last]--;
+    }
+    int width = 0, current = 0;
+    for (int d : delta) {
+        current += d;
+        width = std::max(width, current);
+    }
+    return width;
+}
+
+FormulaFeatures computeSizeFeatures(const QBFPreprocessor& preprocessor) {
+    FormulaFeatures f;
+    const auto& clauses = preprocessor.getClauses();
+
+    f.clauseLengths.assign(5, 0);
+    std::unordered_set<int> occurring;
+    long long totalLength = 0;
+    for (const auto& clause : clauses) {
+        for (const auto& lit : clause) occurring.insert(lit.variable);
+        size_t bucket = std::min<size_t>(clause.size(), 5);
+        if (bucket > 0) f.clauseLengths[bucket - 1]++;
+        totalLength += clause.size();
+    }
+
+    f.numClauses = clauses.size();
+    f.numVars = occurring.size();
+    if (f.numClauses > 0) {
+        f.binaryRatio = (double)f.clauseLengths[1] / f.numClauses;
+        f.avgClauseLength = (double)totalLength / f.numClauses;
+    }
+
+    // Walk the prefix, skipping variables that no longer occur
+    bool first = true;
+    Quantifier previous = Quantifier::EXISTS;
+    for (const auto& block : preprocessor.getQuantifierBlocks()) {
+        int size = 0;
+        for (int var : block.variables) {
+            if (occurring.count(var)) size++;
+        }
+        if (size == 0) continue;
+
+        f.numBlocks++;
+        f.maxBlockSize = std::max(f.maxBlockSize, size);
+        if (block.type == Quantifier::FORALL) {
+            f.numUniversal += size;
+            f.maxUniversalBlockSize = std::max(f.maxUniversalBlockSize, size);
+        } else {
+            f.numExistential += size;
+        }
+
+        if (first) {
+            f.outerExistential = (block.type == Quantifier::EXISTS);
+            first = false;
+        } else if (block.type != previous) {
+            f.alternations++;
+        }
+        previous = block.type;
+    }
+    return f;
+}
+
+FormulaFeatures computeFeatures(const QBFPreprocessor& preprocessor) {
+    FormulaFeatures f = computeSizeFeatures(preprocessor);
+    f.cutWidth = computeCutWidth(preprocessor);
+    prefixEliminationOrder(preprocessor, TREEDP_MAX_WIDTH, f.treeWidth);
+    if (f.treeWidth > TREEDP_MAX_WIDTH) f.treeWidth = -1;
+    return f;
+}
+
+/*
+ * Choose the engine for a formula.
+ *
+ *   no clauses left          → search (nothing to do)
+ *   at most 16 variables     → search (the whole tree is tiny)
+ *   cut width at most 12     → BDD (narrow: quantifier elimination
+ *                              keeps the diagrams small), falling back
+ *                              to QCDCL past the node limit
+ *   tree width at most 14    → tree-decomposition DP (small tables,
+ *                              runtime set by the width), falling back
+ *                              to QCDCL when the width limit is lower
+ *   otherwise                → QCDCL (learning pays off; more so with
+ *                              more alternations, where the search tree
+ *                              has many independent universal subtrees)
+ *
+ * Symmetry breaking is enabled whenever the formula is not tiny: the
+ * detection is a near-linear pass, cheap next to the search it prunes.
+ * Dual propagation is enabled when at least half of the clauses are
+ * binary, the mark of gate definitions; without gates it costs nothing.
+ * Dependency learning is enabled for FORALL blocks of 24 or more
+ * variables, where few of the prefix's dependencies usually matter.
+ */
+EngineConfig selectEngine(const FormulaFeatures& f) {
+    EngineConfig config;
+    config.reuseStrategies = f.numUniversal > 0;
+
+    if (f.numClauses == 0) {
+        config.engine = Engine::SEARCH;
+        config.reason = "solved by preprocessing";
+        return config;
+    }
+
+    if (f.numVars <= TINY_FORMULA_VARS) {
+        config.engine = Engine::SEARCH;
+        config.reason = "tiny formula (" + std::to_string(f.numVars) + " variables)";
+        return config;
+    }
+
+    config.engine = Engine::QCDCL;
+    config.fallback = Engine::QCDCL;
+    config.breakSymmetries = true;
+    config.dualPropagation = f.binaryRatio >= DUAL_MIN_BINARY_RATIO;
+    config.dependencyLearning = f.maxUniversalBlockSize >= DEP_MIN_FORALL_BLOCK;
+    if (f.alternations >= 2) {
+        config.reason = std::to_string(f.alternations) + " alternations";
+    } else {
+        config.reason = std::to_string(f.numVars) + " variables";
+    }
+    if (f.cutWidth <= BDD_MAX_CUT_WIDTH) {
+        config.engine = Engine::BDD;
+        config.reason = "narrow formula (cut width " + std::to_string(f.cutWidth) + ")";
+    } else if (f.treeWidth >= 0) {
+        config.engine = Engine::TREEDP;
+        config.reason = "low tree width (" + std::to_string(f.treeWidth) + ")";
+    }
+    return config;
+}
+
+/*
+ * Choose the preprocessing schedule for the parsed formula.
+ *
+ *   at most 16 variables     → one round (the search tree is smaller than
+ *                              what further rounds could save)
+ *   100000 clauses or more   → stop once a round removes less than 1% of
+ *                              the literals, and give subsumption 20M
+ *                              ticks instead of 200M (its clause-pair
+ *                              checks dominate on large inputs)
+ *   otherwise                → the default schedule
+ */
+std::string selectPreprocessing(const FormulaFeatures& f, PreprocessSchedule& schedule) {
+    if (f.numVars <= TINY_FORMULA_VARS) {
+        schedule.maxRounds = 1;
+        return "tiny formula, one round";
+    }
+    if (f.numClauses >= LARGE_FORMULA_CLAUSES) {
+        schedule.minGain = LARGE_FORMULA_MIN_GAIN;
+        for (auto& scheduled : schedule.pipeline) {
+            if (scheduled.technique == PreprocessTechnique::SUBSUMPTION) {
+                scheduled.tickBudget = std::min(scheduled.tickBudget, LARGE_FORMULA_SUBSUMPTION_TICKS);
+            }
+        }
+        return "large formula (" + std::to_string(f.numClauses) + " clauses), cheaper subsumption";
+    }
+    return "default schedule";
+}
+
+std::string engineName(Engine engine) {
+    switch (engine) {
+        case Engine::AUTO:   return "auto";
+        case Engine::SEARCH: return "search";
+        case Engine::QCDCL:  return "qcdcl";
+        case Engine::BDD:    return "bdd";
+        case Engine::TREEDP: return "treedp";
+        case Engine::AIG:    return "aig";
+        case Engine::INCDET: return "incdet";
+        case Engine::EXPAND: return "expand";
+    }
+    return "unknown";
+}
+
+bool parseEngine(const std::string& name, Engine& engine) {
+    for (Engine e : {Engine::AUTO, Engine::SEARCH, Engine::QCDCL, Engine::BDD, Engine::TREEDP, Engine::AIG,
+                     Engine::INCDET, Engine::EXPAND}) {
+        if (engineName(e) == name) {
+            engine = e;
+            return true;
+        }
+    }
+    return false;
+}
+
+std::string featuresToString(const FormulaFeatures& f) {
+    std::ostringstream out;
+    out << "vars=" << f.numVars << " (" << f.numExistential << "e/" << f.numUniversal << "a)"
+        << " clauses=" << f.numClauses
+        << " blocks=" << f.numBlocks
+        << " alternations=" << f.alternations
+        << " max-block=" << f.maxBlockSize
+        << " max-forall-block=" << f.maxUniversalBlockSize
+        << " binary=" << (int)(f.binaryRatio * 100 + 0.5) << "%"
+        << " cut-width=" << f.cutWidth
+        << " tree-width=" << (f.treeWidth >= 0 ? std::to_string(f.treeWidth) : ">" + std::to_string(TREEDP_MAX_WIDTH))
+        << " lengths=[";
+    for (size_t i = 0; i < f.clauseLengths.size(); i++) {
+        if (i > 0) out << ",";
+        out << f.clauseLengths[i];
+    }
+    out << "]";
+    return out.str();
+}
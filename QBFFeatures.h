@@ -0,0 +1,134 @@
+/*
+ * QBFFeatures.h - Formula Features and Automatic Engine Selection
+ *
+ * Different solving engines suit different formula shapes:
+ *
+ *   - The recursive search (QBFSolver) is cheapest on tiny formulas and on
+ *     formulas with only a handful of universal variables, where the 2^k
+ *     universal subtrees are few and strategy reuse makes siblings cheap.
+ *
+ *   - QCDCL (QCDCLSolver) pays for its bookkeeping but learns clauses and
+ *     cubes, which pays off on larger formulas and on many alternations.
+ *
+ *   - The BDD engine (BDDSolver) eliminates the quantifiers symbolically;
+ *     it is fast on NARROW formulas, where few clauses cross any cut of
+ *     the variable order, and hopeless on most others.
+ *
+ *   - The tree-decomposition engine (TreeDPSolver) eliminates them with
+ *     explicit truth tables; its cost grows with the TREE WIDTH of the
+ *     formula, not with its size, so it takes the structured formulas
+ *     that are too wide for BDDs but still decompose into small pieces.
+ *
+ *   - The AIG engine (AIGSolver) reads the clauses back as a circuit and
+ *     eliminates on that; it is only chosen by hand (--engine=aig), as no
+ *     cheap feature tells when the circuit stays small.
+ *
+ *   - The determinization engine (IncDetSolver) builds Skolem functions
+ *     for ∀∃ formulas; it is only chosen by hand (--engine=incdet), as it
+ *     loses to QCDCL on 2QBF without functional structure.
+ *
+ *   - The resolution/expansion engine (ExpansionSolver) eliminates on the
+ *     clauses; it is only chosen by hand (--engine=expand): it beats the
+ *     recursive search on few alternations, but rarely QCDCL.
+ *
+ * After preprocessing we compute a cheap feature vector in one pass over
+ * the remaining clauses and pick the engine from it. The choice and the
+ * reason are recorded in the solver statistics. Before preprocessing,
+ * the size features alone pick the preprocessing schedule (rounds,
+ * stopping gain, technique budgets) the same way.
+ */
+
+#ifndef QBF_FEATURES_H
+#define QBF_FEATURES_H
+
+#include "QBFPreprocessor.h"
+#include <string>
+#include <vector>
+
+// Available solving engines
+enum class Engine {
+    AUTO,     // Choose from formula features
+    SEARCH,   // Recursive DPLL search (QBFSolver)
+    QCDCL,    // Conflict-driven clause/cube learning (QCDCLSolver)
+    BDD,      // Quantifier elimination on decision diagrams (BDDSolver)
+    TREEDP,   // Dynamic programming over a tree decomposition (TreeDPSolver)
+    AIG,      // Quantifier elimination on and-inverter graphs (AIGSolver)
+    INCDET,   // Skolem functions by incremental determinization, 2QBF (IncDetSolver)
+    EXPAND    // Resolution and universal expansion on the clauses (ExpansionSolver)
+};
+
+/*
+ * Cheap syntactic features of the (preprocessed) formula.
+ * Only variables that still occur in some clause are counted.
+ */
+struct FormulaFeatures {
+    int numVars = 0;                  // Variables occurring in clauses
+    int numClauses = 0;
+    int numUniversal = 0;
+    int numExistential = 0;
+    int numBlocks = 0;                // Non-empty quantifier blocks
+    int alternations = 0;             // Quantifier changes along the prefix
+    int maxBlockSize = 0;
+    int maxUniversalBlockSize = 0;
+    bool outerExistential = true;     // Outermost non-empty block is EXISTS
+    std::vector<int> clauseLengths;   // Histogram: [1], [2], [3], [4], [5+]
+    double binaryRatio = 0.0;         // Fraction of binary clauses
+    double avgClauseLength = 0.0;
+    int cutWidth = 0;                 // Most clauses spanning a cut of prefixVariableOrder()
+    int treeWidth = 0;                // Width of prefixEliminationOrder(), -1 if above the cap
+};
+
+// Engine and options chosen for a formula
+struct EngineConfig {
+    Engine engine = Engine::SEARCH;
+    Engine fallback = Engine::SEARCH; // Takes over when the BDD engine hits its node limit
+                                      // or the tree decomposition is too wide
+    bool reuseStrategies = true;      // QBFSolver: reuse sibling strategies
+    bool breakSymmetries = false;     // Detect and break variable symmetries
+    bool dualPropagation = false;     // QCDCLSolver: use gate definitions (see QCDCLSolver.h)
+    bool dependencyLearning = false;  // QCDCLSolver: learn dependencies instead of the prefix
+    std::string reason;               // Human-readable justification
+};
+
+/*
+ * Variables still occurring in clauses, in prefix order: free variables
+ * first, then block by block, within a block by first appearance in the
+ * clauses (so clauses listed along a chain keep their variables close).
+ * The BDD engine's starting order, and the order cutWidth is measured in.
+ */
+std::vector<int> prefixVariableOrder(const QBFPreprocessor& preprocessor);
+
+/*
+ * Elimination order of a tree decomposition compatible with the prefix:
+ * the quantifier groups of prefixVariableOrder() from the innermost out,
+ * each group by the MIN-FILL heuristic (next is the variable whose
+ * neighbours need the fewest new edges to become a clique). width is the
+ * most neighbours a variable has when it is eliminated; the bags of the
+ * decomposition hold width + 1 variables at most. Gives up with an empty
+ * order and width = maxWidth + 1 as soon as the width would exceed
+ * maxWidth, so measuring a wide formula stays cheap.
+ */
+std::vector<int> prefixEliminationOrder(const QBFPreprocessor& preprocessor, int maxWidth, int& width);
+
+// Compute the feature vector of the preprocessor's current formula
+FormulaFeatures computeFeatures(const QBFPreprocessor& preprocessor);
+
+// The same without cutWidth and treeWidth (left 0): cheap enough to run
+// on the parsed formula, before preprocessing
+FormulaFeatures computeSizeFeatures(const QBFPreprocessor& preprocessor);
+
+// Choose engine and options from the features
+EngineConfig selectEngine(const FormulaFeatures& features);
+
+// Adjust the preprocessing schedule to the size features; returns the reason
+std::string selectPreprocessing(const FormulaFeatures& features, PreprocessSchedule& schedule);
+
+// Engine names as used on the command line ("auto", "search", "qcdcl", "bdd",
+// "treedp", "aig", "incdet", "expand")
+std::string engineName(Engine engine);
+bool parseEngine(const std::string& name, Engine& engine);
+
+// One-line summary of the features, e.g. for --stats
+std::string featuresToString(const FormulaFeatures& features);
+
+#endif // QBF_FEATURES_H
@@ -0,0 +1,124 @@
+/*
+ * QBFOuter.cpp - Anytime reports about the outermost EXISTS block
+ */
+
+#include "QBFOuter.h"
+#include <algorithm>
+
+std::vector<int> outerBlockVariables(const QBFPreprocessor& preprocessor) {
+    // Free variables are outermost existentials and belong to the block
+    std::unordered_set<int> bound;
+    for (const auto& block : preprocessor.getQuantifierBlocks()) {
+        bound.insert(block.variables.begin(), block.variables.end());
+    }
+    std::vector<int> vars;
+    for (const auto& clause : preprocessor.getClauses()) {
+        for (const auto& lit : clause) {
+            if (bound.insert(lit.variable).second) vars.push_back(lit.variable);
+        }
+    }
+    std::vector<int> fixed;  // Free variables already set by preprocessing
+    for (const auto& [var, value] : preprocessor.getAssignments()) {
+        if (!bound.count(var)) fixed.push_back(var);
+    }
+    std::sort(fixed.begin(), fixed.end());
+    vars.insert(vars.end(), fixed.begin(), fixed.end());
+
+    for (const auto& block : preprocessor.getQuantifierBlocks()) {
+        if (block.variables.empty()) continue;
+        if (block.type == Quantifier::EXISTS) {
+            vars.insert(vars.end(), block.variables.begin(), block.variables.end());
+        }
+        break;
+    }
+    return vars;
+}
+
+void freezeOuterBlock(QBFPreprocessor& preprocessor) {
+    for (int var : outerBlockVariables(preprocessor)) preprocessor.freezeVariable(var);
+}
+
+void OuterTracker::reset(const QBFPreprocessor& preprocessor, const OuterCallback& cb) {
+    callback = cb;
+    vars = outerBlockVariables(preprocessor);
+    std::sort(vars.begin(), vars.end());
+    vars.erase(std::unique(vars.begin(), vars.end()), vars.end());
+    varSet = std::unordered_set<int>(vars.begin(), vars.end());
+    forcedVars.clear();
+    best = OuterProgress();
+    currentScore = 0;
+}
+
+bool OuterTracker::isForced(int var, bool value) const {
+    if (!forcedVars.count(var)) return false;
+    for (const auto& lit : best.forced) {
+        if (lit.variable == var) return lit.isNegated != value;
+    }
+    return false;
+}
+
+// Current values of the outer variables (unassigned ones are left out)
+std::vector<Literal> OuterTracker::snapshot(const ValueOf& valueOf) const {
+    std::vector<Literal> lits;
+    for (int var : vars) {
+        int v = valueOf(var);
+        if (v >= 0) lits.emplace_back(var, v == 0);
+    }
+    return lits;
+}
+
+/*
+ * Count a won branch for the current outer assignment. We call back when
+ * a different assignment takes the lead, and when the leader's score
+ * reaches a power of two, so long searches report at a bounded rate.
+ */
+void OuterTracker::solutionFound(const ValueOf& valueOf) {
+    if (!active()) return;
+
+    currentScore++;
+    if (currentScore <= best.score) return;
+
+    std::vector<Literal> current = snapshot(valueOf);
+    bool changed = (current != best.candidate);
+    best.score = currentScore;
+    if (changed) best.candidate = std::move(current);
+    if (changed || (currentScore & (currentScore - 1)) == 0) {
+        callback(best);
+    }
+}
+
+void OuterTracker::forcedFound(int var, bool value) {
+    if (!active() || forcedVars.count(var)) return;
+
+    forcedVars.insert(var);
+    Literal lit(var, !value);
+
+    // A candidate that contradicts a forced literal cannot win any more
+    for (const auto& c : best.candidate) {
+        if (c.variable == var && c.isNegated != lit.isNegated) {
+            best.candidate.clear();
+            best.score = 0;
+            break;
+        }
+    }
+
+    best.forced.insert(std::upper_bound(best.forced.begin(), best.forced.end(), lit,
+                                        [](const Literal& a, const Literal& b) {
+                                            return a.variable < b.variable;
+                                        }),
+                       lit);
+    callback(best);
+}
+
+void OuterTracker::finish(bool proven, bool refuted, const ValueOf& valueOf) {
+    if (!active()) return;
+
+    if (proven) best.candidate = snapshot(valueOf);
+    if (refuted) {
+        best.candidate.clear();
+        best.score = 0;
+    }
+    best.finished = true;
+    best.proven = proven;
+    callback(best);
+}
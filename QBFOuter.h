@@ -0,0 +1,99 @@
+/*
+ * QBFOuter.h - Anytime Reports About the Outermost EXISTS Block
+ *
+ * Many applications only need the OUTERMOST existential assignment: in
+ * ∃x1..xn ∀u ∃y ... the values of x1..xn are the "plan", and the rest of
+ * the formula only checks that the plan survives every universal move.
+ * Such callers want to hear about the plan long before the full solve
+ * finishes, or when a time budget runs out.
+ *
+ * While searching, both engines report through an OuterCallback:
+ *
+ *   CANDIDATE  the outer assignment under which the search has found the
+ *              most winning branches so far (an educated guess, not yet
+ *              a proof)
+ *
+ *   FORCED     outer literals that hold in EVERY winning assignment, e.g.
+ *              x1=false once the whole subtree below x1=true has failed
+ *              (these are proofs, and never change again)
+ *
+ *   FINISHED   the search is over; for a SAT result the candidate is a
+ *              proven winning assignment (unlisted variables are don't-care)
+ *
+ * The outer block is the outermost non-empty block of the prefix if it is
+ * EXISTS, together with any free variables (outermost existentials by the
+ * QDIMACS convention). With ∀ outermost there is no single outer plan.
+ */
+
+#ifndef QBF_OUTER_H
+#define QBF_OUTER_H
+
+#include "QBFPreprocessor.h"
+#include <functional>
+#include <unordered_set>
+#include <vector>
+
+// Snapshot passed to the callback (literals sorted by variable)
+struct OuterProgress {
+    std::vector<Literal> candidate;   // Best outer assignment so far
+    long long score = 0;              // Winning branches found under it
+    std::vector<Literal> forced;      // Literals true in every winning assignment
+    bool finished = false;            // Last report of this solve() call
+    bool proven = false;              // candidate is a winning assignment
+};
+
+using OuterCallback = std::function<void(const OuterProgress&)>;
+
+// Free variables plus the outermost non-empty block if it is EXISTS
+std::vector<int> outerBlockVariables(const QBFPreprocessor& preprocessor);
+
+// Keep the outer block out of pure literal elimination, which picks one
+// winning value and hides the other (call before preprocess(); needed by
+// QBFBackbone and QBFEnumerate, which look at every winning assignment)
+void freezeOuterBlock(QBFPreprocessor& preprocessor);
+
+/*
+ * Bookkeeping shared by the engines. The engine tells the tracker when an
+ * outer variable changes value, when a branch is won and when an outer
+ * literal is proven forced; the tracker decides when to call back.
+ *
+ * Values are read through a function returning 1 (true), 0 (false) or
+ * -1 (unassigned), so each engine can keep its own assignment format.
+ */
+class OuterTracker {
+public:
+    using ValueOf = std::function<int(int)>;
+
+    // Start a new solve; reports are disabled without a callback
+    void reset(const QBFPreprocessor& preprocessor, const OuterCallback& callback);
+
+    bool active() const { return static_cast<bool>(callback) && !vars.empty(); }
+    bool isOuter(int var) const { return varSet.count(var) > 0; }
+    const std::vector<int>& variables() const { return vars; }
+    bool isForced(int var, bool value) const;
+
+    // An outer variable was (re)assigned: the current candidate is new
+    void newAssignment() { currentScore = 0; }
+
+    // A branch was won under the current outer assignment
+    void solutionFound(const ValueOf& valueOf);
+
+    // var=value holds in every winning outer assignment
+    void forcedFound(int var, bool value);
+
+    // Final report. proven: valueOf describes a winning assignment;
+    // refuted: no outer assignment wins, so there is no candidate
+    void finish(bool proven, bool refuted, const ValueOf& valueOf);
+
+private:
+    OuterCallback callback;
+    std::vector<int> vars;
+    std::unordered_set<int> varSet;
+    std::unordered_set<int> forcedVars;
+    OuterProgress best;
+    long long currentScore = 0;
+
+    std::vector<Literal> snapshot(const ValueOf& valueOf) const;
+};
+
+#endif // QBF_OUTER_H
@@ -0,0 +1,305 @@
+/*
+ * QBFPortfolio.cpp - Portfolio workers and the two ways they share
+ */
+
+#include "QBFPortfolio.h"
+#include "QBFTrace.h"
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
+
+namespace {
+
+using Clock = std::chrono::steady_clock;
+
+/*
+ * Free sharing: a lock-free broadcast ring of RING_SIZE slots. Every
+ * published constraint gets the next position from one atomic counter
+ * and is written to slot (position % RING_SIZE); each worker remembers
+ * which position it has read up to. Nobody ever waits:
+ *
+ *   - A slot is guarded by a sequence number (a seqlock): odd while it
+ *     is written, 2 * position + 2 once position's constraint is in it.
+ *     A writer claims the slot with one compare-and-swap; if another
+ *     writer is still in the slot (the ring wrapped around meanwhile),
+ *     the constraint is dropped instead of waited for.
+ *   - A reader copies the slot and checks that the sequence number did
+ *     not change while it copied. A slot still being written ends this
+ *     collect (it is picked up at the next restart); a slot already
+ *     overwritten, or a worker more than RING_SIZE behind, loses those
+ *     constraints.
+ *
+ * Losing a shared constraint only costs the receiver some pruning; all
+ * of them are implied by the formula. The first worker with an answer
+ * stops the others.
+ */
+class FreeSharing : public ConstraintSharing {
+public:
+    explicit FreeSharing(int numWorkers) : slots(RING_SIZE), cursor(numWorkers, 0) {}
+
+    void publish(int worker, const SharedConstraint& constraint) override {
+        if (constraint.lits.size() > static_cast<size_t>(SHARE_MAX_SIZE)) return;
+        unsigned long long position = head.fetch_add(1, std::memory_order_relaxed);
+        Slot& slot = slots[position % RING_SIZE];
+
+        // Claim: only from a finished, older state of the slot
+        unsigned long long seq = slot.seq.load(std::memory_order_relaxed);
+        if ((seq & 1) || seq > 2 * position ||
+            !slot.seq.compare_exchange_strong(seq, 2 * position + 1, std::memory_order_acquire)) {
+            return;
+        }
+        slot.worker.store(worker, std::memory_order_relaxed);
+        slot.isCube.store(constraint.isCube, std::memory_order_relaxed);
+        slot.lbd.store(constraint.lbd, std::memory_order_relaxed);
+        slot.size.store(constraint.lits.size(), std::memory_order_relaxed);
+        for (size_t i = 0; i < constraint.lits.size(); i++) {
+            slot.lits[i].store(constraint.lits[i], std::memory_order_relaxed);
+        }
+        slot.seq.store(2 * position + 2, std::memory_order_release);
+    }
+
+    bool learned(int) override {
+        return !stop.load(std::memory_order_relaxed);
+    }
+
+    void collect(int worker, std::vector<SharedConstraint>& out) override {
+        unsigned long long end = head.load(std::memory_order_acquire);
+        unsigned long long position = std::max(cursor[worker], end > RING_SIZE ? end - RING_SIZE : 0);
+        for (; position < end; position++) {
+            Slot& slot = slots[position % RING_SIZE];
+            unsigned long long seq = slot.seq.load(std::memory_order_acquire);
+            if (seq == 2 * position + 1) break;   // Still being written
+            if (seq != 2 * position + 2) continue; // Dropped or overwritten
+
+            SharedConstraint constraint;
+            int sender = slot.worker.load(std::memory_order_relaxed);
+            constraint.isCube = slot.isCube.load(std::memory_order_relaxed);
+            constraint.lbd = slot.lbd.load(std::memory_order_relaxed);
+            int size = std::min(slot.size.load(std::memory_order_relaxed), SHARE_MAX_SIZE);
+            for (int i = 0; i < size; i++) {
+                constraint.lits.push_back(slot.lits[i].load(std::memory_order_relaxed));
+            }
+            std::atomic_thread_fence(std::memory_order_acquire);
+            if (slot.seq.load(std::memory_order_relaxed) != seq) continue;  // Overwritten while copying
+            if (sender != worker) out.push_back(std::move(constraint));
+        }
+        cursor[worker] = position;
+    }
+
+    void finished(int worker, Result result) override {
+        if (result == Result::UNKNOWN) return;  // Stopped or out of time
+        int none = -1;
+        firstDone.compare_exchange_strong(none, worker);
+        stop = true;
+    }
+
+    int winner() const { return firstDone; }
+
+private:
+    static const unsigned long long RING_SIZE = 4096;
+
+    // One constraint; every field is atomic so that a reader racing with
+    // a writer reads stale values (caught by the sequence check), not
+    // undefined behaviour
+    struct Slot {
+        std::atomic<unsigned long long> seq{0};
+        std::atomic<int> worker{-1};
+        std::atomic<bool> isCube{false};
+        std::atomic<int> lbd{0};
+        std::atomic<int> size{0};
+        std::atomic<int> lits[SHARE_MAX_SIZE] = {};
+    };
+
+    std::vector<Slot> slots;
+    std::atomic<unsigned long long> head{0};
+    std::vector<unsigned long long> cursor;  // Entry i is read and written by worker i only
+    std::atomic<bool> stop{false};
+    std::atomic<int> firstDone{-1};
+};
+
+/*
+ * Deterministic sharing: epochs separated by barriers. During an epoch
+ * each worker only writes its own outbox; the last worker to reach the
+ * barrier moves all outboxes to the other workers' inboxes in worker
+ * order and decides whether the search is over.
+ */
+class EpochSharing : public ConstraintSharing {
+public:
+    EpochSharing(int numWorkers, int epochLength, double timeLimit)
+        : numWorkers(numWorkers), epochLength(epochLength), timeLimit(timeLimit),
+          start(Clock::now()), outbox(numWorkers), inbox(numWorkers),
+          learnedCount(numWorkers, 0), results(numWorkers, Result::UNKNOWN), done(numWorkers, false) {}
+
+    void publish(int worker, const SharedConstraint& constraint) override {
+        outbox[worker].push_back(constraint);
+    }
+
+    bool learned(int worker) override {
+        if (++learnedCount[worker] % epochLength != 0) return true;
+        return barrier();
+    }
+
+    void collect(int worker, std::vector<SharedConstraint>& out) override {
+        std::lock_guard<std::mutex> lock(mutex);
+        for (auto& constraint : inbox[worker]) out.push_back(std::move(constraint));
+        inbox[worker].clear();
+    }
+
+    void finished(int worker, Result result) override {
+        {
+            std::lock_guard<std::mutex> lock(mutex);
+            if (stop) return;  // Stopped at a barrier: already accounted for
+            results[worker] = result;
+            done[worker] = true;
+        }
+        barrier();
+    }
+
+    int winner() const { return winningWorker; }
+    long long epochs() const { return generation; }
+
+private:
+    // Wait for every worker; false = the search is over
+    bool barrier() {
+        TraceScope traced("barrier", "portfolio");
+        std::unique_lock<std::mutex> lock(mutex);
+        long long myGeneration = generation;
+        if (++arrived < numWorkers) {
+            released.wait(lock, [&]() { return generation != myGeneration; });
+            return !stop;
+        }
+
+        // Last to arrive: deliver the epoch's constraints in worker order
+        for (int receiver = 0; receiver < numWorkers; receiver++) {
+            for (int sender = 0; sender < numWorkers; sender++) {
+                if (sender == receiver) continue;
+                inbox[receiver].insert(inbox[receiver].end(), outbox[sender].begin(), outbox[sender].end());
+            }
+        }
+        for (auto& box : outbox) box.clear();
+
+        // Over if anyone finished (lowest number wins) or time is up
+        for (int worker = 0; worker < numWorkers && winningWorker < 0; worker++) {
+            if (done[worker] && results[worker] != Result::UNKNOWN) winningWorker = worker;
+        }
+        bool outOfTime = timeLimit > 0 &&
+                         std::chrono::duration<double>(Clock::now() - start).count() >= timeLimit;
+        for (int worker = 0; worker < numWorkers; worker++) {
+            if (done[worker]) stop = true;
+        }
+        if (outOfTime) stop = true;
+
+        arrived = 0;
+        generation++;
+        released.notify_all();
+        return !stop;
+    }
+
+    const int numWorkers;
+    const int epochLength;
+    const double timeLimit;
+    const Clock::time_point start;
+
+    std::mutex mutex;
+    std::condition_variable released;
+    int arrived = 0;
+    long long generation = 0;
+    bool stop = false;
+    int winningWorker = -1;
+
+    std::vector<std::vector<SharedConstraint>> outbox;  // Written by its worker only
+    std::vector<std::vector<SharedConstraint>> inbox;   // Filled at barriers
+    std::vector<long long> learnedCount;                // Written by its worker only
+    std::vector<Result> results;
+    std::vector<bool> done;
+};
+
+}  // namespace
+
+void QBFPortfolio::setThreads(int numThreads) {
+    threads = std::max(1, numThreads);
+}
+
+void QBFPortfolio::setDeterministic(bool value) {
+    deterministic = value;
+}
+
+void QBFPortfolio::setEpochLength(int constraints) {
+    epochLength = std::max(1, constraints);
+}
+
+void QBFPortfolio::setSymmetries(const SymmetryInfo& value) {
+    symmetries = value;
+}
+
+void QBFPortfolio::setDualPropagation(bool enabled) {
+    dual = enabled;
+}
+
+void QBFPortfolio::setDependencyLearning(bool enabled) {
+    dependencyLearning = enabled;
+}
+
+void QBFPortfolio::setTimeLimit(double seconds) {
+    timeLimit = seconds;
+}
+
+/*
+ * Run the workers and take the winner's answer. With one thread this is
+ * exactly a single QCDCLSolver.
+ */
+Result QBFPortfolio::solve(const QBFPreprocessor& preprocessor) {
+    std::vector<QCDCLSolver> solvers(threads);
+    std::vector<Result> results(threads, Result::UNKNOWN);
+
+    if (threads == 1) {
+        solvers[0].setSymmetries(symmetries);
+        solvers[0].setDualPropagation(dual);
+        solvers[0].setDependencyLearning(dependencyLearning);
+        solvers[0].setTimeLimit(timeLimit);
+        results[0] = solvers[0].solve(preprocessor);
+        winner = 0;
+    } else {
+        std::unique_ptr<FreeSharing> freeSharing;
+        std::unique_ptr<EpochSharing> epochs;
+        ConstraintSharing* sharing;
+        if (deterministic) {
+            epochs = std::make_unique<EpochSharing>(threads, epochLength, timeLimit);
+            sharing = epochs.get();
+        } else {
+            freeSharing = std::make_unique<FreeSharing>(threads);
+            sharing = freeSharing.get();
+        }
+
+        std::vector<std::thread> workers;
+        for (int i = 0; i < threads; i++) {
+            workers.emplace_back([&, i]() {
+                traceThreadName("worker " + std::to_string(i));
+                TraceScope traced("worker", "portfolio", "worker", i);
+                solvers[i].setSymmetries(symmetries);
+                solvers[i].setDualPropagation(dual);
+                solvers[i].setDependencyLearning(dependencyLearning);
+                solvers[i].setSharing(sharing, i);
+                // Deterministic mode checks the time at barriers only: a
+                // worker's own clock would make its run depend on timing
+                if (!deterministic) solvers[i].setTimeLimit(timeLimit);
+                results[i] = solvers[i].solve(preprocessor);
+            });
+        }
+        for (auto& worker : workers) worker.join();
+        winner = deterministic ? epochs->winner() : freeSharing->winner();
+    }
+
+    // Without a winner (time limit) report worker 0
+    int reported = winner >= 0 ? winner : 0;
+    stats = solvers[reported].getStats();
+    stats.workers = threads;
+    if (threads > 1) stats.engine = deterministic ? "qcdcl-portfolio (deterministic)" : "qcdcl-portfolio";
+    assignments = solvers[reported].getAssignments();
+    return winner >= 0 ? results[winner] : Result::UNKNOWN;
+}
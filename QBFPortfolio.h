@@ -0,0 +1,122 @@
+/*
+ * QBFPortfolio.h - Parallel QCDCL With Clause and Cube Sharing
+ *
+ * A PORTFOLIO runs several QCDCL workers on the same formula, each with a
+ * different search order (worker 0 is the plain single-threaded solver,
+ * the others flip initial phases, restart at other intervals and break
+ * activity ties differently). Whichever worker finishes first answers for
+ * all. Learned clauses and cubes are implied by the formula, so workers
+ * can hand short ones to each other: one worker's dead end prunes the
+ * search of all the others.
+ *
+ * Shared constraints are only added at decision level 0 (after a
+ * restart), where a new clause or cube can be checked like an original
+ * one without touching the current branch. Before that, the receiver
+ * checks that the constraint fits its quantifier prefix and reduces it.
+ *
+ * TWO MODES:
+ *
+ *   free           Workers publish constraints as they learn them into
+ *                  a lock-free ring and pick up everything new at their
+ *                  next restart. Sharing never blocks a worker: a
+ *                  constraint that would have to wait for a slot is
+ *                  dropped. Fast, but which worker wins, and with which
+ *                  statistics, depends on thread timing.
+ *
+ *   deterministic  Workers run in EPOCHS of a fixed number of learned
+ *                  constraints, then meet at a barrier. Constraints
+ *                  learned during the epoch are delivered to every other
+ *                  worker in worker order, and queued until its next
+ *                  restart. If any worker finished during the epoch, the
+ *                  lowest-numbered finished worker wins. Each worker's
+ *                  run then depends only on the formula and the worker
+ *                  number, never on timing: the result, the statistics
+ *                  and the winning assignment are the same on every run.
+ *
+ * The price of determinism is waiting: at every barrier the fastest
+ * worker waits for the slowest one, and a finished worker's answer is
+ * only taken at the end of the epoch. Both are bounded by one epoch.
+ * A time limit is checked at the barriers only.
+ */
+
+#ifndef QBF_PORTFOLIO_H
+#define QBF_PORTFOLIO_H
+
+#include "QCDCLSolver.h"
+#include "QBFPreprocessor.h"
+#include "QBFSolver.h"
+#include "QBFSymmetry.h"
+#include <unordered_map>
+#include <vector>
+
+// Learned constraints handed to other workers: short ones with few
+// decision levels are the ones likely to prune their searches too
+const int SHARE_MAX_LBD = 4;
+const int SHARE_MAX_SIZE = 16;
+
+// A learned clause or cube handed from one worker to the others
+// (literals in QCDCLSolver's 2v / 2v+1 encoding)
+struct SharedConstraint {
+    std::vector<int> lits;
+    bool isCube;
+    int lbd;
+};
+
+/*
+ * How workers exchange constraints; QCDCLSolver calls these.
+ */
+class ConstraintSharing {
+public:
+    virtual ~ConstraintSharing() = default;
+
+    // Worker learned a constraint worth sharing
+    virtual void publish(int worker, const SharedConstraint& constraint) = 0;
+
+    // Called after every learned constraint; false = stop searching
+    virtual bool learned(int worker) = 0;
+
+    // Constraints from other workers that this worker has not seen yet
+    virtual void collect(int worker, std::vector<SharedConstraint>& out) = 0;
+
+    // Worker's search is over (with a result, or stopped)
+    virtual void finished(int worker, Result result) = 0;
+};
+
+class QBFPortfolio {
+public:
+    // Number of workers (1 = a single QCDCLSolver)
+    void setThreads(int threads);
+
+    // Same result, statistics and winning assignment on every run
+    void setDeterministic(bool deterministic);
+
+    // Learned constraints per worker between two barriers (deterministic)
+    void setEpochLength(int constraints);
+
+    void setSymmetries(const SymmetryInfo& symmetries);
+    void setDualPropagation(bool enabled);
+    void setDependencyLearning(bool enabled);
+    void setTimeLimit(double seconds);
+
+    Result solve(const QBFPreprocessor& preprocessor);
+
+    // Statistics and assignments of the winning worker
+    const SolverStats& getStats() const { return stats; }
+    const std::unordered_map<int, bool>& getAssignments() const { return assignments; }
+    int getWinner() const { return winner; }
+
+private:
+    int threads = 1;
+    bool deterministic = false;
+    int epochLength = 256;
+    SymmetryInfo symmetries;
+    bool dual = false;
+    bool dependencyLearning = false;
+    double timeLimit = 0;
+
+    SolverStats stats;
+    std::unordered_map<int, bool> assignments;
+    int winner = -1;
+};
+
+#endif // QBF_PORTFOLIO_H
@@ -14,17 +14,70 @@
  *
  * 2. Pure Literal Elimination
  *    - Find variables that appear with only one polarity (only positive or only negative)
- *    - Assign them the satisfying value
  *    - For existentials: pick the value that satisfies clauses
- *    - For universals: safe to eliminate if no dependency issues
+ *    - For universals: pick the value that FALSIFIES the literal (FORALL
+ *      never gains anything by satisfying clauses)
+ *
+ * 3. Subsumption
+ *    - Remove clauses that contain all literals of another clause
+ *
+ * Every assignment goes through assign(), which records it on the trail
+ * used by incremental preprocessing.
+ *
+ * preprocess() runs the techniques as scheduled by a PreprocessSchedule.
+ * The techniques count their work in ticks and check the running
+ * technique's budget inside their loops, not only between techniques,
+ * so one expensive pass cannot overrun it by much.
  */
 
 #include "QBFPreprocessor.h"
+#include "QBFTrace.h"
 #include <algorithm>
 #include <string>
 #include <iostream>
+#include <thread>
 #include <vector>
 
+namespace {
+
+// Below this many clauses per thread, starting threads costs more than it saves
+const size_t MIN_CLAUSES_PER_THREAD = 20000;
+
+// Subsumption checks clauses in chunks of this size; the budget is checked
+// between chunks, in clause order
+const size_t SUBSUMPTION_CHUNK = 2048;
+
+/*
+ * Call work(begin, end, slice) on `slices` consecutive slices of
+ * [0, count), each on its own thread (the calling thread if only one).
+ */
+template <typename Work>
+void forEachSlice(size_t count, int slices, Work work) {
+    if (slices <= 1 || count <= 1) {
+        work(size_t(0), count, 0);
+        return;
+    }
+    size_t perSlice = (count + slices - 1) / slices;
+    std::vector<std::thread> workers;
+    for (int slice = 0; slice < slices; slice++) {
+        size_t begin = slice * perSlice;
+        size_t end = std::min(count, begin + perSlice);
+        if (begin >= end) break;
+        workers.emplace_back([&work, begin, end, slice]() {
+            traceThreadName("preprocess " + std::to_string(slice + 1));
+            work(begin, end, slice);
+        });
+    }
+    for (auto& worker : workers) worker.join();
+}
+
+// Index of a literal in occurrence lists and mark tables
+inline size_t literalIndex(const Literal& lit) {
+    return 2 * size_t(lit.variable) + (lit.isNegated ? 1 : 0);
+}
+
+}  // namespace
+
 // ============================================================================
 // Literal Implementation
 // ============================================================================
@@ -59,36 +112,6 @@ void QBFPreprocessor::printQuantifierBlock(const QuantifierBlock& block) const {
     }
 }
 
-// ============================================================================
-// Pure Literal Detection
-// ============================================================================
-
-/*
- * Check if a literal is "pure" - appears only in one polarity.
- *
- * A literal is pure if its complement never appears in any clause.
- * Example: If x3 appears but ~x3 never does, then x3 is pure.
- *
- * Pure literals are important because:
- * - For existential vars: we can always choose the satisfying value
- * - For universal vars: if pure, it doesn't constrain the formula
- */
-bool QBFPreprocessor::isPureLiteral(const Literal& lit) {
-    bool foundLit = false;
-    for (const auto& clause : clauses) {
-        for (const auto& currLit : clause) {
-            if (currLit.variable == lit.variable) {
-                // Found the same variable - check polarity
-                if (currLit.isNegated != lit.isNegated) {
-                    return false;  // Found complement, not pure
-                }
-                foundLit = true;
-            }
-        }
-    }
-    return foundLit;  // Pure if found and no complement exists
-}
-
 // ============================================================================
 // Dependency Checking for QBF
 // ============================================================================
@@ -222,9 +245,11 @@ bool QBFPreprocessor::unitPropagate() {
 
     do {
         foundUnit = false;
+        if (budgetExhausted()) break;  // Every propagation so far is complete
 
         // Collect all unit clauses with their block indices
         std::vector<std::pair<Literal, int>> unitLiterals;
+        ticks += clauses.size();
         for (const auto& clause : clauses) {
             if (clause.size() == 1) {
                 const Literal& unit = clause[0];
@@ -239,14 +264,25 @@ bool QBFPreprocessor::unitPropagate() {
                  [](const auto& a, const auto& b) { return a.second > b.second; });
 
         for (const auto& [unit, blockIndex] : unitLiterals) {
+            // Each candidate costs a scan of the clauses: stop between them
+            if (budgetExhausted()) break;
+
             // Skip if already assigned
             if (assignments.count(unit.variable) > 0) continue;
 
+            // A unit clause of a single universal literal is not a unit at
+            // all: FORALL plays the falsifying value and the clause is empty
+            if (varToQuantifier.at(unit.variable) == Quantifier::FORALL) {
+                clauses = {Clause()};
+                return true;
+            }
+
             // Check if we can safely propagate this variable
             auto relevantClauses = getRelevantClauses(unit.variable);
+            ticks += clauses.size() + relevantClauses.size();
             if (canPropagateVariable(unit.variable, relevantClauses)) {
                 // Assign: if literal is positive, var=true; if negated, var=false
-                assignments[unit.variable] = !unit.isNegated;
+                assign(unit.variable, !unit.isNegated, false);
 
                 // Remove clauses satisfied by this assignment
                 auto newEnd = std::remove_if(clauses.begin(), clauses.end(),
@@ -292,36 +328,66 @@ bool QBFPreprocessor::unitPropagate() {
  * Perform pure literal elimination.
  *
  * A pure literal appears with only one polarity in all clauses.
- * We can assign it the satisfying value:
+ * For an existential variable we assign the satisfying value:
  * - If x is pure (never ~x), set x=true
  * - If ~x is pure (never x), set x=false
+ * For a universal variable it is the other way round: FORALL is trying
+ * to falsify clauses, so it sets the pure literal false.
  *
  * Returns true if any elimination was performed.
  */
 bool QBFPreprocessor::pureLiteralElimination() {
     bool changed = false;
     std::vector<std::pair<int, bool>> assignments_to_make;
+    if (budgetExhausted()) return false;
+
+    // Which polarities occur (bit 1 = positive, bit 2 = negative): one
+    // pass over the clauses instead of one per variable. Each thread
+    // fills its own table for its slice; the tables are OR-ed together.
+    const int numVars = maxVariable() + 1;
+    const int slices = slicesFor(clauses.size());
+    std::vector<std::vector<unsigned char>> sliceTables(slices);
+    forEachSlice(clauses.size(), slices, [&](size_t begin, size_t end, int slice) {
+        TraceScope traced("polarities", "preprocess");
+        std::vector<unsigned char>& table = sliceTables[slice];
+        table.assign(numVars, 0);
+        for (size_t i = begin; i < end; i++) {
+            for (const auto& lit : clauses[i]) table[lit.variable] |= lit.isNegated ? 2 : 1;
+        }
+    });
+    std::vector<unsigned char> polarity(numVars, 0);
+    for (const auto& table : sliceTables) {
+        for (int var = 0; var < (int)table.size(); var++) polarity[var] |= table[var];
+    }
+    ticks += countLiterals();
 
-    // Process blocks from innermost to outermost
+    // Process blocks from innermost to outermost; a pure literal stays
+    // pure when others are assigned, so stopping early keeps those found
     for (int blockIndex = quantifierBlocks.size() - 1; blockIndex >= 0; --blockIndex) {
         const auto& block = quantifierBlocks[blockIndex];
+        if (budgetExhausted()) break;
 
         for (int var : block.variables) {
-            // Skip already assigned variables
-            if (assignments.count(var)) continue;
+            ticks++;
+            if (budgetExhausted()) break;
+
+            // Skip already assigned and frozen variables
+            if (assignments.count(var) || frozen.count(var)) continue;
             // Skip if we can't safely eliminate
             if (!canEliminateVariable(var)) continue;
 
-            Literal posLit(var, false);  // x
-            Literal negLit(var, true);   // ~x
-
-            bool posIsPure = isPureLiteral(posLit);
-            bool negIsPure = isPureLiteral(negLit);
+            // x is pure if it occurs but ~x never does: for existential
+            // vars we can always choose the satisfying value, and a pure
+            // universal does not constrain the formula
+            unsigned char seen = (var < numVars) ? polarity[var] : 0;
+            bool posIsPure = (seen == 1);
+            bool negIsPure = (seen == 2);
 
             if (posIsPure || negIsPure) {
-                // Assign the satisfying value
-                // If positive is pure, set true; if negative is pure, set false
+                // EXISTS assigns the satisfying value (x pure → true),
+                // FORALL the falsifying one (x pure → false)
                 bool assignment = posIsPure;
+                if (block.type == Quantifier::FORALL) assignment = !assignment;
                 assignments_to_make.emplace_back(var, assignment);
                 changed = true;
             }
@@ -330,7 +396,7 @@ bool QBFPreprocessor::pureLiteralElimination() {
 
     // Apply all assignments
     for (const auto& [var, value] : assignments_to_make) {
-        assignments[var] = value;
+        assign(var, value, true);
     }
 
     // Simplify clauses based on new assignments
@@ -341,6 +407,109 @@ bool QBFPreprocessor::pureLiteralElimination() {
     return changed;
 }
 
+// ============================================================================
+// Subsumption
+// ============================================================================
+
+/*
+ * Remove subsumed clauses: C is removed if another clause D has only
+ * literals of C. D is the smaller one of the two, or the earlier one if
+ * both have the same size, so of two identical clauses the first stays.
+ *
+ * Every clause D is listed under ONE of its literals, the rarest one
+ * (one-watched-literal subsumption). If D ⊆ C, that literal is in C, so
+ * the candidates for C are the clauses listed under C's literals - far
+ * fewer than all clauses sharing a literal with C.
+ *
+ * Returns true if any clause was removed.
+ */
+bool QBFPreprocessor::subsumption() {
+    if (budgetExhausted()) return false;
+
+    // Watch lists: literal index -> clauses listed under it, in order
+    const size_t numLiterals = 2 * size_t(maxVariable() + 1);
+    std::vector<int> occurrenceCount(numLiterals, 0);
+    for (const auto& clause : clauses) {
+        for (const auto& lit : clause) occurrenceCount[literalIndex(lit)]++;
+    }
+    std::vector<std::vector<int>> watches(numLiterals);
+    for (size_t i = 0; i < clauses.size(); i++) {
+        if (clauses[i].empty()) continue;
+        size_t rarest = literalIndex(clauses[i][0]);
+        for (const auto& lit : clauses[i]) {
+            if (occurrenceCount[literalIndex(lit)] < occurrenceCount[rarest]) rarest = literalIndex(lit);
+        }
+        watches[rarest].push_back(i);
+    }
+    ticks += 2 * countLiterals();
+
+    std::vector<char> subsumed(clauses.size(), 0);
+    const size_t numChunks = (clauses.size() + SUBSUMPTION_CHUNK - 1) / SUBSUMPTION_CHUNK;
+    std::vector<long long> chunkTicks(numChunks, 0);
+    const int slices = slicesFor(clauses.size());
+
+    // Checks the clauses of chunks [first, last) with the given marks
+    auto checkChunks = [&](size_t first, size_t last, std::vector<char>& marks) {
+        for (size_t chunk = first; chunk < last; chunk++) {
+            size_t begin = chunk * SUBSUMPTION_CHUNK;
+            size_t end = std::min(clauses.size(), begin + SUBSUMPTION_CHUNK);
+            long long work = 0;
+            for (size_t c = begin; c < end; c++) {
+                const Clause& clause = clauses[c];
+                if (clause.empty()) continue;
+
+                for (const auto& lit : clause) marks[literalIndex(lit)] = 1;
+                for (const auto& lit : clause) {
+                    for (int d : watches[literalIndex(lit)]) {
+                        const Clause& other = clauses[d];
+                        if ((size_t)d == c || other.size() > clause.size()) continue;
+                        if (other.size() == clause.size() && (size_t)d > c) continue;
+                        work += other.size();
+                        if (std::all_of(other.begin(), other.end(),
+                                        [&](const Literal& l) { return marks[literalIndex(l)]; })) {
+                            subsumed[c] = 1;
+                            break;
+                        }
+                    }
+                    if (subsumed[c]) break;
+                }
+                for (const auto& lit : clause) marks[literalIndex(lit)] = 0;
+                work += clause.size();
+            }
+            chunkTicks[chunk] = work;
+        }
+    };
+
+    // Waves of chunks, checked in parallel; the results are taken in chunk
+    // order until the budget runs out, so the thread count does not matter
+    size_t accepted = 0;
+    while (accepted < numChunks && !budgetExhausted()) {
+        size_t waveEnd = std::min(numChunks, accepted + 4 * size_t(slices));
+        size_t waveStart = accepted;
+        forEachSlice(waveEnd - waveStart, slices, [&](size_t begin, size_t end, int) {
+            TraceScope traced("subsumption checks", "preprocess");
+            std::vector<char> marks(numLiterals, 0);
+            checkChunks(waveStart + begin, waveStart + end, marks);
+        });
+        for (size_t chunk = waveStart; chunk < waveEnd; chunk++) {
+            if (budgetExhausted()) break;
+            ticks += chunkTicks[chunk];
+            accepted = chunk + 1;
+        }
+    }
+
+    // Keep the clauses that are not subsumed (or were never checked)
+    size_t checkedClauses = std::min(clauses.size(), accepted * SUBSUMPTION_CHUNK);
+    std::vector<Clause> kept;
+    kept.reserve(clauses.size());
+    for (size_t i = 0; i < clauses.size(); i++) {
+        if (i >= checkedClauses || !subsumed[i]) kept.push_back(std::move(clauses[i]));
+    }
+    bool changed = kept.size() < clauses.size();
+    clauses = std::move(kept);
+    return changed;
+}
+
 // ============================================================================
 // Clause Simplification
 // ============================================================================
@@ -357,6 +526,7 @@ void QBFPreprocessor::simplifyClauses() {
     std::vector<Clause> newClauses;
 
     for (const auto& clause : clauses) {
+        ticks += clause.size();
         bool isClauseSatisfied = false;
         Clause newClause;
 
@@ -410,45 +580,249 @@ void QBFPreprocessor::addQuantifierBlock(Quantifier type, const std::vector<int>
 }
 
 /*
- * Add a clause to the formula.
+ * Add a clause to the formula. In incremental mode, clauses added after
+ * preprocess() are held back until the next preprocess() call.
  */
 void QBFPreprocessor::addClause(const Clause& clause) {
+    if (incremental) {
+        originalClauses.push_back(clause);
+        if (preprocessed) {
+            pendingClauses.push_back(clause);
+            return;
+        }
+    }
     clauses.push_back(clause);
 }
 
+void QBFPreprocessor::enableIncremental() {
+    incremental = true;
+    originalClauses = clauses;
+}
+
+void QBFPreprocessor::freezeVariable(int var) {
+    frozen.insert(var);
+}
+
+bool QBFPreprocessor::isFrozen(int var) const {
+    return frozen.count(var) > 0;
+}
+
+// Record an assignment on the trail
+void QBFPreprocessor::assign(int var, bool value, bool pure) {
+    assignments[var] = value;
+    trail.push_back({var, value, pure});
+}
+
+// Variables in no quantifier block are outermost existentials
+void QBFPreprocessor::registerFreeVariables(const std::vector<Clause>& newClauses) {
+    for (const auto& clause : newClauses) {
+        for (const auto& lit : clause) {
+            if (!varToQuantifier.count(lit.variable)) {
+                varToQuantifier[lit.variable] = Quantifier::EXISTS;
+                varToBlockIndex[lit.variable] = -1;
+            }
+        }
+    }
+}
+
+/*
+ * Merge the clauses added since the last preprocess() call.
+ *
+ * A new clause with the opposite literal of a pure assignment makes that
+ * assignment (and everything derived after it) unjustified: undo the
+ * trail back to the earliest such step and rebuild the clauses from the
+ * originals under the remaining assignments. Otherwise the new clauses
+ * are simply simplified by the current assignments.
+ *
+ * Returns true if the preprocessing loop has to run again.
+ */
+bool QBFPreprocessor::addPendingClauses() {
+    std::unordered_map<int, size_t> pureStep;  // Variable -> trail position
+    for (size_t i = 0; i < trail.size(); i++) {
+        if (trail[i].pure) pureStep[trail[i].variable] = i;
+    }
+
+    size_t undoFrom = trail.size();
+    for (const auto& clause : pendingClauses) {
+        for (const auto& lit : clause) {
+            auto it = pureStep.find(lit.variable);
+            if (it == pureStep.end()) continue;
+            // EXISTS made its pure literal true, FORALL made it false; the
+            // opposite literal is the one with the other truth value
+            const TrailStep& step = trail[it->second];
+            bool litTrue = (step.value != lit.isNegated);
+            bool oppositeOfPure = (varToQuantifier.at(lit.variable) == Quantifier::EXISTS) ? !litTrue : litTrue;
+            if (oppositeOfPure) undoFrom = std::min(undoFrom, it->second);
+        }
+    }
+    std::vector<Clause> added;
+    added.swap(pendingClauses);
+
+    if (undoFrom < trail.size()) {
+        trail.resize(undoFrom);
+        assignments.clear();
+        for (const auto& step : trail) assignments[step.variable] = step.value;
+        clauses = originalClauses;
+        simplifyClauses();
+        return true;
+    }
+
+    // The old fixpoint still holds unless a new clause is unit or empty
+    bool rerun = false;
+    std::vector<Clause> previous;
+    previous.swap(clauses);
+    clauses = added;
+    simplifyClauses();
+    for (const auto& clause : clauses) {
+        if (clause.size() <= 1) rerun = true;
+    }
+    if (!clauses.empty() && clauses[0].empty()) return true;  // Contradiction: keep only it
+    clauses.insert(clauses.begin(), previous.begin(), previous.end());
+    return rerun;
+}
+
+const char* techniqueName(PreprocessTechnique technique) {
+    switch (technique) {
+        case PreprocessTechnique::UNIT_PROPAGATION: return "unit propagation";
+        case PreprocessTechnique::PURE_LITERALS: return "pure literals";
+        case PreprocessTechnique::SUBSUMPTION: return "subsumption";
+    }
+    return "?";
+}
+
+bool parseTechnique(const std::string& name, PreprocessTechnique& technique) {
+    if (name == "unit" || name == "units") {
+        technique = PreprocessTechnique::UNIT_PROPAGATION;
+    } else if (name == "pure") {
+        technique = PreprocessTechnique::PURE_LITERALS;
+    } else if (name == "subsume" || name == "subsumption") {
+        technique = PreprocessTechnique::SUBSUMPTION;
+    } else {
+        return false;
+    }
+    return true;
+}
+
+void QBFPreprocessor::setSchedule(const PreprocessSchedule& newSchedule) {
+    schedule = newSchedule;
+}
+
+void QBFPreprocessor::setThreads(int numThreads) {
+    threads = std::max(1, numThreads);
+}
+
+// Threads worth starting for this many clauses
+int QBFPreprocessor::slicesFor(size_t numClauses) const {
+    size_t useful = std::max<size_t>(1, numClauses / MIN_CLAUSES_PER_THREAD);
+    return (int)std::min<size_t>(threads, useful);
+}
+
+int QBFPreprocessor::maxVariable() const {
+    int maxVar = 0;
+    for (const auto& [var, type] : varToQuantifier) maxVar = std::max(maxVar, var);
+    for (const auto& clause : clauses) {
+        for (const auto& lit : clause) maxVar = std::max(maxVar, lit.variable);
+    }
+    return maxVar;
+}
+
+long long QBFPreprocessor::countLiterals() const {
+    long long total = 0;
+    for (const auto& clause : clauses) total += clause.size();
+    return total;
+}
+
 /*
- * Run all preprocessing steps until no more simplifications possible.
+ * Run the scheduled preprocessing techniques until no more simplifications
+ * are possible, or the schedule says to stop (budgets, gain, rounds).
  *
  * Returns true if the formula is potentially satisfiable,
  * false if we detected UNSAT (empty clause found).
  */
 bool QBFPreprocessor::preprocess() {
-    bool changed;
-    bool hasEmptyClause = false;
+    auto hasEmptyClause = [this]() {
+        return std::any_of(clauses.begin(), clauses.end(), [](const Clause& c) { return c.empty(); });
+    };
+
+    // Variables in no quantifier block are outermost existentials
+    registerFreeVariables(clauses);
+    registerFreeVariables(pendingClauses);
 
+    // Incremental call: only the new clauses need work, if any
+    if (incremental && preprocessed && !addPendingClauses()) {
+        return !hasEmptyClause();
+    }
+    preprocessed = true;
+
+    // Pipeline in priority order; equal priorities keep their listed order
+    std::vector<ScheduledTechnique> pipeline = schedule.pipeline;
+    std::stable_sort(pipeline.begin(), pipeline.end(),
+                     [](const ScheduledTechnique& a, const ScheduledTechnique& b) {
+                         return a.priority < b.priority;
+                     });
+    techniqueStats.clear();
+    for (const auto& scheduled : pipeline) {
+        TechniqueStats stats;
+        stats.technique = scheduled.technique;
+        techniqueStats.push_back(stats);
+    }
+    roundsRun = 0;
+    ticks = 0;
+
+    TraceScope traced("preprocess", "preprocess");
+    bool changed;
     do {
-        changed = false;
+        if (hasEmptyClause()) break;  // Formula is UNSAT
+        if (schedule.maxRounds >= 0 && roundsRun >= schedule.maxRounds) break;
 
-        // Check for empty clause (UNSAT indicator)
-        for (const auto& clause : clauses) {
-            if (clause.empty()) {
-                hasEmptyClause = true;
-                break;
+        TraceScope roundTraced("round", "preprocess", "round", ++roundsRun);
+        changed = false;
+        long long literalsBefore = countLiterals();
+
+        for (size_t i = 0; i < pipeline.size(); i++) {
+            TechniqueStats& stats = techniqueStats[i];
+            if (stats.exhausted) continue;
+
+            // The budget covers the whole call: what is left of it
+            long long budget = pipeline[i].tickBudget;
+            long long start = ticks;
+            tickLimit = (budget < 0) ? -1 : start + std::max(0LL, budget - stats.ticks);
+            size_t trailBefore = trail.size();
+            size_t clausesBefore = clauses.size();
+
+            bool techniqueChanged = false;
+            if (pipeline[i].technique == PreprocessTechnique::UNIT_PROPAGATION) {
+                TraceScope step("unit propagation", "preprocess");
+                techniqueChanged = unitPropagate();
+            } else if (pipeline[i].technique == PreprocessTechnique::PURE_LITERALS) {
+                TraceScope step("pure literals", "preprocess");
+                techniqueChanged = pureLiteralElimination();
+            } else {
+                TraceScope step("subsumption", "preprocess");
+                techniqueChanged = subsumption();
             }
+            changed |= techniqueChanged;
+
+            stats.runs++;
+            stats.ticks += ticks - start;
+            stats.assignments += trail.size() - trailBefore;
+            if (clauses.size() < clausesBefore) stats.clausesRemoved += clausesBefore - clauses.size();
+            stats.exhausted = budgetExhausted();
+            if (stats.exhausted) traceInstant("budget exhausted", "preprocess", "technique", i);
         }
-        if (hasEmptyClause) {
-            break;  // Formula is UNSAT
+        tickLimit = -1;
+
+        // Diminishing returns: a round that barely shrinks the formula
+        // suggests the next one will not either
+        long long literalsAfter = countLiterals();
+        if (changed && schedule.minGain > 0 && literalsBefore > 0 &&
+            double(literalsBefore - literalsAfter) / literalsBefore < schedule.minGain) {
+            break;
         }
-
-        // Apply preprocessing techniques
-        changed |= unitPropagate();
-        changed |= pureLiteralElimination();
-
     } while (changed);
 
-    // Return true if no empty clause found
-    // (empty clauses vector = all satisfied = SAT)
-    return clauses.empty() || (!hasEmptyClause && !clauses.empty());
+    // Empty clauses vector = all satisfied = SAT
+    return !hasEmptyClause();
 }
 
 const std::unordered_map<int, bool>& QBFPreprocessor::getAssignments() const {
@@ -13,8 +13,14 @@
  *
  * 2. PURE LITERAL ELIMINATION
  *    If a variable appears only positive (or only negative) in all clauses,
- *    we can assign it the satisfying value.
- *    Example: If x5 only appears as x5 (never as ~x5), set x5=true.
+ *    we can assign it the satisfying value (the falsifying one if FORALL).
+ *    Example: If ∃x5 only appears as x5 (never as ~x5), set x5=true.
+ *
+ * 3. SUBSUMPTION
+ *    A clause that contains all literals of another clause is implied by
+ *    it and can be removed. Example: (x1 ∨ x2) subsumes (x1 ∨ x2 ∨ ~x4).
+ *    This holds for any quantifier prefix: both formulas are true under
+ *    exactly the same assignments.
  *
  * WHY PREPROCESSING MATTERS:
  * - Reduces the search space dramatically
@@ -25,11 +31,67 @@
  * - We must respect the quantifier prefix order
  * - A universal variable can only be eliminated if earlier variables are assigned
  * - Pure literal rules differ slightly for universal vs existential variables
+ *
+ * INCREMENTAL PREPROCESSING:
+ * ==========================
+ * A caller that keeps adding clauses (e.g. to refine a formula step by
+ * step) should not pay for preprocessing from scratch every time. After
+ * enableIncremental(), clauses added after preprocess() wait in a delta
+ * until the next preprocess() call, which only works on that delta:
+ *
+ *   - Unit assignments stay valid: they follow from clauses that are
+ *     still there. New clauses are simplified by the current assignments.
+ *   - Pure literal assignments stay valid unless a new clause contains the
+ *     OPPOSITE literal. Every assignment is recorded on a trail (the
+ *     reconstruction stack); such a clause undoes the trail back to that
+ *     pure step, and the clauses are rebuilt from the original ones.
+ *   - If no new clause became unit or empty, the old fixpoint still
+ *     holds and nothing else is rerun.
+ *
+ * FROZEN variables (freezeVariable) are never eliminated as pure: they
+ * may receive new clauses or be used as assumptions later, so no
+ * elimination ever has to be undone for them.
+ *
+ * SCHEDULING AND BUDGETS:
+ * =======================
+ * Both techniques rescan the clause list, so a round costs roughly
+ * (variables × literals) and the number of rounds is unbounded. On huge
+ * inputs preprocessing could take longer than the search. A schedule
+ * (PreprocessSchedule) keeps it predictable:
+ *
+ *   pipeline   the techniques to run each round, by priority (lowest first)
+ *   budget     effort per technique in TICKS (one tick = one clause or
+ *              literal looked at), summed over the whole preprocess() call;
+ *              a technique that runs out stops where it is (everything it
+ *              did so far is kept) and is skipped from then on
+ *   minGain    stop when a round removes less than this fraction of the
+ *              remaining literals - later rounds are unlikely to pay off
+ *   maxRounds  hard limit on the number of rounds
+ *
+ * Stopping early is always sound: every step already taken is complete,
+ * the solver just gets a less simplified formula.
+ *
+ * PARALLEL PREPROCESSING:
+ * =======================
+ * Pure literal detection and subsumption look at every variable or
+ * clause independently, so on large formulas (setThreads) they split the
+ * clause list into slices, one per thread:
+ *
+ *   - Pure literals: each thread records the polarities in its slice;
+ *     the per-thread tables are OR-ed together.
+ *   - Subsumption: the occurrence lists are shared and read-only; each
+ *     thread checks its clauses with its own literal marks and writes
+ *     only its own clauses' results.
+ *
+ * Results are merged in clause order and subsumption's budget is checked
+ * per fixed-size chunk of clauses, so the outcome does not depend on the
+ * number of threads.
  */
 
 #ifndef QBF_PREPROCESSOR_H
 #define QBF_PREPROCESSOR_H
 
+#include <string>
 #include <vector>
 #include <unordered_map>
 #include <unordered_set>
@@ -85,6 +147,47 @@ struct QuantifierBlock {
  */
 using Clause = std::vector<Literal>;
 
+// Preprocessing techniques that a schedule can run
+enum class PreprocessTechnique {
+    UNIT_PROPAGATION,
+    PURE_LITERALS,
+    SUBSUMPTION
+};
+
+// One technique in the pipeline
+struct ScheduledTechnique {
+    PreprocessTechnique technique;
+    int priority;                  // Lower runs first within a round
+    long long tickBudget;          // Effort for one preprocess() call, -1 = unlimited
+};
+
+struct PreprocessSchedule {
+    std::vector<ScheduledTechnique> pipeline = {
+        {PreprocessTechnique::UNIT_PROPAGATION, 0, 200000000},
+        {PreprocessTechnique::PURE_LITERALS,    1, 200000000},
+        {PreprocessTechnique::SUBSUMPTION,      2, 200000000},
+    };
+    double minGain = 0.005;        // Minimum fraction of literals removed per round
+    int maxRounds = -1;            // -1 = until nothing changes
+};
+
+// What each technique did in the last preprocess() call
+struct TechniqueStats {
+    PreprocessTechnique technique;
+    int runs = 0;
+    long long ticks = 0;
+    long long assignments = 0;
+    long long clausesRemoved = 0;
+    bool exhausted = false;        // Ran out of budget
+};
+
+// "unit propagation", "pure literals", "subsumption"
+const char* techniqueName(PreprocessTechnique technique);
+
+// Parse a technique name for the command line ("unit", "pure" or
+// "subsume"); false if unknown
+bool parseTechnique(const std::string& name, PreprocessTechnique& technique);
+
 /*
  * QBFPreprocessor handles formula storage and preprocessing.
  *
@@ -99,22 +202,70 @@ private:
     std::unordered_map<int, int> varToBlockIndex;         // Quick lookup: var -> block index
     std::unordered_map<int, bool> assignments;            // Current variable assignments
 
+    // Incremental preprocessing (see above)
+    struct TrailStep {
+        int variable;
+        bool value;
+        bool pure;                                  // Pure literal (undoable) or unit
+    };
+    bool incremental = false;
+    bool preprocessed = false;                      // preprocess() has run at least once
+    std::vector<Clause> originalClauses;            // Every clause added (incremental only)
+    std::vector<Clause> pendingClauses;             // Added since the last preprocess()
+    std::vector<TrailStep> trail;                   // Assignments in the order they were made
+    std::unordered_set<int> frozen;
+
+    // Scheduling (see above): ticks count the work done so far
+    PreprocessSchedule schedule;
+    std::vector<TechniqueStats> techniqueStats;
+    int roundsRun = 0;
+    long long ticks = 0;
+    long long tickLimit = -1;                       // Budget of the running technique
+    bool budgetExhausted() const { return tickLimit >= 0 && ticks >= tickLimit; }
+    long long countLiterals() const;
+
+    // Parallel preprocessing (see above)
+    int threads = 1;
+    int slicesFor(size_t numClauses) const;
+    int maxVariable() const;
+
     // Preprocessing helpers
-    bool isPureLiteral(const Literal& lit);
     bool allEarlierVariablesAssigned(int blockIndex) const;
     bool canEliminateVariable(int variable) const;
     bool unitPropagate();
     bool pureLiteralElimination();
+    bool subsumption();
     void simplifyClauses();
+    void assign(int var, bool value, bool pure);
+    void registerFreeVariables(const std::vector<Clause>& newClauses);
+    bool addPendingClauses();
 
 public:
     // Add quantifier blocks and clauses (called by parser)
     void addQuantifierBlock(Quantifier type, const std::vector<int>& variables);
     void addClause(const Clause& clause);
 
-    // Run preprocessing (unit propagation + pure literal elimination)
+    // Run preprocessing (unit propagation, pure literals, subsumption)
     bool preprocess();
 
+    // Techniques, budgets and stopping rules for preprocess()
+    void setSchedule(const PreprocessSchedule& schedule);
+
+    // Threads for pure literal detection and subsumption on large formulas
+    void setThreads(int numThreads);
+
+    // Per-technique effort of the last preprocess() call, in pipeline order
+    const std::vector<TechniqueStats>& getTechniqueStats() const { return techniqueStats; }
+    int getRounds() const { return roundsRun; }
+
+    // Keep original clauses so later preprocess() calls only handle the
+    // clauses added since the previous one (call before adding clauses)
+    void enableIncremental();
+
+    // Never eliminate this variable (it may get new clauses or assumptions)
+    void freezeVariable(int var);
+    bool isFrozen(int var) const;
+
     // Access preprocessed state
     const std::unordered_map<int, bool>& getAssignments() const;
     const std::vector<Clause>& getClauses() const;
@@ -0,0 +1,119 @@
+/*
+ * QBFProfile.cpp - Search-tree statistics per variable and per block
+ */
+
+#include "QBFProfile.h"
+#include <algorithm>
+#include <unordered_set>
+
+void SearchProfile::reset(const QBFPreprocessor& preprocessor) {
+    vars.clear();
+    open.clear();
+    decisionCount = 0;
+
+    const auto& prefix = preprocessor.getQuantifierBlocks();
+    blockStats.assign(prefix.size() + 1, BlockProfile());
+    openPerBlock.assign(prefix.size() + 1, 0);
+    blockStats[0].block = -1;
+
+    for (size_t b = 0; b < prefix.size(); b++) {
+        blockStats[b + 1].block = b;
+        blockStats[b + 1].type = prefix[b].type;
+        for (int var : prefix[b].variables) {
+            VariableProfile& profile = variable(var);
+            profile.variable = var;
+            profile.block = b;
+            profile.type = prefix[b].type;
+            blockStats[b + 1].numVars++;
+        }
+    }
+
+    // Variables in no block are free (outermost EXISTS)
+    for (const auto& clause : preprocessor.getClauses()) {
+        for (const auto& lit : clause) {
+            VariableProfile& profile = variable(lit.variable);
+            if (profile.variable == 0) {
+                profile.variable = lit.variable;
+                blockStats[0].numVars++;
+            }
+        }
+    }
+}
+
+// Profile entry of a variable; unknown variables count as free
+VariableProfile& SearchProfile::variable(int var) {
+    if (var >= (int)vars.size()) vars.resize(var + 1);
+    return vars[var];
+}
+
+BlockProfile& SearchProfile::blockOf(int var) {
+    return blockStats[variable(var).block + 1];
+}
+
+void SearchProfile::enter(int var) {
+    VariableProfile& profile = variable(var);
+    profile.variable = var;
+    profile.decisions++;
+    decisionCount++;
+
+    BlockProfile& block = blockOf(var);
+    block.decisions++;
+    int& openInBlock = openPerBlock[profile.block + 1];
+    open.push_back({var, decisionCount - 1, Clock::now(), openInBlock == 0});
+    openInBlock++;
+}
+
+void SearchProfile::leave() {
+    if (open.empty()) return;
+    Frame frame = open.back();
+    open.pop_back();
+
+    long long subtree = decisionCount - frame.decisionsBefore;
+    double seconds = std::chrono::duration<double>(Clock::now() - frame.start).count();
+
+    VariableProfile& profile = variable(frame.var);
+    profile.subtree += subtree;
+    profile.seconds += seconds;
+
+    openPerBlock[profile.block + 1]--;
+    if (frame.outermostOfBlock) {
+        BlockProfile& block = blockOf(frame.var);
+        block.subtree += subtree;
+        block.seconds += seconds;
+    }
+}
+
+void SearchProfile::finish() {
+    while (!open.empty()) leave();
+}
+
+void SearchProfile::conflict(const std::vector<int>& conflictVars) {
+    std::unordered_set<int> blocksSeen;
+    for (int var : conflictVars) {
+        VariableProfile& profile = variable(var);
+        profile.variable = var;
+        profile.conflicts++;
+        if (blocksSeen.insert(profile.block).second) blockOf(var).conflicts++;
+    }
+}
+
+std::vector<VariableProfile> SearchProfile::topVariables(size_t n) const {
+    std::vector<VariableProfile> decided;
+    for (const auto& profile : vars) {
+        if (profile.decisions > 0) decided.push_back(profile);
+    }
+    std::sort(decided.begin(), decided.end(), [](const VariableProfile& a, const VariableProfile& b) {
+        if (a.subtree != b.subtree) return a.subtree > b.subtree;
+        return a.variable < b.variable;
+    });
+    if (decided.size() > n) decided.resize(n);
+    return decided;
+}
+
+std::vector<BlockProfile> SearchProfile::blocks() const {
+    std::vector<BlockProfile> result;
+    for (const auto& block : blockStats) {
+        if (block.numVars > 0 || block.decisions > 0 || block.conflicts > 0) result.push_back(block);
+    }
+    return result;
+}
@@ -0,0 +1,116 @@
+/*
+ * QBFProfile.h - Search-Tree Statistics per Variable and per Block
+ *
+ * --stats says HOW MUCH work a solve took; the profile says WHERE it went.
+ * For every variable the engines record:
+ *
+ *   decisions   how often the search branched on it
+ *   conflicts   how many conflicts it took part in (it occurs in the
+ *               clause that was falsified)
+ *   subtree     decisions made while its decision was in force, itself
+ *               included - the size of the search tree below it
+ *   time        seconds spent while its decision was in force
+ *
+ * The same numbers are summed per quantifier block. Subtree and time of a
+ * block only count its outermost decisions on each path, so a block's
+ * time is the time spent below its first decision and nested decisions
+ * of the same block are not counted twice.
+ *
+ * A block with a huge subtree compared to its own decisions is the one
+ * that multiplies the search: typically a universal block whose branches
+ * do not share a strategy, or an existential block decided too early.
+ *
+ * Both engines nest their decisions: the recursive search through the
+ * call stack, QCDCL through decision levels (backtracking closes levels
+ * innermost first). enter() and leave() therefore work like a stack.
+ */
+
+#ifndef QBF_PROFILE_H
+#define QBF_PROFILE_H
+
+#include "QBFPreprocessor.h"
+#include <chrono>
+#include <vector>
+
+struct VariableProfile {
+    int variable = 0;
+    int block = -1;                  // Index in the prefix, -1 = free variable
+    Quantifier type = Quantifier::EXISTS;
+    long long decisions = 0;
+    long long conflicts = 0;
+    long long subtree = 0;           // Decisions below, itself included
+    double seconds = 0;              // Time below its decisions
+};
+
+struct BlockProfile {
+    int block = -1;                  // Index in the prefix, -1 = free variables
+    Quantifier type = Quantifier::EXISTS;
+    int numVars = 0;
+    long long decisions = 0;
+    long long conflicts = 0;         // Conflicts with a variable of the block
+    long long subtree = 0;           // Decisions below the block's outermost decisions
+    double seconds = 0;
+};
+
+class SearchProfile {
+public:
+    // Start a new profile for the preprocessor's formula
+    void reset(const QBFPreprocessor& preprocessor);
+
+    // A decision on var opens a subtree; leave() closes the innermost one
+    void enter(int var);
+    void leave();
+
+    // Close every open subtree (end of the search, or a time-out)
+    void finish();
+
+    // A conflict whose falsified clause contains these variables
+    void conflict(const std::vector<int>& vars);
+
+    long long totalDecisions() const { return decisionCount; }
+
+    // The n variables with the largest subtrees (only decided ones)
+    std::vector<VariableProfile> topVariables(size_t n) const;
+
+    // One entry per block in prefix order, free variables first
+    std::vector<BlockProfile> blocks() const;
+
+private:
+    using Clock = std::chrono::steady_clock;
+
+    // One open decision
+    struct Frame {
+        int var;
+        long long decisionsBefore;
+        Clock::time_point start;
+        bool outermostOfBlock;       // No decision of its block above it
+    };
+
+    std::vector<VariableProfile> vars;       // Indexed by variable
+    std::vector<BlockProfile> blockStats;    // Index 0 = free, i+1 = prefix block i
+    std::vector<int> openPerBlock;           // Open decisions per block
+    std::vector<Frame> open;
+    long long decisionCount = 0;
+
+    VariableProfile& variable(int var);
+    BlockProfile& blockOf(int var);
+};
+
+// Closes the decision opened on construction when the scope is left, on
+// whichever return path (the recursive search has many)
+class ProfileScope {
+public:
+    ProfileScope(SearchProfile* profile, int var) : profile(profile) {
+        if (profile) profile->enter(var);
+    }
+    ~ProfileScope() {
+        if (profile) profile->leave();
+    }
+    ProfileScope(const ProfileScope&) = delete;
+    ProfileScope& operator=(const ProfileScope&) = delete;
+
+private:
+    SearchProfile* profile;
+};
+
+#endif // QBF_PROFILE_H
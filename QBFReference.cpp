@@ -0,0 +1,87 @@
+/*
+ * QBFReference.cpp - Brute-force reference evaluator
+ *
+ * Written for obviousness, not speed: no propagation, no caching, and the
+ * full clause list is rescanned at every node.
+ */
+
+#include "QBFReference.h"
+#include <unordered_set>
+#include <vector>
+
+namespace {
+
+struct Evaluator {
+    const std::vector<Clause>& clauses;
+    std::vector<std::pair<int, bool>> order;  // (variable, isUniversal) in prefix order
+    std::vector<signed char> value;           // -1 unassigned, 0 false, 1 true
+
+    // 1 = all clauses satisfied, 0 = some clause falsified, -1 = undecided
+    int status() const {
+        bool allSatisfied = true;
+        for (const auto& clause : clauses) {
+            bool satisfied = false;
+            bool open = false;
+            for (const auto& lit : clause) {
+                int v = value[lit.variable];
+                if (v < 0) {
+                    open = true;
+                } else if ((v == 1) != lit.isNegated) {
+                    satisfied = true;
+                    break;
+                }
+            }
+            if (satisfied) continue;
+            if (!open) return 0;
+            allSatisfied = false;
+        }
+        return allSatisfied ? 1 : -1;
+    }
+
+    bool eval(size_t i) {
+        int s = status();
+        if (s >= 0) return s == 1;
+        // Every variable is in the order, so some clause must have decided
+        if (i == order.size()) return false;
+
+        auto [var, isUniversal] = order[i];
+        bool result = isUniversal;
+        for (int v = 1; v >= 0; v--) {
+            value[var] = v;
+            bool branch = eval(i + 1);
+            if (branch != isUniversal) {  // EXISTS found a win / FORALL a loss
+                result = branch;
+                break;
+            }
+        }
+        value[var] = -1;
+        return result;
+    }
+};
+
+}  // namespace
+
+Result evaluateReference(const QBFFormula& formula) {
+    Evaluator ev{formula.clauses, {}, std::vector<signed char>(formula.maxVariable() + 1, -1)};
+
+    // Free variables first, then the prefix (a variable listed twice counts once)
+    std::unordered_set<int> seen;
+    for (const auto& block : formula.blocks) {
+        seen.insert(block.variables.begin(), block.variables.end());
+    }
+    for (const auto& clause : formula.clauses) {
+        for (const auto& lit : clause) {
+            if (seen.insert(lit.variable).second) ev.order.push_back({lit.variable, false});
+        }
+    }
+    std::unordered_set<int> placed;
+    for (const auto& block : formula.blocks) {
+        for (int var : block.variables) {
+            if (placed.insert(var).second) {
+                ev.order.push_back({var, block.type == Quantifier::FORALL});
+            }
+        }
+    }
+
+    return ev.eval(0) ? Result::SAT : Result::UNSAT;
+}
@@ -0,0 +1,29 @@
+/*
+ * QBFReference.h - Brute-Force Reference Evaluator
+ *
+ * The solvers are full of optimizations (preprocessing, learning, symmetry
+ * breaking, strategy reuse), and every one of them can hide a soundness
+ * bug. The reference evaluator uses none of them: it plays the game
+ * straight from the definition, trying both values of every variable in
+ * prefix order:
+ *
+ *   eval(i):  all clauses satisfied  → true
+ *             some clause falsified  → false
+ *             var i existential      → eval(i+1)[x=1] OR  eval(i+1)[x=0]
+ *             var i universal        → eval(i+1)[x=1] AND eval(i+1)[x=0]
+ *
+ * Variables in no block are outermost existentials (QDIMACS convention).
+ * The cost is up to 2^n clause scans, so it is meant for the small
+ * formulas produced by the fuzzer, not for benchmarks.
+ */
+
+#ifndef QBF_REFERENCE_H
+#define QBF_REFERENCE_H
+
+#include "QDIMACS.h"
+#include "QBFSolver.h"
+
+// Decide the formula by exhaustive game-tree evaluation
+Result evaluateReference(const QBFFormula& formula);
+
+#endif // QBF_REFERENCE_H
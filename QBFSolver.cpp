@@ -65,13 +65,44 @@
 #include <algorithm>
 
 // Constructor - initializes solver state
-QBFSolver::QBFSolver() : verbose(false), depth(0) {}
+QBFSolver::QBFSolver() : reuseStrategies(true), profile(nullptr), timeLimit(0), nodesSinceCheck(0),
+                         timedOut(false), verbose(false), depth(0) {}
 
 // Enable/disable verbose tracing output
 void QBFSolver::setVerbose(bool v) {
     verbose = v;
 }
 
+// Enable/disable reuse of existential strategies across universal siblings
+void QBFSolver::setStrategyReuse(bool enabled) {
+    reuseStrategies = enabled;
+}
+
+// Remember interchangeable universal variables for pruning
+void QBFSolver::setSymmetries(const SymmetryInfo& symmetries) {
+    symmetryPredecessor.clear();
+    for (const auto& group : symmetries.universalGroups) {
+        for (size_t i = 1; i < group.size(); i++) {
+            symmetryPredecessor[group[i]] = group[i - 1];
+        }
+    }
+}
+
+// Report outer-block progress to the callback during the search
+void QBFSolver::setOuterCallback(const OuterCallback& callback) {
+    outerCallback = callback;
+}
+
+// Give up after the given number of seconds (0 = no limit)
+void QBFSolver::setTimeLimit(double seconds) {
+    timeLimit = seconds;
+}
+
+// Collect per-variable search statistics (nullptr = off)
+void QBFSolver::setProfile(SearchProfile* p) {
+    profile = p;
+}
+
 // Create indentation string based on recursion depth
 std::string QBFSolver::indent() const {
     return std::string(depth * 2, ' ');
@@ -95,7 +126,31 @@ Result QBFSolver::solve(const QBFPreprocessor& preprocessor) {
     quantifierBlocks = preprocessor.getQuantifierBlocks();
     clauses = preprocessor.getClauses();
     assignments = preprocessor.getAssignments();
+    phaseHints.clear();
     depth = 0;
+    stats = SolverStats();
+    stats.engine = "search";
+    timedOut = false;
+    nodesSinceCheck = 0;
+    deadline = std::chrono::steady_clock::now() +
+               std::chrono::duration_cast<std::chrono::steady_clock::duration>(
+                   std::chrono::duration<double>(timeLimit));
+
+    // Variables in no block are outermost existentials: give them a block
+    // of their own so the search decides them first
+    std::unordered_set<int> bound;
+    for (const auto& block : quantifierBlocks) {
+        bound.insert(block.variables.begin(), block.variables.end());
+    }
+    QuantifierBlock freeBlock{Quantifier::EXISTS, {}};
+    for (const auto& clause : clauses) {
+        for (const auto& lit : clause) {
+            if (bound.insert(lit.variable).second) freeBlock.variables.push_back(lit.variable);
+        }
+    }
+    if (!freeBlock.variables.empty()) {
+        quantifierBlocks.insert(quantifierBlocks.begin(), freeBlock);
+    }
 
     // Build lookup maps for quick variable info access
     varToQuantifier.clear();
@@ -112,18 +167,96 @@ Result QBFSolver::solve(const QBFPreprocessor& preprocessor) {
                   << quantifierBlocks.size() << " quantifier blocks" << std::endl;
     }
 
+    if (profile) {
+        profile->reset(preprocessor);
+        inputClauses = clauses;
+    }
+
+    outer.reset(preprocessor, outerCallback);
+    preassigned.clear();
+    for (int var : outer.variables()) {
+        if (assignments.count(var)) preassigned.insert(var);
+    }
+
     // Check if preprocessing already determined the result
+    Result result;
     if (clauses.empty()) {
         log("[RESULT] All clauses satisfied by preprocessing");
-        return Result::SAT;
-    }
-    if (hasEmptyClause()) {
+        result = Result::SAT;
+    } else if (hasEmptyClause()) {
         log("[RESULT] Empty clause found - contradiction");
-        return Result::UNSAT;
+        result = Result::UNSAT;
+    } else {
+        // Begin recursive search
+        result = solve_recursive();
     }
 
-    // Begin recursive search
-    return solve_recursive();
+    // A SAT search returns with the winning outer values still assigned
+    outer.finish(result == Result::SAT, result == Result::UNSAT, [this](int var) { return valueOf(var); });
+    if (profile) profile->finish();
+    return result;
+}
+
+// Value of a variable for the outer tracker: 1 true, 0 false, -1 unassigned
+int QBFSolver::valueOf(int var) const {
+    auto it = assignments.find(var);
+    if (it == assignments.end()) return -1;
+    return it->second ? 1 : 0;
+}
+
+/*
+ * Check the time budget. Reading the clock on every node would cost more
+ * than the node itself, so we only look every 256 nodes.
+ */
+bool QBFSolver::timeUp() {
+    if (timedOut) return true;
+    if (timeLimit <= 0 || ++nodesSinceCheck < 256) return false;
+    nodesSinceCheck = 0;
+    timedOut = std::chrono::steady_clock::now() >= deadline;
+    return timedOut;
+}
+
+/*
+ * Can a failed first value of the outer variable var be turned into a
+ * FORCED literal? Outer variables are decided first and in prefix order,
+ * so every outer variable before var is already assigned. If each of them
+ * holds its forced value (or was set by preprocessing), the refuted
+ * subtree contains every winning assignment with var=first - there are
+ * none, so var's other value holds in every winning assignment.
+ */
+bool QBFSolver::outerPrefixForced(int var) const {
+    for (const auto& block : quantifierBlocks) {
+        for (int other : block.variables) {
+            if (other == var) return true;
+            if (!outer.isOuter(other) || preassigned.count(other)) continue;
+            auto it = assignments.find(other);
+            if (it == assignments.end() || !outer.isForced(other, it->second)) return false;
+        }
+    }
+    return true;
+}
+
+/*
+ * Tell the profile which variables a conflict involved. The working
+ * clauses have lost their false literals, so find an input clause that
+ * the current assignment falsifies instead.
+ */
+void QBFSolver::profileConflict() {
+    for (const auto& clause : inputClauses) {
+        bool falsified = true;
+        for (const auto& lit : clause) {
+            if (valueOf(lit.variable) != (lit.isNegated ? 1 : 0)) {
+                falsified = false;
+                break;
+            }
+        }
+        if (falsified) {
+            std::vector<int> vars;
+            for (const auto& lit : clause) vars.push_back(lit.variable);
+            profile->conflict(vars);
+            return;
+        }
+    }
 }
 
 /*
@@ -229,6 +362,60 @@ void QBFSolver::restoreClauses(const std::vector<Clause>& saved) {
     clauses = saved;
 }
 
+/*
+ * Restore assignments to a previous state (for backtracking).
+ *
+ * A successful subtree leaves its existential choices assigned. Before
+ * exploring a sibling branch we must forget them, otherwise the sibling
+ * would treat those variables as already decided.
+ */
+void QBFSolver::restoreAssignments(const std::unordered_map<int, bool>& saved) {
+    assignments = saved;
+}
+
+/*
+ * Pick the value to try first for an existential variable.
+ *
+ * If a sibling universal branch already found a working response for this
+ * variable, try that value first. Otherwise default to true.
+ */
+bool QBFSolver::preferredPhase(int var) {
+    if (reuseStrategies) {
+        auto it = phaseHints.find(var);
+        if (it != phaseHints.end()) {
+            stats.reusedPhases++;
+            return it->second;
+        }
+    }
+    return true;
+}
+
+/*
+ * Remember the existential strategy found below a universal variable.
+ *
+ * Called right after the first branch of a FORALL variable succeeded. The
+ * existential variables assigned in the blocks after it are the responses
+ * that beat the universal player there. Often the same responses (or most
+ * of them) also work for the other value, so we keep them as phase hints:
+ *
+ *   ∀x ∃y1..yn:  x=true succeeded with y = (1,0,1,...)
+ *                x=false tries  y = (1,0,1,...) first
+ */
+void QBFSolver::rememberStrategy(int universalVar) {
+    if (!reuseStrategies) return;
+
+    int blockIndex = varToBlockIndex[universalVar];
+    for (size_t i = blockIndex + 1; i < quantifierBlocks.size(); i++) {
+        if (quantifierBlocks[i].type != Quantifier::EXISTS) continue;
+        for (int var : quantifierBlocks[i].variables) {
+            auto it = assignments.find(var);
+            if (it != assignments.end()) {
+                phaseHints[var] = it->second;
+            }
+        }
+    }
+}
+
 /*
  * CORE ALGORITHM: Recursive DPLL search for QBF.
  *
@@ -236,15 +423,24 @@ void QBFSolver::restoreClauses(const std::vector<Clause>& saved) {
  * with different semantics for existential vs universal variables.
  */
 Result QBFSolver::solve_recursive() {
+    // Out of time: unwind the whole search
+    if (timeUp()) {
+        return Result::UNKNOWN;
+    }
+
     // Base case 1: Empty clause found → contradiction → UNSAT
     if (hasEmptyClause()) {
         log("[CONFLICT] Empty clause - backtracking");
+        stats.conflicts++;
+        if (profile) profileConflict();
         return Result::UNSAT;
     }
 
     // Base case 2: All clauses satisfied → SAT
     if (allClausesSatisfied()) {
         log("[SUCCESS] All clauses satisfied");
+        stats.solutions++;
+        outer.solutionFound([this](int v) { return valueOf(v); });
         return Result::SAT;
     }
 
@@ -260,48 +456,65 @@ Result QBFSolver::solve_recursive() {
     Quantifier qtype = varToQuantifier[var];
     std::string qtypeStr = (qtype == Quantifier::EXISTS) ? "EXISTS" : "FORALL";
 
-    // Save current clause state for backtracking
+    // Save current state for backtracking
     std::vector<Clause> savedClauses = clauses;
+    std::unordered_map<int, bool> savedAssignments = assignments;
 
     depth++;  // Increase indent for verbose output
+    stats.decisions++;
+    ProfileScope profiled(profile, var);  // Closed on every return below
 
     if (qtype == Quantifier::EXISTS) {
         /*
          * EXISTENTIAL VARIABLE: EXISTS player's turn
          *
          * We win (SAT) if we can find ANY value that works.
-         * Try true first, then false if needed.
+         * Try the preferred value first (a remembered strategy, or true),
+         * then the other one if needed.
          */
+        bool first = preferredPhase(var);
+        std::string firstStr = first ? "true" : "false";
+        std::string secondStr = first ? "false" : "true";
+        bool isOuter = outer.active() && outer.isOuter(var);
 
-        // Try true
-        log("[DECIDE] x" + std::to_string(var) + " = true (EXISTS)");
-        assignVariable(var, true);
-        simplifyWithAssignment(var, true);
+        log("[DECIDE] x" + std::to_string(var) + " = " + firstStr + " (EXISTS)");
+        if (isOuter) outer.newAssignment();
+        assignVariable(var, first);
+        simplifyWithAssignment(var, first);
 
         Result result = solve_recursive();
-        if (result == Result::SAT) {
+        if (result != Result::UNSAT) {
             depth--;
-            return Result::SAT;  // Found a working value!
+            return result;  // Found a working value (or ran out of time)
+        }
+
+        // A refuted outer value may prove the other one forced
+        if (isOuter && outerPrefixForced(var)) {
+            log("[OUTER] x" + std::to_string(var) + " = " + secondStr +
+                " is forced in every winning assignment");
+            outer.forcedFound(var, !first);
         }
 
-        // True didn't work - backtrack and try false
-        log("[BACKTRACK] x" + std::to_string(var) + " = true failed, trying false");
-        unassignVariable(var);
+        // First value didn't work - backtrack and try the other one
+        log("[BACKTRACK] x" + std::to_string(var) + " = " + firstStr +
+            " failed, trying " + secondStr);
+        restoreAssignments(savedAssignments);
         restoreClauses(savedClauses);
 
-        log("[DECIDE] x" + std::to_string(var) + " = false (EXISTS)");
-        assignVariable(var, false);
-        simplifyWithAssignment(var, false);
+        log("[DECIDE] x" + std::to_string(var) + " = " + secondStr + " (EXISTS)");
+        if (isOuter) outer.newAssignment();
+        assignVariable(var, !first);
+        simplifyWithAssignment(var, !first);
 
         result = solve_recursive();
-        if (result == Result::SAT) {
+        if (result != Result::UNSAT) {
             depth--;
-            return Result::SAT;  // Found a working value!
+            return result;  // Found a working value (or ran out of time)
         }
 
         // Neither value works - this branch is UNSAT
         log("[FAIL] x" + std::to_string(var) + " - no value works for EXISTS");
-        unassignVariable(var);
+        restoreAssignments(savedAssignments);
         restoreClauses(savedClauses);
         depth--;
         return Result::UNSAT;
@@ -320,18 +533,42 @@ Result QBFSolver::solve_recursive() {
         simplifyWithAssignment(var, true);
 
         Result result = solve_recursive();
+        if (result == Result::UNKNOWN) {
+            depth--;
+            return result;
+        }
         if (result == Result::UNSAT) {
             // FORALL found a falsifying value - formula is UNSAT
             log("[FAIL] x" + std::to_string(var) + " = true fails - FORALL wins");
-            unassignVariable(var);
+            restoreAssignments(savedAssignments);
             restoreClauses(savedClauses);
             depth--;
             return Result::UNSAT;
         }
 
-        // True branch succeeded - now we MUST also check false
+        // Symmetry: if the previous variable of var's group is already true,
+        // var=false is a permutation of a branch with var=true - skip it
+        auto pred = symmetryPredecessor.find(var);
+        if (pred != symmetryPredecessor.end()) {
+            auto predValue = assignments.find(pred->second);
+            if (predValue != assignments.end() && predValue->second) {
+                log("[SYMMETRY] x" + std::to_string(var) + " = false mirrors an explored branch (x" +
+                    std::to_string(pred->second) + " = true)");
+                stats.symmetryPrunes++;
+                depth--;
+                return Result::SAT;
+            }
+        }
+
+        // True branch succeeded - keep its existential responses as hints,
+        // then we MUST also check false starting from a clean state
         log("[PROGRESS] x" + std::to_string(var) + " = true succeeded, must check false");
-        unassignVariable(var);
+        rememberStrategy(var);
+        if (reuseStrategies) {
+            log("[REUSE] Trying the winning responses from x" + std::to_string(var) +
+                " = true first");
+        }
+        restoreAssignments(savedAssignments);
         restoreClauses(savedClauses);
 
         log("[DECIDE] x" + std::to_string(var) + " = false (FORALL - need both)");
@@ -339,10 +576,14 @@ Result QBFSolver::solve_recursive() {
         simplifyWithAssignment(var, false);
 
         result = solve_recursive();
+        if (result == Result::UNKNOWN) {
+            depth--;
+            return result;
+        }
         if (result == Result::UNSAT) {
             // FORALL found a falsifying value - formula is UNSAT
             log("[FAIL] x" + std::to_string(var) + " = false fails - FORALL wins");
-            unassignVariable(var);
+            restoreAssignments(savedAssignments);
             restoreClauses(savedClauses);
             depth--;
             return Result::UNSAT;
@@ -359,3 +600,24 @@ Result QBFSolver::solve_recursive() {
 const std::unordered_map<int, bool>& QBFSolver::getAssignments() const {
     return assignments;
 }
+
+// Get counters from the last solve() call
+const SolverStats& QBFSolver::getStats() const {
+    return stats;
+}
+
+void SolverStats::mergeEngineCounters(const SolverStats& other) {
+    bddPeakNodes = std::max(bddPeakNodes, other.bddPeakNodes);
+    bddReorderings += other.bddReorderings;
+    treeWidth = std::max(treeWidth, other.treeWidth);
+    dpLargestTable = std::max(dpLargestTable, other.dpLargestTable);
+    aigGates += other.aigGates;
+    aigPeakNodes = std::max(aigPeakNodes, other.aigPeakNodes);
+    aigMerges += other.aigMerges;
+    satCalls += other.satCalls;
+    detPropagated += other.detPropagated;
+    detDecided += other.detDecided;
+    resolvedVars += other.resolvedVars;
+    expandedVars += other.expandedVars;
+    elimPeakClauses = std::max(elimPeakClauses, other.elimPeakClauses);
+}
@@ -24,11 +24,64 @@
 #define QBF_SOLVER_H
 
 #include "QBFPreprocessor.h"
+#include "QBFSymmetry.h"
+#include "QBFOuter.h"
+#include "QBFProfile.h"
+#include <chrono>
 #include <unordered_map>
+#include <unordered_set>
 #include <string>
 
-// Result of solving: SAT (true), UNSAT (false), or still working
-enum class Result { SAT, UNSAT };
+// Result of solving: SAT (true), UNSAT (false), or UNKNOWN (time limit hit)
+enum class Result { SAT, UNSAT, UNKNOWN };
+
+/*
+ * Counters collected while solving (printed with --stats).
+ *
+ * Every engine fills in the fields that make sense for it; the others
+ * simply stay zero.
+ */
+struct SolverStats {
+    std::string engine;              // Engine that produced the result
+    std::string engineReason;        // Why the engine was chosen
+    std::string preprocessReason;    // Why the preprocessing schedule was chosen
+    long long decisions = 0;         // Branching decisions
+    long long propagations = 0;      // Implied assignments
+    long long conflicts = 0;         // Branches ending in an empty clause
+    long long solutions = 0;         // Branches satisfying all clauses
+    long long learnedClauses = 0;    // Clauses learned from conflicts
+    long long learnedCubes = 0;      // Cubes learned from solutions
+    long long minimizedLits = 0;     // Literals removed from learned constraints
+    long long longDistance = 0;      // Resolution steps that merged literals
+    long long restarts = 0;
+    long long reusedPhases = 0;      // Decisions that followed a sibling's strategy
+    long long symmetryPrunes = 0;    // Universal branches skipped as symmetric
+    int workers = 1;                 // Portfolio workers (QBFPortfolio.h)
+    long long imported = 0;          // Constraints received from other workers
+    long long gates = 0;             // Gate definitions used by dual propagation
+    long long dualSolutions = 0;     // Solutions seen before every clause was satisfied
+    long long dependencies = 0;      // Dependencies learned (QCDCL --dep-learning)
+    long long prefixDependencies = 0; // ... out of the prefix order's
+    long long dependencyFallbacks = 0; // Switches back to the prefix order
+    long long bddPeakNodes = 0;      // Most BDD nodes in use at once (BDDSolver.h)
+    long long bddReorderings = 0;    // Dynamic variable reorderings
+    int treeWidth = 0;               // Width of the tree decomposition (TreeDPSolver.h)
+    long long dpLargestTable = 0;    // Entries of the largest joined table
+    long long aigGates = 0;          // Gate definitions substituted (AIGSolver.h)
+    long long aigPeakNodes = 0;      // Most AIG nodes live at once
+    long long aigMerges = 0;         // Nodes merged by SAT sweeping
+    long long satCalls = 0;          // SAT checks (IncDetSolver.h)
+    long long detPropagated = 0;     // Existentials found deterministic
+    long long detDecided = 0;        // Existentials decided where not forced
+    long long resolvedVars = 0;      // EXISTS variables resolved away (ExpansionSolver.h)
+    long long expandedVars = 0;      // FORALL variables expanded
+    long long elimPeakClauses = 0;   // Most clauses at once
+
+    // Take over the counters of an engine that gave up (BDD, tree DP, AIG,
+    // determinization, expansion), so the stats of the engine that
+    // answered still show how far it got. Peaks take the maximum.
+    void mergeEngineCounters(const SolverStats& other);
+};
 
 class QBFSolver {
 private:
@@ -37,6 +90,35 @@ private:
     std::vector<Clause> clauses;
     std::unordered_map<int, bool> assignments;
 
+    // Existential strategy remembered from sibling universal branches.
+    // When a FORALL variable's first branch succeeds, the existential
+    // responses found there become the preferred phases for the second
+    // branch, so the solver retries the strategy that already worked.
+    std::unordered_map<int, bool> phaseHints;
+    bool reuseStrategies;
+
+    // Interchangeable universal variables: var -> previous variable of its
+    // group. If the previous one is true, var=false is a symmetric branch.
+    std::unordered_map<int, int> symmetryPredecessor;
+
+    SolverStats stats;
+
+    // Anytime reports about the outermost EXISTS block (see QBFOuter.h)
+    OuterCallback outerCallback;
+    OuterTracker outer;
+    std::unordered_set<int> preassigned;  // Outer variables set by preprocessing
+
+    // Per-variable search statistics (nullptr = not collected). Conflicts
+    // are traced back to the falsified clause of the search's input.
+    SearchProfile* profile;
+    std::vector<Clause> inputClauses;
+
+    // Time budget: checked every few hundred nodes, 0 = unlimited
+    double timeLimit;
+    std::chrono::steady_clock::time_point deadline;
+    long long nodesSinceCheck;
+    bool timedOut;
+
     // Maps for quick lookup
     std::unordered_map<int, Quantifier> varToQuantifier;
     std::unordered_map<int, int> varToBlockIndex;
@@ -56,6 +138,13 @@ private:
     bool allClausesSatisfied() const;
     void simplifyWithAssignment(int var, bool value);
     void restoreClauses(const std::vector<Clause>& saved);
+    void restoreAssignments(const std::unordered_map<int, bool>& saved);
+    bool preferredPhase(int var);
+    void rememberStrategy(int universalVar);
+    bool timeUp();
+    bool outerPrefixForced(int var) const;
+    int valueOf(int var) const;
+    void profileConflict();
 
     // Verbose output helpers
     void log(const std::string& msg) const;
@@ -70,8 +159,26 @@ public:
     // Enable verbose mode for step-by-step tracing
     void setVerbose(bool v);
 
+    // Enable/disable reuse of existential strategies across universal siblings
+    void setStrategyReuse(bool enabled);
+
+    // Prune FORALL branches that are symmetric to explored ones
+    void setSymmetries(const SymmetryInfo& symmetries);
+
+    // Report outer-block candidates and forced literals during the search
+    void setOuterCallback(const OuterCallback& callback);
+
+    // Give up with Result::UNKNOWN after this many seconds (0 = no limit)
+    void setTimeLimit(double seconds);
+
+    // Collect per-variable statistics into profile (nullptr = off)
+    void setProfile(SearchProfile* profile);
+
     // Get final assignments (for SAT results)
     const std::unordered_map<int, bool>& getAssignments() const;
+
+    // Counters from the last solve() call
+    const SolverStats& getStats() const;
 };
 
 #endif // QBF_SOLVER_H
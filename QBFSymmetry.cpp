@@ -0,0 +1,151 @@
+/*
+ * QBFSymmetry.cpp - Detection of interchangeable variables
+ *
+ * Example: ∀u1,u2,u3 ∃e with clauses
+ *
+ *     (¬u1 ∨ ¬u2 ∨ e) (¬u1 ∨ ¬u3 ∨ e) (¬u2 ∨ ¬u3 ∨ e)
+ *
+ * Swapping any two of u1,u2,u3 gives the same three clauses, so the group
+ * {u1, u2, u3} is interchangeable and only the 4 sorted moves
+ * 000, 001, 011, 111 of FORALL need to be explored instead of all 8.
+ */
+
+#include "QBFSymmetry.h"
+#include <algorithm>
+#include <cstdlib>
+#include <map>
+#include <unordered_map>
+#include <unordered_set>
+
+int SymmetryInfo::numBreakingConstraints() const {
+    int count = 0;
+    for (const auto& group : existentialGroups) count += group.size() - 1;
+    for (const auto& group : universalGroups) count += group.size() - 1;
+    return count;
+}
+
+// A clause as sorted signed integers (x3 = 3, ¬x3 = -3), duplicates removed
+static std::vector<int> normalize(std::vector<int> lits) {
+    std::sort(lits.begin(), lits.end());
+    lits.erase(std::unique(lits.begin(), lits.end()), lits.end());
+    return lits;
+}
+
+/*
+ * Exact check: does swapping x and y map the clause set onto itself?
+ * Only clauses containing x or y can change, so compare just those.
+ */
+static bool isSwapSymmetry(int x, int y,
+                           const std::vector<std::vector<int>>& clauses,
+                           const std::unordered_map<int, std::vector<int>>& occ) {
+    std::vector<int> affected = occ.at(x);
+    affected.insert(affected.end(), occ.at(y).begin(), occ.at(y).end());
+    std::sort(affected.begin(), affected.end());
+    affected.erase(std::unique(affected.begin(), affected.end()), affected.end());
+
+    std::vector<std::vector<int>> before, after;
+    for (int c : affected) {
+        before.push_back(clauses[c]);
+        std::vector<int> swapped;
+        for (int lit : clauses[c]) {
+            int var = std::abs(lit);
+            int image = (var == x) ? y : (var == y) ? x : var;
+            swapped.push_back(lit < 0 ? -image : image);
+        }
+        after.push_back(normalize(swapped));
+    }
+    std::sort(before.begin(), before.end());
+    std::sort(after.begin(), after.end());
+    return before == after;
+}
+
+SymmetryInfo detectSymmetries(const QBFPreprocessor& preprocessor, long long maxChecks) {
+    SymmetryInfo info;
+
+    // Normalized clauses and occurrence lists
+    std::vector<std::vector<int>> clauses;
+    std::unordered_map<int, std::vector<int>> occ;
+    for (const auto& clause : preprocessor.getClauses()) {
+        std::vector<int> lits;
+        for (const auto& lit : clause) {
+            lits.push_back(lit.isNegated ? -lit.variable : lit.variable);
+        }
+        clauses.push_back(normalize(lits));
+        for (int lit : clauses.back()) {
+            auto& list = occ[std::abs(lit)];
+            if (list.empty() || list.back() != (int)clauses.size() - 1) {
+                list.push_back(clauses.size() - 1);
+            }
+        }
+    }
+
+    for (const auto& block : preprocessor.getQuantifierBlocks()) {
+        /*
+         * Signature: clause lengths of the positive occurrences, a
+         * separator, then those of the negative occurrences. Only
+         * variables with equal signatures can be interchangeable.
+         */
+        std::map<std::vector<int>, std::vector<int>> classes;
+        for (int var : block.variables) {
+            auto it = occ.find(var);
+            if (it == occ.end()) continue;  // Assigned or not occurring
+
+            std::vector<int> pos, neg;
+            for (int c : it->second) {
+                bool positive = std::binary_search(clauses[c].begin(), clauses[c].end(), var);
+                (positive ? pos : neg).push_back(clauses[c].size());
+            }
+            std::sort(pos.begin(), pos.end());
+            std::sort(neg.begin(), neg.end());
+            pos.push_back(-1);
+            pos.insert(pos.end(), neg.begin(), neg.end());
+            classes[pos].push_back(var);
+        }
+
+        // Within each class, attach every variable to the first group whose
+        // representative it can be swapped with
+        std::unordered_map<int, int> position;
+        for (size_t i = 0; i < block.variables.size(); i++) position[block.variables[i]] = i;
+
+        for (const auto& [signature, vars] : classes) {
+            std::vector<std::vector<int>> groups;
+            for (int var : vars) {
+                bool placed = false;
+                for (auto& group : groups) {
+                    if (info.swapChecks >= maxChecks) break;
+                    info.swapChecks++;
+                    if (isSwapSymmetry(group[0], var, clauses, occ)) {
+                        group.push_back(var);
+                        placed = true;
+                        break;
+                    }
+                }
+                if (!placed) groups.push_back({var});
+            }
+
+            for (auto& group : groups) {
+                if (group.size() < 2) continue;
+                std::sort(group.begin(), group.end(),
+                          [&](int a, int b) { return position[a] < position[b]; });
+                if (block.type == Quantifier::EXISTS) {
+                    info.existentialGroups.push_back(group);
+                } else {
+                    info.universalGroups.push_back(group);
+                }
+            }
+        }
+    }
+
+    return info;
+}
+
+/*
+ * For each EXISTS group v1..vk add (¬vi ∨ vi+1), i.e. vi <= vi+1.
+ */
+void addSymmetryBreakingClauses(QBFPreprocessor& preprocessor, const SymmetryInfo& symmetries) {
+    for (const auto& group : symmetries.existentialGroups) {
+        for (size_t i = 0; i + 1 < group.size(); i++) {
+            preprocessor.addClause({Literal(group[i], true), Literal(group[i + 1], false)});
+        }
+    }
+}
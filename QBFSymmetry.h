@@ -0,0 +1,59 @@
+/*
+ * QBFSymmetry.h - Symmetry Detection and Symmetry Breaking
+ *
+ * Many encodings contain INTERCHANGEABLE variables: swapping x and y maps
+ * the clause set onto itself. The search then explores isomorphic subtrees
+ * ("x=1,y=0" and "x=0,y=1" lead to identical remaining formulas).
+ *
+ * DETECTION:
+ *   Variables of the same quantifier block are grouped by a cheap
+ *   signature (occurrence counts and clause lengths per polarity). Within
+ *   a group, each candidate swap (x y) is checked exactly: only clauses
+ *   containing x or y can change, so we compare those clauses before and
+ *   after the swap. Swaps chain together: if (a b) and (a c) are
+ *   symmetries, every permutation of {a, b, c} is one.
+ *
+ * BREAKING (QBF-sound, per block):
+ *   For a group v1, v2, ..., vk of interchangeable variables we only need
+ *   to consider SORTED assignments (v1 <= v2 <= ... <= vk): every other
+ *   assignment is a permutation of a sorted one with the same remaining
+ *   formula.
+ *
+ *   EXISTS group: add clauses (¬vi ∨ vi+1). EXISTS can always permute a
+ *                 winning choice into a sorted one.
+ *   FORALL group: FORALL can always permute its move into a sorted one,
+ *                 so unsorted moves need not be explored. This is added
+ *                 as cubes (vi ∧ ¬vi+1) for QCDCL ("EXISTS wins there") and
+ *                 used directly for pruning in the recursive search.
+ *
+ *   Both rules only touch variables of one block, so the groups of
+ *   different blocks can be broken independently.
+ */
+
+#ifndef QBF_SYMMETRY_H
+#define QBF_SYMMETRY_H
+
+#include "QBFPreprocessor.h"
+#include <vector>
+
+/*
+ * Groups of interchangeable variables. Each group lies in one quantifier
+ * block and is listed in block order (the order the search decides them).
+ */
+struct SymmetryInfo {
+    std::vector<std::vector<int>> existentialGroups;
+    std::vector<std::vector<int>> universalGroups;
+    long long swapChecks = 0;   // Exact swap checks performed
+
+    // Number of breaking clauses/cubes the groups give rise to
+    int numBreakingConstraints() const;
+};
+
+// Find interchangeable variables in the preprocessor's current formula.
+// At most maxChecks candidate swaps are verified.
+SymmetryInfo detectSymmetries(const QBFPreprocessor& preprocessor, long long maxChecks = 100000);
+
+// Add the symmetry-breaking clauses for existential groups
+void addSymmetryBreakingClauses(QBFPreprocessor& preprocessor, const SymmetryInfo& symmetries);
+
+#endif // QBF_SYMMETRY_H
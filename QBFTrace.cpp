@@ -0,0 +1,146 @@
+/*
+ * QBFTrace.cpp - Per-thread event buffers and the Chrome trace writer
+ */
+
+#include "QBFTrace.h"
+#include <atomic>
+#include <fstream>
+#include <iomanip>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <vector>
+
+namespace {
+
+using Clock = std::chrono::steady_clock;
+
+struct TraceEvent {
+    const char* name;
+    const char* category;
+    char phase;                 // 'X' = span, 'i' = instant
+    Clock::time_point start;
+    Clock::time_point end;
+    const char* argName;        // nullptr = no argument
+    long long argValue;
+};
+
+// Events of one thread; only that thread appends to it
+struct ThreadBuffer {
+    std::string name;
+    std::vector<TraceEvent> events;
+};
+
+std::atomic<bool> recording{false};
+Clock::time_point origin;
+
+// Every buffer ever created; they outlive their threads until written
+std::mutex registryMutex;
+std::vector<std::unique_ptr<ThreadBuffer>> registry;
+
+thread_local ThreadBuffer* localBuffer = nullptr;
+
+// The calling thread's buffer (registering it costs one lock, once)
+ThreadBuffer& buffer() {
+    if (!localBuffer) {
+        std::lock_guard<std::mutex> lock(registryMutex);
+        registry.push_back(std::make_unique<ThreadBuffer>());
+        localBuffer = registry.back().get();
+        localBuffer->name = (registry.size() == 1) ? "main" : "thread " + std::to_string(registry.size());
+        localBuffer->events.reserve(1024);
+    }
+    return *localBuffer;
+}
+
+void writeString(std::ostream& out, const std::string& s) {
+    out << '"';
+    for (char c : s) {
+        if (c == '"' || c == '\\') out << '\\';
+        out << c;
+    }
+    out << '"';
+}
+
+// Microseconds since the start of the trace
+double micros(Clock::time_point t) {
+    return std::chrono::duration<double, std::micro>(t - origin).count();
+}
+
+}  // namespace
+
+void traceStart() {
+    if (recording.exchange(true)) return;
+    origin = Clock::now();
+    buffer();  // The starting thread becomes "main"
+}
+
+bool traceEnabled() {
+    return recording.load(std::memory_order_relaxed);
+}
+
+void traceThreadName(const std::string& name) {
+    if (traceEnabled()) buffer().name = name;
+}
+
+void traceSpan(const char* name, const char* category, Clock::time_point start, Clock::time_point end,
+               const char* argName, long long argValue) {
+    if (!traceEnabled()) return;
+    buffer().events.push_back({name, category, 'X', start, end, argName, argValue});
+}
+
+void traceInstant(const char* name, const char* category, const char* argName, long long argValue) {
+    if (!traceEnabled()) return;
+    Clock::time_point now = Clock::now();
+    buffer().events.push_back({name, category, 'i', now, now, argName, argValue});
+}
+
+bool traceWrite(const std::string& filename) {
+    std::ofstream out(filename);
+    if (!out) return false;
+
+    std::lock_guard<std::mutex> lock(registryMutex);
+    out << std::fixed << std::setprecision(3);
+    out << "{\"displayTimeUnit\":\"ms\",\"traceEvents\":[\n";
+    bool first = true;
+    auto separator = [&]() {
+        if (!first) out << ",\n";
+        first = false;
+    };
+
+    // Threads with the same name share a timeline row: short-lived workers
+    // started for each batch of work then show up as one row per slot
+    std::map<std::string, int> tids;
+    for (const auto& thread : registry) {
+        if (tids.count(thread->name)) continue;
+        int tid = tids.size() + 1;
+        tids[thread->name] = tid;
+        separator();
+        out << "{\"name\":\"thread_name\",\"ph\":\"M\",\"pid\":1,\"tid\":" << tid
+            << ",\"args\":{\"name\":";
+        writeString(out, thread->name);
+        out << "}}";
+    }
+
+    for (const auto& thread : registry) {
+        int tid = tids[thread->name];
+        for (const auto& e : thread->events) {
+            separator();
+            out << "{\"name\":";
+            writeString(out, e.name);
+            out << ",\"cat\":";
+            writeString(out, e.category);
+            out << ",\"ph\":\"" << e.phase << "\",\"pid\":1,\"tid\":" << tid
+                << ",\"ts\":" << micros(e.start);
+            if (e.phase == 'X') out << ",\"dur\":" << micros(e.end) - micros(e.start);
+            if (e.phase == 'i') out << ",\"s\":\"t\"";
+            if (e.argName) {
+                out << ",\"args\":{";
+                writeString(out, e.argName);
+                out << ":" << e.argValue << "}";
+            }
+            out << "}";
+        }
+    }
+    out << "\n]}\n";
+    return static_cast<bool>(out);
+}
@@ -0,0 +1,82 @@
+/*
+ * QBFTrace.h - Timeline of Solver Phases in Chrome Trace-Event Format
+ *
+ * Counters (--stats) and the profile (--profile) add time up; a timeline
+ * shows WHEN things happened: how long each preprocessing iteration took,
+ * how restarts and database reductions are spaced during the search, and
+ * which worker thread was busy when. With --trace-out=FILE the solver
+ * writes such a timeline as JSON that chrome://tracing and
+ * https://ui.perfetto.dev open directly.
+ *
+ * TWO KINDS OF EVENTS:
+ *
+ *   TraceScope scope("search", "solve");   a span: recorded when the scope
+ *                                          ends, with its start and length
+ *   traceInstant("restart", "qcdcl");      a point in time
+ *
+ * Names and categories must be string literals (only the pointer is
+ * stored). A span or instant may carry one named integer argument, e.g.
+ * the iteration number of a preprocessing round.
+ *
+ * LOW OVERHEAD:
+ * =============
+ * While tracing is off, a TraceScope costs one atomic flag check. While
+ * it is on, events are appended to a buffer owned by the recording thread,
+ * so threads never contend on a lock; the buffers are merged only when the
+ * file is written. Write the file after all worker threads have finished.
+ */
+
+#ifndef QBF_TRACE_H
+#define QBF_TRACE_H
+
+#include <chrono>
+#include <string>
+
+// Start recording (time 0 of the timeline is the first call)
+void traceStart();
+
+// Is recording on?
+bool traceEnabled();
+
+// Record a span that has already ended (TraceScope does this for you)
+void traceSpan(const char* name, const char* category,
+               std::chrono::steady_clock::time_point start, std::chrono::steady_clock::time_point end,
+               const char* argName = nullptr, long long argValue = 0);
+
+// Name the calling thread in the timeline (e.g. "main", "worker 3")
+void traceThreadName(const std::string& name);
+
+// Record a point event
+void traceInstant(const char* name, const char* category,
+                  const char* argName = nullptr, long long argValue = 0);
+
+// Write all recorded events as Chrome trace JSON; false if the file
+// cannot be written
+bool traceWrite(const std::string& filename);
+
+// Records a span from construction to destruction
+class TraceScope {
+public:
+    TraceScope(const char* name, const char* category,
+               const char* argName = nullptr, long long argValue = 0)
+        : name(name), category(category), argName(argName), argValue(argValue), active(traceEnabled()) {
+        if (active) start = std::chrono::steady_clock::now();
+    }
+    ~TraceScope() {
+        if (active) {
+            traceSpan(name, category, start, std::chrono::steady_clock::now(), argName, argValue);
+        }
+    }
+    TraceScope(const TraceScope&) = delete;
+    TraceScope& operator=(const TraceScope&) = delete;
+
+private:
+    const char* name;
+    const char* category;
+    const char* argName;
+    long long argValue;
+    bool active;
+    std::chrono::steady_clock::time_point start;
+};
+
+#endif // QBF_TRACE_H
@@ -0,0 +1,1763 @@
+/*
+ * QCDCLSolver.cpp - Implementation of the QCDCL engine
+ *
+ * ALGORITHM OVERVIEW:
+ * ===================
+ *
+ *   loop:
+ *     propagate()                          // unit clauses and unit cubes
+ *     if CONFLICT:
+ *       if at decision level 0: return UNSAT
+ *       learn a clause by Q-resolution, backjump, assert it
+ *     else if SOLUTION:
+ *       if at decision level 0: return SAT
+ *       learn a cube by term resolution, backjump, assert it
+ *     else:
+ *       decide the next variable (outermost quantifier level first,
+ *       or any variable whose learned dependencies are assigned)
+ *
+ * LEARNING A CLAUSE (conflict analysis):
+ * ======================================
+ *
+ *   Start from the falsified clause. While it is not "asserting", resolve
+ *   it with the clause that implied its most recently assigned existential
+ *   literal, then apply universal reduction. A clause is asserting when
+ *   exactly one existential literal sits at its highest decision level:
+ *   after backjumping below that level the clause becomes unit and forces
+ *   the opposite value.
+ *
+ *   Example:  ∃x ∀u ∃y   clauses (x ∨ y) (x ∨ ¬y)
+ *
+ *     decide x=false  →  (x ∨ y) implies y=true  →  (x ∨ ¬y) is falsified
+ *     resolve (x ∨ ¬y) with (x ∨ y) on y  →  learn (x)
+ *     (x) is asserting: backjump to level 0 and set x=true
+ *
+ *   Resolving two clauses that contain u and ¬u would give a tautology,
+ *   which ordinary Q-resolution forbids. If u is quantified after the
+ *   pivot, LONG-DISTANCE resolution keeps a merged literal u* instead
+ *   (see analyze). Otherwise we fall back to the "decision clause": the
+ *   negation of all decisions made so far, which is always a valid (if
+ *   weaker) lesson.
+ *
+ * LEARNING A CUBE (solution analysis):
+ * ====================================
+ *
+ *   Exactly the dual: start from a set of true literals that satisfies
+ *   every clause, resolve on universal literals, apply existential
+ *   reduction, and stop when one universal literal sits alone at the
+ *   highest decision level. FORALL is then forced to flip it.
+ */
+
+#include "QCDCLSolver.h"
+#include "QBFPortfolio.h"
+#include "QBFTrace.h"
+#include <algorithm>
+#include <chrono>
+#include <climits>
+#include <iostream>
+
+// Recursion depth limit of the redundancy check during minimization
+static const int MINIMIZE_MAX_DEPTH = 64;
+
+// Constructor - initializes solver state
+QCDCLSolver::QCDCLSolver() : numVars(0), qhead(0), numOriginal(0), numSymmetryCubes(0),
+                             rescanPending(false), numSatisfied(0), dual(false),
+                             numRest(0), numSatisfiedRest(0), numOpenDefs(0),
+                             depRequested(false), depLearning(false),
+                             varInc(1.0), constraintInc(1.0), maxLearned(2000),
+                             forcedScanned(0), timeLimit(0), profile(nullptr),
+                             sharing(nullptr), workerId(0), restartUnit(64), verbose(false) {}
+
+// Enable/disable verbose tracing output
+void QCDCLSolver::setVerbose(bool v) {
+    verbose = v;
+}
+
+// Remember interchangeable universal variables (see QBFSymmetry.h)
+void QCDCLSolver::setSymmetries(const SymmetryInfo& symmetries) {
+    universalSymmetries = symmetries.universalGroups;
+}
+
+// Report outer-block progress to the callback during the search
+void QCDCLSolver::setOuterCallback(const OuterCallback& callback) {
+    outerCallback = callback;
+}
+
+// Give up after the given number of seconds (0 = no limit)
+void QCDCLSolver::setTimeLimit(double seconds) {
+    timeLimit = seconds;
+}
+
+// Collect per-variable search statistics (nullptr = off)
+void QCDCLSolver::setProfile(SearchProfile* p) {
+    profile = p;
+}
+
+// Watch gate definitions for early solutions (see QCDCLSolver.h)
+void QCDCLSolver::setDualPropagation(bool enabled) {
+    dual = enabled;
+}
+
+// Learn dependencies instead of following the prefix (see QCDCLSolver.h)
+void QCDCLSolver::setDependencyLearning(bool enabled) {
+    depRequested = enabled;
+}
+
+// Exchange learned constraints with other portfolio workers
+void QCDCLSolver::setSharing(ConstraintSharing* s, int worker) {
+    sharing = s;
+    workerId = worker;
+}
+
+// Log a message if verbose mode is enabled
+void QCDCLSolver::log(const std::string& msg) const {
+    if (verbose) {
+        std::cout << std::string(decisionLevel() * 2, ' ') << msg << std::endl;
+    }
+}
+
+// Format a literal as "x3" or "¬x3"
+std::string QCDCLSolver::litToString(int lit) const {
+    return std::string(litNegated(lit) ? "\302\254" : "") + "x" + std::to_string(litVar(lit));
+}
+
+// Format a clause as "(x1 ∨ ¬x2)" or a cube as "[x1 ∧ ¬x2]"; merged
+// variables are shown as "x3*"
+std::string QCDCLSolver::constraintToString(const std::vector<int>& lits, bool isCube,
+                                            const std::vector<int>& merged) const {
+    std::string s = isCube ? "[" : "(";
+    for (size_t i = 0; i < lits.size() + merged.size(); i++) {
+        if (i > 0) s += isCube ? " \342\210\247 " : " \342\210\250 ";
+        s += i < lits.size() ? litToString(lits[i]) : "x" + std::to_string(merged[i - lits.size()]) + "*";
+    }
+    return s + (isCube ? "]" : ")");
+}
+
+// ============================================================================
+// Setup
+// ============================================================================
+
+void QCDCLSolver::reset() {
+    numVars = 0;
+    value.clear();
+    level.clear();
+    reason.clear();
+    trailPos.clear();
+    qlevel.clear();
+    universal.clear();
+    activity.clear();
+    savedPhase.clear();
+    levelVars.clear();
+    levelUnassigned.clear();
+    trail.clear();
+    trailLim.clear();
+    qhead = 0;
+    constraints.clear();
+    clauseOcc.clear();
+    cubeOcc.clear();
+    numOriginal = 0;
+    numSymmetryCubes = 0;
+    rescanPending = false;
+    satCount.clear();
+    numSatisfied = 0;
+    gateOf.clear();
+    gateDefs.clear();
+    numRest = 0;
+    numSatisfiedRest = 0;
+    numOpenDefs = 0;
+    depLearning = depRequested;
+    dependencies.clear();
+    varInc = 1.0;
+    constraintInc = 1.0;
+    maxLearned = 2000;
+    outerVar.clear();
+    forcedScanned = 0;
+    winningLits.clear();
+    assignments.clear();
+    stats = SolverStats();
+}
+
+/*
+ * Compute quantifier levels for the variables left after preprocessing.
+ *
+ * Blocks are merged when they have the same quantifier once empty blocks
+ * are skipped (∃a ∀b ∃c with b fully assigned is just ∃a,c). Variables that
+ * occur in clauses but in no block are treated as outermost existentials,
+ * as the QDIMACS standard prescribes.
+ */
+void QCDCLSolver::buildLevels(const QBFPreprocessor& preprocessor,
+                              const std::vector<Clause>& clauses) {
+    const auto& blocks = preprocessor.getQuantifierBlocks();
+
+    for (const auto& block : blocks) {
+        for (int var : block.variables) numVars = std::max(numVars, var);
+    }
+    for (const auto& clause : clauses) {
+        for (const auto& lit : clause) numVars = std::max(numVars, lit.variable);
+    }
+
+    value.assign(numVars + 1, -1);
+    level.assign(numVars + 1, 0);
+    reason.assign(numVars + 1, -1);
+    trailPos.assign(numVars + 1, 0);
+    qlevel.assign(numVars + 1, -1);
+    universal.assign(numVars + 1, false);
+    activity.assign(numVars + 1, 0.0);
+    savedPhase.assign(numVars + 1, false);
+    clauseOcc.assign(2 * numVars + 2, {});
+    cubeOcc.assign(2 * numVars + 2, {});
+    gateDefs.assign(numVars + 1, {});
+    dependencies.assign(numVars + 1, {});
+
+    std::vector<bool> occurs(numVars + 1, false);
+    std::vector<int> polarity(numVars + 1, 0);  // #positive - #negative occurrences
+    for (const auto& clause : clauses) {
+        for (const auto& lit : clause) {
+            occurs[lit.variable] = true;
+            polarity[lit.variable] += lit.isNegated ? -1 : 1;
+        }
+    }
+
+    std::vector<Quantifier> levelType;
+    auto addVar = [&](int var, Quantifier q) {
+        if (levelType.empty() || levelType.back() != q) {
+            levelType.push_back(q);
+            levelVars.push_back({});
+        }
+        qlevel[var] = levelType.size() - 1;
+        universal[var] = (q == Quantifier::FORALL);
+        levelVars.back().push_back(var);
+    };
+
+    // Free variables first (outermost existentials)
+    std::vector<bool> inBlock(numVars + 1, false);
+    for (const auto& block : blocks) {
+        for (int var : block.variables) inBlock[var] = true;
+    }
+    for (int var = 1; var <= numVars; var++) {
+        if (occurs[var] && !inBlock[var]) addVar(var, Quantifier::EXISTS);
+    }
+
+    for (const auto& block : blocks) {
+        for (int var : block.variables) {
+            if (occurs[var] && qlevel[var] < 0) addVar(var, block.type);
+        }
+    }
+
+    levelUnassigned.resize(levelVars.size());
+    for (size_t i = 0; i < levelVars.size(); i++) {
+        levelUnassigned[i] = levelVars[i].size();
+    }
+
+    // Initial phases: EXISTS picks the value satisfying more clauses,
+    // FORALL the value falsifying more clauses
+    for (int var = 1; var <= numVars; var++) {
+        bool satisfiesMore = polarity[var] >= 0;
+        savedPhase[var] = universal[var] ? !satisfiesMore : satisfiesMore;
+    }
+}
+
+/*
+ * Add a clause or cube to the database and index its literals.
+ * Original clauses must be added before any learned constraint.
+ */
+int QCDCLSolver::addConstraint(const std::vector<int>& lits, bool isCube, bool learned) {
+    int index = constraints.size();
+    constraints.push_back({lits, isCube, learned, 0, 0.0, {}});
+    for (int lit : lits) {
+        (isCube ? cubeOcc : clauseOcc)[lit].push_back(index);
+    }
+    if (!learned) {
+        satCount.push_back(0);
+    }
+    return index;
+}
+
+// ============================================================================
+// Assignment and Backtracking
+// ============================================================================
+
+/*
+ * Value of a literal: 1 = true, 0 = false, -1 = unassigned.
+ */
+int QCDCLSolver::litValue(int lit) const {
+    int v = value[litVar(lit)];
+    if (v < 0) return -1;
+    return v ^ (litNegated(lit) ? 1 : 0);
+}
+
+/*
+ * Make a literal true and put it on the trail.
+ * reasonIndex is the implying clause/cube, or -1 for a decision.
+ */
+void QCDCLSolver::assign(int lit, int reasonIndex) {
+    int var = litVar(lit);
+    value[var] = litNegated(lit) ? 0 : 1;
+    level[var] = decisionLevel();
+    reason[var] = reasonIndex;
+    trailPos[var] = trail.size();
+    trail.push_back(lit);
+    levelUnassigned[qlevel[var]]--;
+
+    // Track how many original clauses are satisfied; with gates, also
+    // which definitions of assigned gates are still open
+    for (int c : gateDefs[var]) {
+        if (satCount[c] == 0) numOpenDefs++;
+    }
+    for (int c : clauseOcc[lit]) {
+        if (c < numOriginal && satCount[c]++ == 0) {
+            numSatisfied++;
+            if (gateOf[c] == 0) {
+                numSatisfiedRest++;
+            } else if (value[gateOf[c]] >= 0) {
+                numOpenDefs--;
+            }
+        }
+    }
+}
+
+/*
+ * Undo all assignments above the target decision level. Level -1 undoes
+ * the level-0 assignments too (see rescanLevelZero).
+ */
+void QCDCLSolver::backtrack(int targetLevel) {
+    if (decisionLevel() <= targetLevel) return;
+    size_t keep = targetLevel < 0 ? 0 : trailLim[targetLevel];
+    targetLevel = std::max(targetLevel, 0);
+
+    // Close the profiled decisions, innermost level first
+    if (profile) {
+        for (int l = decisionLevel(); l > targetLevel; l--) profile->leave();
+    }
+
+    for (size_t i = trail.size(); i-- > keep;) {
+        int lit = trail[i];
+        int var = litVar(lit);
+        if (outerVar[var]) outer.newAssignment();
+        savedPhase[var] = (value[var] == 1);
+        value[var] = -1;
+        reason[var] = -1;
+        levelUnassigned[qlevel[var]]++;
+        for (int c : gateDefs[var]) {
+            if (satCount[c] == 0) numOpenDefs--;
+        }
+        for (int c : clauseOcc[lit]) {
+            if (c < numOriginal && --satCount[c] == 0) {
+                numSatisfied--;
+                if (gateOf[c] == 0) {
+                    numSatisfiedRest--;
+                } else if (value[gateOf[c]] >= 0) {
+                    numOpenDefs++;
+                }
+            }
+        }
+    }
+    trail.resize(keep);
+    trailLim.resize(targetLevel);
+    qhead = trail.size();
+}
+
+/*
+ * Choose the next decision, respecting the quantifier prefix: only
+ * variables of the outermost level with unassigned variables are
+ * candidates. Among them, pick the most active one (the one that took
+ * part in the most recent conflicts and solutions).
+ *
+ * With dependency learning every variable whose learned dependencies are
+ * all assigned is a candidate; ties go to the outermost one.
+ *
+ * Returns -1 if every variable is assigned.
+ */
+int QCDCLSolver::pickBranchLiteral() {
+    if (depLearning) {
+        int best = -1;
+        for (int var = 1; var <= numVars; var++) {
+            if (qlevel[var] < 0 || value[var] >= 0) continue;
+            if (best >= 0 && (activity[var] < activity[best] ||
+                              (activity[var] == activity[best] && qlevel[var] >= qlevel[best]))) {
+                continue;
+            }
+            bool ready = true;
+            for (int dep : dependencies[var]) {
+                if (value[dep] < 0) {
+                    ready = false;
+                    break;
+                }
+            }
+            if (ready) best = var;
+        }
+        return best < 0 ? -1 : makeLit(best, !savedPhase[best]);
+    }
+
+    for (size_t q = 0; q < levelVars.size(); q++) {
+        if (levelUnassigned[q] == 0) continue;
+
+        int best = -1;
+        for (int var : levelVars[q]) {
+            if (value[var] < 0 && (best < 0 || activity[var] > activity[best])) {
+                best = var;
+            }
+        }
+        return makeLit(best, !savedPhase[best]);
+    }
+    return -1;
+}
+
+// ============================================================================
+// Dependencies
+// ============================================================================
+
+/*
+ * Must `on` be assigned before `var` may be decided or implied? In prefix
+ * order: every variable of the other quantifier before var. With
+ * dependency learning: only the learned ones.
+ */
+bool QCDCLSolver::dependsOn(int var, int on) const {
+    if (universal[on] == universal[var] || qlevel[on] >= qlevel[var]) return false;
+    if (!depLearning) return true;
+    return std::binary_search(dependencies[var].begin(), dependencies[var].end(), on);
+}
+
+/*
+ * Dependency learning: does the constraint still have an open secondary
+ * literal that var depends on? Merged variables keep the prefix order.
+ */
+bool QCDCLSolver::hasOpenDependency(int index, int var) const {
+    for (int other : constraints[index].merged) {
+        if (qlevel[other] < qlevel[var]) return true;
+    }
+    for (int lit : constraints[index].lits) {
+        int other = litVar(lit);
+        if (value[other] < 0 && dependsOn(var, other)) return true;
+    }
+    return false;
+}
+
+void QCDCLSolver::addDependency(int var, int on) {
+    auto& deps = dependencies[var];
+    deps.insert(std::lower_bound(deps.begin(), deps.end(), on), on);
+    stats.dependencies++;
+    log("[DEPS] " + litToString(makeLit(var, false)) + " depends on " + litToString(makeLit(on, false)));
+}
+
+// Pairs (var, on) of the prefix order, for comparison with the learned ones
+long long QCDCLSolver::countPrefixDependencies() const {
+    long long pairs = 0;
+    long long outerExists = 0, outerForall = 0;
+    for (const auto& vars : levelVars) {
+        if (vars.empty()) continue;
+        bool forall = universal[vars[0]];
+        long long size = vars.size();
+        pairs += size * (forall ? outerExists : outerForall);
+        (forall ? outerForall : outerExists) += size;
+    }
+    return pairs;
+}
+
+// ============================================================================
+// Propagation
+// ============================================================================
+
+/*
+ * Evaluate a clause under the current assignment.
+ *
+ * CONFLICT: no true literal and no unassigned existential literal
+ *           (unassigned universals are removed by universal reduction)
+ * UNIT:     exactly one unassigned existential e, and every unassigned
+ *           universal is quantified after e
+ *
+ * Merged literals count as unassigned universals. With dependency
+ * learning, only the unassigned universals e depends on block it.
+ */
+QCDCLSolver::Status QCDCLSolver::checkClause(int index, int& unitLit) const {
+    int existLit = -1;
+    int existCount = 0;
+    int minUniversal = INT_MAX;
+
+    for (int lit : constraints[index].lits) {
+        int v = litValue(lit);
+        if (v == 1) return Status::SATISFIED;
+        if (v < 0) {
+            int var = litVar(lit);
+            if (universal[var]) {
+                minUniversal = std::min(minUniversal, qlevel[var]);
+            } else {
+                existCount++;
+                existLit = lit;
+            }
+        }
+    }
+
+    for (int var : constraints[index].merged) minUniversal = std::min(minUniversal, qlevel[var]);
+
+    if (existCount == 0) return Status::CONFLICT;
+    if (existCount == 1 && (minUniversal > qlevel[litVar(existLit)] ||
+                            (depLearning && !hasOpenDependency(index, litVar(existLit))))) {
+        unitLit = existLit;
+        return Status::UNIT;
+    }
+    return Status::OPEN;
+}
+
+/*
+ * Evaluate a cube under the current assignment (dual of checkClause).
+ *
+ * SOLUTION: no false literal and no unassigned universal literal
+ * UNIT:     exactly one unassigned universal u, and every unassigned
+ *           existential is quantified after u
+ *
+ * Merged literals count as unassigned existentials. With dependency
+ * learning, only the unassigned existentials u depends on block it.
+ */
+QCDCLSolver::Status QCDCLSolver::checkCube(int index, int& unitLit) const {
+    int univLit = -1;
+    int univCount = 0;
+    int minExistential = INT_MAX;
+
+    for (int lit : constraints[index].lits) {
+        int v = litValue(lit);
+        if (v == 0) return Status::OPEN;  // Cube is falsified, nothing to do
+        if (v < 0) {
+            int var = litVar(lit);
+            if (universal[var]) {
+                univCount++;
+                univLit = lit;
+            } else {
+                minExistential = std::min(minExistential, qlevel[var]);
+            }
+        }
+    }
+
+    for (int var : constraints[index].merged) minExistential = std::min(minExistential, qlevel[var]);
+
+    if (univCount == 0) return Status::SOLUTION;
+    if (univCount == 1 && (minExistential > qlevel[litVar(univLit)] ||
+                           (depLearning && !hasOpenDependency(index, litVar(univLit))))) {
+        unitLit = univLit;
+        return Status::UNIT;
+    }
+    return Status::OPEN;
+}
+
+/*
+ * Propagate all pending trail entries.
+ *
+ * For each newly true literal l we only have to look at clauses that
+ * contain ¬l (they lost a literal) and cubes that contain l (they gained
+ * one). On CONFLICT/SOLUTION, culprit is the responsible constraint; a
+ * SOLUTION with culprit -1 means every original clause is satisfied.
+ */
+QCDCLSolver::Status QCDCLSolver::propagate(int& culprit) {
+    culprit = -1;
+    if (numSatisfied == numOriginal) return Status::SOLUTION;
+    if (dualSolution()) {
+        stats.dualSolutions++;
+        return Status::SOLUTION;
+    }
+
+    while (qhead < trail.size()) {
+        int lit = trail[qhead++];
+        int unitLit;
+
+        const auto& clauses = clauseOcc[negate(lit)];
+        for (size_t i = 0; i < clauses.size(); i++) {
+            Status st = checkClause(clauses[i], unitLit);
+            if (st == Status::CONFLICT) {
+                culprit = clauses[i];
+                return Status::CONFLICT;
+            }
+            if (st == Status::UNIT) {
+                assign(unitLit, clauses[i]);
+                stats.propagations++;
+            }
+        }
+
+        const auto& cubes = cubeOcc[lit];
+        for (size_t i = 0; i < cubes.size(); i++) {
+            Status st = checkCube(cubes[i], unitLit);
+            if (st == Status::SOLUTION && !againstAssumptions(cubes[i])) {
+                culprit = cubes[i];
+                return Status::SOLUTION;
+            }
+            if (st == Status::UNIT) {
+                assign(negate(unitLit), cubes[i]);
+                stats.propagations++;
+            }
+        }
+
+        if (numSatisfied == numOriginal) return Status::SOLUTION;
+        if (dualSolution()) {
+            stats.dualSolutions++;
+            return Status::SOLUTION;
+        }
+    }
+    return Status::OPEN;
+}
+
+/*
+ * A cube is a solution while its unassigned existentials are open: EXISTS
+ * can still play them. If one of them is the negation of an assumption
+ * not decided yet, EXISTS may not: such a cube wins, but not under the
+ * assumptions, and is passed over until the assumption falsifies it.
+ */
+bool QCDCLSolver::againstAssumptions(int index) const {
+    for (size_t i = decisionLevel(); i < assumptions.size(); i++) {
+        int flipped = negate(assumptions[i]);
+        const auto& lits = constraints[index].lits;
+        if (std::find(lits.begin(), lits.end(), flipped) != lits.end()) return true;
+    }
+    return false;
+}
+
+/*
+ * Rebuild the level-0 assignment from scratch: undo all of it and check
+ * every clause and cube again. Needed when a level-0 implication turns
+ * out to rely on a missing dependency. On CONFLICT/SOLUTION, culprit is
+ * the responsible constraint.
+ */
+QCDCLSolver::Status QCDCLSolver::rescanLevelZero(int& culprit) {
+    backtrack(-1);
+    culprit = -1;
+    for (size_t c = 0; c < constraints.size(); c++) {
+        int unitLit;
+        bool isCube = constraints[c].isCube;
+        Status st = isCube ? checkCube(c, unitLit) : checkClause(c, unitLit);
+        if (st == Status::SOLUTION && againstAssumptions(c)) continue;
+        if (st == Status::CONFLICT || st == Status::SOLUTION) {
+            culprit = c;
+            return st;
+        }
+        if (st == Status::UNIT) {
+            assign(isCube ? negate(unitLit) : unitLit, c);
+            stats.propagations++;
+        }
+    }
+    return Status::OPEN;
+}
+
+/*
+ * The circuit's side of dual propagation: every clause that defines no
+ * gate is satisfied, and no assigned gate disagrees with its inputs
+ * (each of its definition clauses is satisfied). EXISTS wins by setting
+ * the remaining gates from their inputs, innermost definitions last.
+ */
+bool QCDCLSolver::dualSolution() const {
+    return dual && numSatisfiedRest == numRest && numOpenDefs == 0;
+}
+
+/*
+ * Find gate definitions among the original clauses. For an output
+ * literal o of an existential variable g, look for the clauses
+ *
+ *     (¬o ∨ a1) ... (¬o ∨ ak)   and   (o ∨ ¬a1 ∨ ... ∨ ¬ak)
+ *
+ * which say o = a1 ∧ ... ∧ ak (o = ¬g gives an OR gate, k = 1 an
+ * equivalence). The inputs must be quantified no later than g, so that
+ * EXISTS can compute g from them. Gates of the outermost level are left
+ * alone: a winning outer assignment then never depends on a gate.
+ *
+ * A clause defines at most one gate, and definitions must not form a
+ * cycle (g = AND(h, ..) with h = AND(g, ..)): candidates are accepted in
+ * dependency order, and a cycle is broken by dropping one of its gates.
+ */
+void QCDCLSolver::detectGates() {
+    gateOf.assign(numOriginal, 0);
+    numRest = numOriginal;
+    if (!dual) return;
+    TraceScope traced("detect gates", "qcdcl");
+
+    std::vector<std::vector<int>> candidateDefs(numVars + 1);
+    std::vector<std::vector<int>> candidateInputs(numVars + 1);
+    std::vector<int> implied(2 * numVars + 2, -1);  // Literal a -> clause (¬o ∨ a)
+
+    for (int var = 1; var <= numVars; var++) {
+        if (qlevel[var] <= 0 || universal[var]) continue;
+        for (int negated = 0; negated < 2 && candidateDefs[var].empty(); negated++) {
+            int out = makeLit(var, negated == 1);
+            std::vector<int> marked;
+            for (int c : clauseOcc[negate(out)]) {
+                const auto& lits = constraints[c].lits;
+                if (lits.size() != 2) continue;
+                int other = (lits[0] == negate(out)) ? lits[1] : lits[0];
+                if (implied[other] < 0) {
+                    implied[other] = c;
+                    marked.push_back(other);
+                }
+            }
+            for (int c : clauseOcc[out]) {
+                const auto& lits = constraints[c].lits;
+                if (lits.size() < 2) continue;
+                bool isDefinition = true;
+                for (int lit : lits) {
+                    if (lit == out) continue;
+                    int input = litVar(lit);
+                    if (implied[negate(lit)] < 0 || qlevel[input] > qlevel[var]) {
+                        isDefinition = false;
+                        break;
+                    }
+                }
+                if (!isDefinition) continue;
+                candidateDefs[var].push_back(c);
+                for (int lit : lits) {
+                    if (lit == out) continue;
+                    candidateDefs[var].push_back(implied[negate(lit)]);
+                    candidateInputs[var].push_back(litVar(lit));
+                }
+                break;
+            }
+            for (int lit : marked) implied[lit] = -1;
+        }
+    }
+
+    // Accept in dependency order: a gate waits for its candidate inputs
+    std::vector<int> waiting(numVars + 1, 0);
+    std::vector<std::vector<int>> dependents(numVars + 1);
+    std::vector<int> ready;
+    for (int var = 1; var <= numVars; var++) {
+        if (candidateDefs[var].empty()) continue;
+        for (int input : candidateInputs[var]) {
+            if (candidateDefs[input].empty()) continue;
+            waiting[var]++;
+            dependents[input].push_back(var);
+        }
+        if (waiting[var] == 0) ready.push_back(var);
+    }
+
+    std::vector<bool> decided(numVars + 1, false);
+    auto decide = [&](int var, bool accept) {
+        decided[var] = true;
+        for (int c : candidateDefs[var]) {
+            if (gateOf[c] != 0) accept = false;  // Clause already defines a gate
+        }
+        if (accept) {
+            for (int c : candidateDefs[var]) gateOf[c] = var;
+            gateDefs[var] = candidateDefs[var];
+            numRest -= candidateDefs[var].size();
+            stats.gates++;
+        }
+        for (int dependent : dependents[var]) {
+            if (--waiting[dependent] == 0) ready.push_back(dependent);
+        }
+    };
+
+    int nextUndecided = 1;
+    for (;;) {
+        while (!ready.empty()) {
+            int var = ready.back();
+            ready.pop_back();
+            if (!decided[var]) decide(var, true);
+        }
+        // Only cycles are left: drop the lowest undecided candidate
+        while (nextUndecided <= numVars &&
+               (candidateDefs[nextUndecided].empty() || decided[nextUndecided])) {
+            nextUndecided++;
+        }
+        if (nextUndecided > numVars) break;
+        decide(nextUndecided, false);
+    }
+}
+
+// ============================================================================
+// Learning
+// ============================================================================
+
+/*
+ * Universal reduction (clauses) / existential reduction (cubes).
+ *
+ * Clause: drop universal literals quantified after every existential.
+ * Cube:   drop existential literals quantified after every universal.
+ * Merged variables (long-distance resolution) are reduced the same way.
+ */
+void QCDCLSolver::reduceConstraint(std::vector<int>& lits, bool isCube, std::vector<int>* merged) const {
+    int maxKept = -1;
+    for (int lit : lits) {
+        int var = litVar(lit);
+        if (universal[var] == isCube) maxKept = std::max(maxKept, qlevel[var]);
+    }
+    lits.erase(std::remove_if(lits.begin(), lits.end(), [&](int lit) {
+        int var = litVar(lit);
+        return universal[var] != isCube && qlevel[var] > maxKept;
+    }), lits.end());
+    if (merged) {
+        merged->erase(std::remove_if(merged->begin(), merged->end(), [&](int var) {
+            return qlevel[var] > maxKept;
+        }), merged->end());
+    }
+}
+
+/*
+ * Check a constraint from another portfolio worker before adding it: every
+ * literal must name a variable of this worker's prefix, at most once, and
+ * the constraint is reduced under that prefix. One that reduces to
+ * nothing would decide the formula on its own; its sender stops the
+ * search anyway, so it is ignored rather than trusted.
+ */
+bool QCDCLSolver::importable(std::vector<int>& lits, bool isCube) const {
+    std::vector<int> seen;
+    for (int lit : lits) {
+        int var = litVar(lit);
+        if (lit < 2 || var > numVars || qlevel[var] < 0) return false;
+        if (std::find(seen.begin(), seen.end(), var) != seen.end()) return false;
+        seen.push_back(var);
+    }
+    reduceConstraint(lits, isCube);
+    return !lits.empty();
+}
+
+/*
+ * The literals EXISTS has to play for the cube that proved SAT at level 0.
+ *
+ * A universal literal of that cube may itself be implied by another cube:
+ * FORALL only plays it because the other value would satisfy that cube.
+ * Its literals belong to the winning assignment too, e.g. x2 below:
+ *
+ *   cube [x2 ∧ ¬x4 ∧ ¬x1] implies x4, which makes [x4 ∧ x3 ∧ ¬x1] true;
+ *   ¬x1, x3 alone do not win - FORALL would play ¬x4.
+ */
+std::vector<int> QCDCLSolver::winningCube(int culprit) const {
+    std::vector<int> lits;
+    std::vector<bool> inCube(2 * numVars + 2, false);
+    std::vector<int> pending = {culprit};
+    std::vector<bool> expanded(constraints.size(), false);
+    expanded[culprit] = true;
+
+    while (!pending.empty()) {
+        int index = pending.back();
+        pending.pop_back();
+        for (int lit : constraints[index].lits) {
+            if (inCube[lit]) continue;
+            inCube[lit] = true;
+            lits.push_back(lit);
+            int why = reason[litVar(lit)];
+            if (universal[litVar(lit)] && why >= 0 && constraints[why].isCube && !expanded[why]) {
+                expanded[why] = true;
+                pending.push_back(why);
+            }
+        }
+    }
+    return lits;
+}
+
+/*
+ * Build the starting cube for solution analysis: one true literal from
+ * every original clause. Existential literals of the innermost levels are
+ * preferred since existential reduction is likely to drop them again.
+ *
+ * With gates, definition clauses are skipped at first; only the gates
+ * that end up in the cube need their definitions covered (which may pull
+ * in further gates). The other gates are left to follow their inputs.
+ */
+std::vector<int> QCDCLSolver::initialCube() const {
+    std::vector<int> cube;
+    std::vector<bool> inCube(2 * numVars + 2, false);
+
+    auto cover = [&](int c) {
+        int best = -1;
+        bool covered = false;
+        for (int lit : constraints[c].lits) {
+            if (litValue(lit) != 1) continue;
+            if (inCube[lit]) {
+                covered = true;
+                break;
+            }
+            int var = litVar(lit);
+            if (best < 0) {
+                best = lit;
+                continue;
+            }
+            int bestVar = litVar(best);
+            if (universal[bestVar] && !universal[var]) {
+                best = lit;
+            } else if (universal[bestVar] == universal[var] && qlevel[var] > qlevel[bestVar]) {
+                best = lit;
+            }
+        }
+        if (!covered && best >= 0) {
+            inCube[best] = true;
+            cube.push_back(best);
+        }
+    };
+
+    for (int c = 0; c < numOriginal; c++) {
+        if (gateOf[c] == 0) cover(c);
+    }
+    for (size_t i = 0; i < cube.size(); i++) {
+        for (int c : gateDefs[litVar(cube[i])]) cover(c);
+    }
+    return cube;
+}
+
+/*
+ * The fallback lesson when resolution gets stuck: the negation of all
+ * decisions (a clause, after a conflict) or their conjunction (a cube,
+ * after a solution). It records "these moves lose/win", which is always
+ * sound because decisions follow the quantifier prefix.
+ */
+std::vector<int> QCDCLSolver::decisionConstraint(bool isCube) const {
+    std::vector<int> lits;
+    for (int lim : trailLim) {
+        int decision = trail[lim];
+        lits.push_back(isCube ? decision : negate(decision));
+    }
+    return lits;
+}
+
+/*
+ * Check whether a learned clause (or cube) is asserting.
+ *
+ * For a clause, the "primary" literals are existential, for a cube they
+ * are universal. The constraint is asserting if its deepest primary
+ * literal is strictly deeper than every literal that has to stay assigned
+ * for it to become unit: the other primary literals and the secondary
+ * literals quantified before it (with dependency learning: the ones it
+ * depends on). Backjumping to the deepest of those makes the constraint
+ * unit.
+ */
+bool QCDCLSolver::isAsserting(const std::vector<int>& lits, const std::vector<int>& merged, bool isCube,
+                              int& assertLit, int& backjumpLevel) const {
+    int star = -1;
+    for (int lit : lits) {
+        int var = litVar(lit);
+        if (universal[var] != isCube) continue;
+        if (value[var] < 0) return false;
+        if (star < 0 || level[var] > level[litVar(star)]) star = lit;
+    }
+    if (star < 0) return false;
+
+    int starVar = litVar(star);
+    int highest = 0;
+    for (int lit : lits) {
+        if (lit == star) continue;
+        int var = litVar(lit);
+        bool primary = (universal[var] == isCube);
+        if (!primary && !dependsOn(starVar, var)) continue;  // Need not be assigned
+        if (value[var] < 0) return false;
+        highest = std::max(highest, level[var]);
+    }
+    for (int var : merged) {
+        if (qlevel[var] < qlevel[starVar]) return false;  // Never assigned
+    }
+
+    if (level[starVar] <= highest) return false;
+    assertLit = star;
+    backjumpLevel = highest;
+    return true;
+}
+
+/*
+ * Derive an asserting clause (after a conflict) or cube (after a solution).
+ *
+ * Resolution is LONG-DISTANCE: when the two sides contain u and ¬u for a
+ * secondary variable u quantified after the pivot, the resolvent keeps a
+ * MERGED literal u* instead of being rejected as a tautology. (For a
+ * clause, u is universal: FORALL has already committed to a value of u
+ * by the time the pivot's value matters, and either value loses.) A
+ * merged literal is never true or false; it counts as an unassigned
+ * secondary literal and is removed by reduction like one. Clashes on
+ * variables quantified before the pivot still fall back to the decision
+ * constraint.
+ *
+ * With dependency learning, a clash on a variable before the pivot means
+ * the pivot was implied too early: the pivot learns to depend on it and
+ * no constraint is learned (DEPENDENCY, backjumpLevel is the level to
+ * take the implication back at; -1 = rebuild level 0).
+ *
+ * Returns EMPTY if the learned constraint reduces to the empty clause
+ * (formula is UNSAT) or the empty cube (formula is SAT).
+ */
+QCDCLSolver::Lesson QCDCLSolver::analyze(std::vector<int> lits, bool isCube, std::vector<int>& learnt,
+                          std::vector<int>& learntMerged, int& assertLit, int& backjumpLevel) {
+    // Literal membership of the working constraint
+    std::vector<bool> inR(2 * numVars + 2, false);
+    auto setR = [&](const std::vector<int>& newLits) {
+        for (int lit : lits) inR[lit] = false;
+        lits.clear();
+        for (int lit : newLits) {
+            if (!inR[lit]) {
+                inR[lit] = true;
+                lits.push_back(lit);
+            }
+        }
+    };
+    setR(std::vector<int>(lits));
+
+    // Merged variables of the working constraint
+    std::vector<int> merged;
+    std::vector<bool> inMerged(numVars + 1, false);
+    auto setMerged = [&](const std::vector<int>& newMerged) {
+        for (int var : merged) inMerged[var] = false;
+        merged.clear();
+        for (int var : newMerged) {
+            if (!inMerged[var]) {
+                inMerged[var] = true;
+                merged.push_back(var);
+            }
+        }
+    };
+
+    bool usedFallback = false;
+    for (;;) {
+        std::vector<int> reduced = lits;
+        std::vector<int> reducedMerged = merged;
+        reduceConstraint(reduced, isCube, &reducedMerged);
+        if (reduced.empty()) {
+            if (isCube) winningLits = lits;  // Existential literals only: EXISTS plays them
+            learnt.clear();
+            return Lesson::EMPTY;
+        }
+        setR(reduced);
+        setMerged(reducedMerged);
+        if (isAsserting(lits, merged, isCube, assertLit, backjumpLevel)) {
+            break;
+        }
+
+        // Pivot: the most recently assigned primary literal that was implied
+        int pivot = -1;
+        if (!usedFallback) {
+            for (int lit : lits) {
+                int var = litVar(lit);
+                if (universal[var] != isCube || value[var] < 0 || reason[var] < 0) continue;
+                if (pivot < 0 || trailPos[var] > trailPos[litVar(pivot)]) pivot = lit;
+            }
+        }
+
+        bool resolved = pivot >= 0;
+        std::vector<int> resolvent;
+        std::vector<int> resolventMerged = merged;
+        std::vector<int> clashes;  // Variables that end up merged
+        std::vector<int> blocked;  // Secondary clashes before the pivot
+        if (resolved) {
+            int pivotVar = litVar(pivot);
+            const Constraint& why = constraints[reason[pivotVar]];
+
+            // Only secondary variables quantified after the pivot may merge
+            auto clash = [&](int var) {
+                if (universal[var] == isCube) return false;
+                if (qlevel[var] <= qlevel[pivotVar]) {
+                    blocked.push_back(var);
+                    return false;
+                }
+                clashes.push_back(var);
+                return true;
+            };
+            for (int lit : why.lits) {
+                int var = litVar(lit);
+                if (var == pivotVar) continue;
+                if ((inR[negate(lit)] || inMerged[var]) && !clash(var)) resolved = false;
+            }
+            for (int var : why.merged) {
+                if ((inR[makeLit(var, false)] || inR[makeLit(var, true)] || inMerged[var]) && !clash(var)) {
+                    resolved = false;
+                }
+                resolventMerged.push_back(var);
+            }
+
+            std::vector<bool> isClash(numVars + 1, false);
+            for (int var : clashes) isClash[var] = true;
+            for (int lit : lits) {
+                if (lit != pivot && !isClash[litVar(lit)]) resolvent.push_back(lit);
+            }
+            for (int lit : why.lits) {
+                if (litVar(lit) != pivotVar && !isClash[litVar(lit)]) resolvent.push_back(lit);
+            }
+            resolventMerged.insert(resolventMerged.end(), clashes.begin(), clashes.end());
+        }
+
+        if (!resolved && depLearning) {
+            // Blame the pivot for its clashes; without a pivot, blame the
+            // deepest primary literal for the merged variables before it,
+            // which keep the constraint from asserting it
+            int blamed = pivot;
+            if (blamed < 0) {
+                for (int lit : lits) {
+                    int var = litVar(lit);
+                    if (universal[var] != isCube || value[var] < 0) continue;
+                    if (blamed < 0 || level[var] > level[litVar(blamed)]) blamed = lit;
+                }
+                blocked = merged;
+            }
+            learnt.clear();
+            int learned = 0;
+            if (blamed >= 0) {
+                int blamedVar = litVar(blamed);
+                for (int var : blocked) {
+                    if (qlevel[var] >= qlevel[blamedVar] || dependsOn(blamedVar, var)) continue;
+                    addDependency(blamedVar, var);
+                    learned++;
+                }
+                backjumpLevel = level[blamedVar] - 1;
+            }
+            if (learned == 0) {
+                // Nothing new explains it: the decision constraint is only
+                // sound for decisions in prefix order, so switch to it
+                log("[DEPS] Resolution stuck without a new dependency, following the prefix from now on");
+                depLearning = false;
+                stats.dependencyFallbacks++;
+                backjumpLevel = -1;
+            }
+            return Lesson::DEPENDENCY;
+        }
+        if (!resolved) {
+            if (usedFallback) {
+                // Cannot happen while decisions follow the prefix;
+                // the decision constraint is always asserting.
+                learnt.clear();
+                return Lesson::EMPTY;
+            }
+            log(std::string("[LEARN] Resolution stuck, using the decision ") +
+                (isCube ? "cube" : "clause"));
+            usedFallback = true;
+            setR(decisionConstraint(isCube));
+            setMerged({});
+            continue;
+        }
+        if (!clashes.empty()) {
+            stats.longDistance++;
+            std::string names;
+            for (int var : clashes) names += " x" + std::to_string(var) + "*";
+            log("[LEARN] Long-distance resolution on " + litToString(pivot) + " merges" + names);
+        }
+        setR(resolvent);
+        setMerged(resolventMerged);
+    }
+
+    learnt = lits;
+    learntMerged = merged;
+    minimizeLearned(learnt, learntMerged, isCube, assertLit, backjumpLevel);
+    return Lesson::CONSTRAINT;
+}
+
+/*
+ * Can lit be resolved out of the learned constraint? It can if it was
+ * implied (by a clause for an existential literal of a learned clause,
+ * by a cube for a universal literal of a learned cube) and every other
+ * literal of its reason is in the learned constraint or can itself be
+ * resolved out. Resolving with the reason then only re-adds literals
+ * that are already there: the constraint shrinks by lit, the pivot is
+ * always primary, and no universal literal can clash (Q-resolution).
+ */
+bool QCDCLSolver::isRedundant(int lit, bool isCube, const std::vector<bool>& inLearnt,
+                              std::vector<signed char>& memo, int depth) const {
+    int var = litVar(lit);
+    int why = reason[var];
+    if (universal[var] != isCube || value[var] < 0 || why < 0 || constraints[why].isCube != isCube ||
+        !constraints[why].merged.empty()) {
+        return false;
+    }
+    if (memo[var] != 0) return memo[var] > 0;
+    if (depth > MINIMIZE_MAX_DEPTH) return false;  // Give up, but do not remember
+
+    bool redundant = true;
+    for (int other : constraints[why].lits) {
+        if (litVar(other) == var || inLearnt[other]) continue;
+        if (!isRedundant(other, isCube, inLearnt, memo, depth + 1)) {
+            redundant = false;
+            break;
+        }
+    }
+    memo[var] = redundant ? 1 : -1;
+    return redundant;
+}
+
+/*
+ * Learned-constraint minimization: drop every literal the implication
+ * graph shows to be redundant (self-subsumption, see isRedundant), then
+ * apply universal (existential) reduction again, since removing primary
+ * literals may leave secondary ones quantified after all of them.
+ *
+ * The asserting literal is kept. The result replaces the constraint only
+ * if it is still asserting (the backjump level may drop).
+ */
+void QCDCLSolver::minimizeLearned(std::vector<int>& learnt, std::vector<int>& merged, bool isCube,
+                                  int& assertLit, int& backjumpLevel) {
+    std::vector<bool> inLearnt(2 * numVars + 2, false);
+    for (int lit : learnt) inLearnt[lit] = true;
+    std::vector<signed char> memo(numVars + 1, 0);
+
+    std::vector<int> kept;
+    for (int lit : learnt) {
+        if (lit == assertLit || !isRedundant(lit, isCube, inLearnt, memo, 0)) kept.push_back(lit);
+    }
+    if (kept.size() == learnt.size()) return;
+    std::vector<int> keptMerged = merged;
+    reduceConstraint(kept, isCube, &keptMerged);
+
+    int newAssert, newLevel;
+    if (!isAsserting(kept, keptMerged, isCube, newAssert, newLevel)) return;
+    stats.minimizedLits += learnt.size() + merged.size() - kept.size() - keptMerged.size();
+    learnt = kept;
+    merged = keptMerged;
+    assertLit = newAssert;
+    backjumpLevel = newLevel;
+}
+
+// Number of distinct decision levels in a constraint
+int QCDCLSolver::computeLBD(const std::vector<int>& lits) const {
+    std::vector<int> levels;
+    for (int lit : lits) {
+        if (value[litVar(lit)] >= 0) levels.push_back(level[litVar(lit)]);
+    }
+    std::sort(levels.begin(), levels.end());
+    return std::unique(levels.begin(), levels.end()) - levels.begin();
+}
+
+// Increase the branching score of variables in a learned constraint
+void QCDCLSolver::bumpVariables(const std::vector<int>& lits) {
+    for (int lit : lits) {
+        int var = litVar(lit);
+        activity[var] += varInc;
+        if (activity[var] > 1e100) {
+            for (auto& a : activity) a *= 1e-100;
+            varInc *= 1e-100;
+        }
+    }
+    varInc *= 1.05;
+}
+
+/*
+ * Forget the less useful half of the learned constraints.
+ *
+ * Only called at decision level 0, where the only reasons in use are
+ * those of level-0 assignments. Constraints with LBD <= 2 ("glue") are
+ * always kept.
+ */
+void QCDCLSolver::reduceDatabase() {
+    int numLearned = constraints.size() - numOriginal;
+    if (numLearned <= (int)maxLearned) return;
+    TraceScope traced("reduce database", "qcdcl", "learned", numLearned);
+
+    std::vector<bool> locked(constraints.size(), false);
+    for (int lit : trail) {
+        if (reason[litVar(lit)] >= 0) locked[reason[litVar(lit)]] = true;
+    }
+
+    std::vector<int> candidates;
+    for (size_t i = numOriginal; i < constraints.size(); i++) {
+        if (!locked[i] && constraints[i].lbd > 2) candidates.push_back(i);
+    }
+    std::sort(candidates.begin(), candidates.end(), [&](int a, int b) {
+        if (constraints[a].lbd != constraints[b].lbd) return constraints[a].lbd > constraints[b].lbd;
+        return constraints[a].activity < constraints[b].activity;
+    });
+
+    std::vector<bool> remove(constraints.size(), false);
+    for (size_t i = 0; i < candidates.size() / 2; i++) remove[candidates[i]] = true;
+
+    // Compact the database and remap reasons
+    std::vector<int> newIndex(constraints.size(), -1);
+    std::vector<Constraint> kept;
+    for (size_t i = 0; i < constraints.size(); i++) {
+        if (remove[i]) continue;
+        newIndex[i] = kept.size();
+        kept.push_back(std::move(constraints[i]));
+    }
+    constraints = std::move(kept);
+    for (int lit : trail) {
+        int var = litVar(lit);
+        if (reason[var] >= 0) reason[var] = newIndex[reason[var]];
+    }
+
+    for (auto& occ : clauseOcc) occ.clear();
+    for (auto& occ : cubeOcc) occ.clear();
+    for (size_t i = 0; i < constraints.size(); i++) {
+        for (int lit : constraints[i].lits) {
+            (constraints[i].isCube ? cubeOcc : clauseOcc)[lit].push_back(i);
+        }
+    }
+
+    maxLearned += maxLearned / 10;
+    log("[REDUCE] Kept " + std::to_string(constraints.size() - numOriginal) +
+        " learned constraints");
+}
+
+// ============================================================================
+// Anytime Reports
+// ============================================================================
+
+// Value of a variable for the outer tracker: 1 true, 0 false, -1 unassigned
+int QCDCLSolver::outerValue(int var) const {
+    if (var <= numVars && value[var] >= 0) return value[var];
+    auto it = assignments.find(var);  // Set by preprocessing
+    if (it == assignments.end()) return -1;
+    return it->second ? 1 : 0;
+}
+
+/*
+ * Report outer variables assigned at decision level 0. Only clauses imply
+ * existential values, and a level-0 implication does not depend on any
+ * decision, so the literal holds in every winning assignment. The level-0
+ * trail only grows, so we remember how far we have looked.
+ */
+void QCDCLSolver::reportForcedOuter() {
+    if (!outer.active()) return;
+    size_t end = trailLim.empty() ? trail.size() : trailLim[0];
+    for (; forcedScanned < end; forcedScanned++) {
+        int var = litVar(trail[forcedScanned]);
+        if (!outerVar[var]) continue;
+        log("[OUTER] " + litToString(trail[forcedScanned]) + " is forced in every winning assignment");
+        outer.forcedFound(var, value[var] == 1);
+    }
+}
+
+// Luby sequence 1,1,2,1,1,2,4,... used to space out restarts
+static long long luby(long long i) {
+    long long size = 1, seq = 0;
+    while (size < i + 1) {
+        seq++;
+        size = 2 * size + 1;
+    }
+    while (size - 1 != i) {
+        size = (size - 1) >> 1;
+        seq--;
+        i = i % size;
+    }
+    return 1LL << seq;
+}
+
+// ============================================================================
+// Main Search Loop
+// ============================================================================
+
+/*
+ * Main entry point: load the preprocessed formula and run QCDCL.
+ */
+Result QCDCLSolver::solve(const QBFPreprocessor& preprocessor) {
+    reset();
+    stats.engine = "qcdcl";
+    assignments = preprocessor.getAssignments();
+
+    const auto& clauses = preprocessor.getClauses();
+    buildLevels(preprocessor, clauses);
+
+    if (profile) profile->reset(preprocessor);
+    outer.reset(preprocessor, outerCallback);
+    outerVar.assign(numVars + 1, false);
+    for (int var : outer.variables()) {
+        if (var <= numVars && qlevel[var] >= 0) outerVar[var] = true;
+    }
+    // Load clauses, dropping duplicate literals and tautologies
+    for (const auto& clause : clauses) {
+        std::vector<int> lits;
+        for (const auto& lit : clause) lits.push_back(makeLit(lit.variable, lit.isNegated));
+        std::sort(lits.begin(), lits.end());
+        lits.erase(std::unique(lits.begin(), lits.end()), lits.end());
+
+        bool tautology = false;
+        for (size_t i = 1; i < lits.size(); i++) {
+            if (lits[i] == negate(lits[i - 1])) tautology = true;
+        }
+        if (!tautology) addConstraint(lits, false, false);
+    }
+    numOriginal = constraints.size();
+    detectGates();
+
+    // Symmetry-breaking cubes: FORALL never needs to play vi=1, vi+1=0.
+    // They are never deleted (LBD 0 counts as glue).
+    for (const auto& group : universalSymmetries) {
+        for (size_t i = 0; i + 1 < group.size(); i++) {
+            if (group[i] > numVars || group[i + 1] > numVars) continue;
+            if (qlevel[group[i]] < 0 || qlevel[group[i + 1]] < 0) continue;
+            addConstraint({makeLit(group[i], false), makeLit(group[i + 1], true)}, true, true);
+        }
+    }
+    numSymmetryCubes = constraints.size() - numOriginal;
+
+    /*
+     * Portfolio workers other than 0 search in a different order, so they
+     * do not all run into the same dead ends: odd workers start with the
+     * opposite phases, activities get a small per-worker tie-breaking
+     * noise, and the restart interval varies. All of it is derived from
+     * the worker number, so every run of a worker is the same.
+     */
+    restartUnit = 64;
+    if (workerId > 0) {
+        unsigned int seed = 2654435761u * workerId;
+        for (int var = 1; var <= numVars; var++) {
+            if (workerId % 2 == 1) savedPhase[var] = !savedPhase[var];
+            seed = seed * 1103515245u + 12345u;
+            activity[var] = ((seed >> 16) % 1000) * 1e-6;
+        }
+        restartUnit = 64 << (workerId % 3);
+    }
+
+    if (verbose) {
+        std::cout << "[SOLVE] QCDCL with " << numOriginal << " clauses, "
+                  << levelVars.size() << " quantifier levels" << std::endl;
+        if (dual) {
+            std::cout << "[DUAL] " << stats.gates << " gates defined by "
+                      << (numOriginal - numRest) << " clauses" << std::endl;
+        }
+    }
+    if (depLearning) {
+        stats.prefixDependencies = countPrefixDependencies();
+        log("[DEPS] Starting without dependencies (the prefix has " +
+            std::to_string(stats.prefixDependencies) + ")");
+    }
+
+    assumptions.clear();
+    Result result = search(depLearning);
+
+    /*
+     * The winning outer assignment of a SAT result is read from the cube
+     * that proved it: a cube without universal literals tells EXISTS which
+     * values to play. It may leave outer variables open (don't-care) and
+     * may differ from the trail, which has moved on since the cube was
+     * learned. Variables fixed by preprocessing come from its assignments.
+     */
+    outer.finish(result == Result::SAT, result == Result::UNSAT, [this](int var) {
+        for (int lit : winningLits) {
+            if (litVar(lit) == var) return litNegated(lit) ? 0 : 1;
+        }
+        if (var <= numVars && qlevel[var] >= 0) return -1;
+        auto it = assignments.find(var);
+        return (it == assignments.end()) ? -1 : (it->second ? 1 : 0);
+    });
+
+    if (profile) profile->finish();
+    if (sharing) sharing->finished(workerId, result);
+    return result;
+}
+
+/*
+ * Solve again with the given outer literals assumed true, keeping the
+ * level-0 assignment and every learned clause and cube: they are implied
+ * by the formula, not by earlier assumptions, so each call starts where
+ * the previous one stopped. Dependency learning is switched off first,
+ * since its level-0 implications are not proven.
+ */
+Result QCDCLSolver::solveAssuming(const std::vector<Literal>& outerLits) {
+    assumptions.clear();
+    for (const auto& lit : outerLits) {
+        if (lit.variable > numVars || qlevel[lit.variable] < 0) continue;  // Fixed by preprocessing
+        assumptions.push_back(makeLit(lit.variable, lit.isNegated));
+    }
+    bool rescan = depLearning || rescanPending;
+    rescanPending = false;
+    if (depLearning) {
+        log("[DEPS] Following the prefix for assumptions");
+        depLearning = false;
+    }
+    return search(rescan);
+}
+
+/*
+ * Add a clause over outer variables between two searches. EXISTS now has
+ * fewer moves, so the formula can only get harder:
+ *
+ *   - learned clauses ("these moves lose") still hold
+ *   - a learned cube C ("these moves win") still holds if C contains a
+ *     literal of the new clause, which C then satisfies; otherwise it is
+ *     dropped. Symmetry-breaking cubes only mention universals, whose
+ *     symmetries the new clause does not touch, so they stay.
+ *
+ * The clause joins the original clauses, which come first in the
+ * database: every assignment is undone, the database is rebuilt and the
+ * next search rescans level 0 (learned unit clauses included).
+ */
+void QCDCLSolver::addOuterClause(const std::vector<Literal>& outerLits) {
+    std::vector<int> clause;
+    for (const auto& lit : outerLits) {
+        auto fixed = assignments.find(lit.variable);
+        if (lit.variable <= numVars && qlevel[lit.variable] >= 0) {
+            clause.push_back(makeLit(lit.variable, lit.isNegated));
+        } else if (fixed != assignments.end() && fixed->second != lit.isNegated) {
+            return;  // Satisfied by preprocessing
+        }
+    }
+    std::sort(clause.begin(), clause.end());
+    clause.erase(std::unique(clause.begin(), clause.end()), clause.end());
+
+    backtrack(-1);
+    std::vector<bool> inClause(2 * numVars + 2, false);
+    for (int lit : clause) inClause[lit] = true;
+
+    std::vector<Constraint> kept;
+    int dropped = 0;
+    for (size_t i = 0; i < constraints.size(); i++) {
+        if ((int)i == numOriginal) kept.push_back({clause, false, false, 0, 0.0, {}});
+        Constraint& c = constraints[i];
+        bool fixedCube = (int)i < numOriginal + numSymmetryCubes;
+        if (c.isCube && !fixedCube &&
+            std::none_of(c.lits.begin(), c.lits.end(), [&](int lit) { return inClause[lit]; })) {
+            dropped++;
+            continue;
+        }
+        kept.push_back(std::move(c));
+    }
+    if ((int)constraints.size() == numOriginal) kept.push_back({clause, false, false, 0, 0.0, {}});
+    constraints = std::move(kept);
+
+    satCount.push_back(0);
+    gateOf.push_back(0);
+    numOriginal++;
+    numRest++;
+    for (auto& occ : clauseOcc) occ.clear();
+    for (auto& occ : cubeOcc) occ.clear();
+    for (size_t i = 0; i < constraints.size(); i++) {
+        for (int lit : constraints[i].lits) {
+            (constraints[i].isCube ? cubeOcc : clauseOcc)[lit].push_back(i);
+        }
+    }
+
+    forcedScanned = 0;
+    winningLits.clear();
+    rescanPending = true;
+    log("[BLOCK] Added clause " + constraintToString(clause, false) + ", dropped " +
+        std::to_string(dropped) + " learned cubes");
+}
+
+/*
+ * The QCDCL loop. Assumptions are decided first, one per decision level;
+ * one that is already false when its turn comes was implied by the ones
+ * before it, which makes the answer UNSAT under the assumptions.
+ * rescan: rebuild the level-0 assignment first (dependency learning).
+ */
+Result QCDCLSolver::search(bool rescan) {
+    auto deadline = std::chrono::steady_clock::now() +
+                    std::chrono::duration_cast<std::chrono::steady_clock::duration>(
+                        std::chrono::duration<double>(timeLimit));
+    long long iterations = 0;
+    backtrack(0);
+    winningLits.clear();
+
+    Result result = Result::SAT;
+    bool done = false;
+
+    // Level-0 scan: unit clauses, empty clauses and purely universal clauses.
+    // With dependency learning a falsified clause is analyzed instead, so
+    // the main loop does the scan.
+    for (int c = 0; c < numOriginal && !done && !rescan; c++) {
+        int unitLit;
+        Status st = checkClause(c, unitLit);
+        if (st == Status::CONFLICT) {
+            log("[CONFLICT] Clause is falsified by universal reduction");
+            result = Result::UNSAT;
+            done = true;
+        } else if (st == Status::UNIT) {
+            assign(unitLit, c);
+            stats.propagations++;
+        }
+    }
+
+    long long restartCount = 0;
+    long long restartLimit = restartUnit * luby(0);
+    long long sinceRestart = 0;
+
+    while (!done) {
+        // Check the time budget now and then; the clock is not free
+        if (timeLimit > 0 && ++iterations % 1024 == 0 &&
+            std::chrono::steady_clock::now() >= deadline) {
+            log("[TIMEOUT] Time limit reached");
+            result = Result::UNKNOWN;
+            break;
+        }
+
+        int culprit;
+        Status st = Status::OPEN;
+        if (rescan) {
+            st = rescanLevelZero(culprit);
+            rescan = false;
+        }
+        if (st == Status::OPEN) st = propagate(culprit);
+
+        if (st == Status::CONFLICT || st == Status::SOLUTION) {
+            bool isCube = (st == Status::SOLUTION);
+            if (isCube) {
+                stats.solutions++;
+                outer.solutionFound([this](int var) { return outerValue(var); });
+            } else {
+                stats.conflicts++;
+                if (profile && culprit >= 0) {
+                    std::vector<int> vars;
+                    for (int lit : constraints[culprit].lits) vars.push_back(litVar(lit));
+                    profile->conflict(vars);
+                }
+            }
+
+            if (decisionLevel() == 0 && !depLearning) {
+                result = isCube ? Result::SAT : Result::UNSAT;
+                if (isCube && culprit >= 0) {
+                    winningLits = winningCube(culprit);
+                } else if (isCube) {
+                    winningLits = trail;
+                }
+                break;
+            }
+
+            std::vector<int> start = (culprit >= 0) ? constraints[culprit].lits : initialCube();
+            std::vector<int> learnt, learntMerged;
+            int assertLit, backjumpLevel;
+            Lesson lesson = analyze(start, isCube, learnt, learntMerged, assertLit, backjumpLevel);
+            if (lesson == Lesson::EMPTY) {
+                log(isCube ? "[LEARN] Empty cube - EXISTS wins" : "[LEARN] Empty clause - FORALL wins");
+                result = isCube ? Result::SAT : Result::UNSAT;
+                break;
+            }
+            if (lesson == Lesson::DEPENDENCY) {
+                if (backjumpLevel < 0) {
+                    rescan = true;
+                } else {
+                    backtrack(backjumpLevel);
+                }
+                continue;
+            }
+
+            bumpVariables(learnt);
+            int lbd = computeLBD(learnt);
+            log(std::string("[LEARN] ") + (isCube ? "cube " : "clause ") +
+                constraintToString(learnt, isCube, learntMerged) + ", backjump to level " +
+                std::to_string(backjumpLevel));
+
+            backtrack(backjumpLevel);
+            int index = addConstraint(learnt, isCube, true);
+            constraints[index].merged = learntMerged;
+            constraints[index].lbd = lbd;
+            constraints[index].activity = constraintInc;
+            constraintInc *= 1.001;
+            if (isCube) {
+                stats.learnedCubes++;
+                assign(negate(assertLit), index);
+            } else {
+                stats.learnedClauses++;
+                assign(assertLit, index);
+            }
+            stats.propagations++;
+            sinceRestart++;
+
+            if (sharing) {
+                if (lbd <= SHARE_MAX_LBD && learnt.size() <= static_cast<size_t>(SHARE_MAX_SIZE) &&
+                    learntMerged.empty()) {
+                    sharing->publish(workerId, {learnt, isCube, lbd});
+                }
+                if (!sharing->learned(workerId)) {
+                    log("[PORTFOLIO] Stopped: another worker finished");
+                    result = Result::UNKNOWN;
+                    break;
+                }
+            }
+            continue;
+        }
+
+        // Level-0 implications are only proven in prefix order
+        if (decisionLevel() == 0 && !depLearning) reportForcedOuter();
+
+        // Restart: keep learned constraints, forget the current branch
+        if (sinceRestart >= restartLimit) {
+            backtrack(0);
+            stats.restarts++;
+            traceInstant("restart", "qcdcl", "restart", stats.restarts);
+            restartCount++;
+            sinceRestart = 0;
+            restartLimit = restartUnit * luby(restartCount);
+            reduceDatabase();
+            log("[RESTART] #" + std::to_string(stats.restarts));
+
+            // Back at level 0: add what the other workers learned. Like an
+            // original clause, a new constraint may be unit, or even
+            // settle the formula, under the level-0 assignment.
+            if (sharing) {
+                std::vector<SharedConstraint> incoming;
+                sharing->collect(workerId, incoming);
+                for (auto& shared : incoming) {
+                    if (!importable(shared.lits, shared.isCube)) continue;
+                    int index = addConstraint(shared.lits, shared.isCube, true);
+                    constraints[index].lbd = shared.lbd;
+                    constraints[index].activity = constraintInc;
+                    stats.imported++;
+
+                    // Dependency learning: a falsified constraint must be
+                    // analyzed, which the rescan takes care of
+                    if (depLearning) {
+                        rescan = true;
+                        continue;
+                    }
+
+                    int unitLit;
+                    Status st = shared.isCube ? checkCube(index, unitLit) : checkClause(index, unitLit);
+                    if (st == Status::CONFLICT || st == Status::SOLUTION) {
+                        result = shared.isCube ? Result::SAT : Result::UNSAT;
+                        if (shared.isCube) winningLits = winningCube(index);
+                        done = true;
+                        break;
+                    }
+                    if (st == Status::UNIT) {
+                        assign(shared.isCube ? negate(unitLit) : unitLit, index);
+                        stats.propagations++;
+                    }
+                }
+            }
+            continue;
+        }
+
+        // Assumptions first; a true one still gets its (empty) level
+        int lit = -1;
+        while (decisionLevel() < static_cast<int>(assumptions.size())) {
+            int assumed = assumptions[decisionLevel()];
+            if (litValue(assumed) == 0) break;
+            if (litValue(assumed) < 0) {
+                lit = assumed;
+                break;
+            }
+            trailLim.push_back(trail.size());
+            if (profile) profile->enter(litVar(assumed));
+        }
+        if (decisionLevel() < static_cast<int>(assumptions.size()) && lit < 0) {
+            log("[ASSUME] " + litToString(assumptions[decisionLevel()]) +
+                " is false under the earlier assumptions - FORALL wins");
+            result = Result::UNSAT;
+            break;
+        }
+        if (lit < 0) lit = pickBranchLiteral();
+        if (lit < 0) {
+            // Every variable assigned without conflict: propagate() would
+            // have reported the solution, so this cannot happen.
+            break;
+        }
+        trailLim.push_back(trail.size());
+        stats.decisions++;
+        assign(lit, -1);
+        if (profile) profile->enter(litVar(lit));
+        log("[DECIDE] " + litToString(lit) + (universal[litVar(lit)] ? " (FORALL)" : " (EXISTS)"));
+    }
+
+    // The formula is true, but an assumption that is false by now was
+    // implied by the ones before it: no winning assignment has them all
+    if (result == Result::SAT) {
+        for (int assumed : assumptions) {
+            if (litValue(assumed) != 0) continue;
+            log("[ASSUME] " + litToString(assumed) + " is false under the earlier assumptions - FORALL wins");
+            result = Result::UNSAT;
+            winningLits.clear();
+            break;
+        }
+    }
+
+    // Record final values for the caller
+    for (int lit : trail) {
+        assignments[litVar(lit)] = !litNegated(lit);
+    }
+    return result;
+}
+
+std::vector<Literal> QCDCLSolver::getWinningLiterals() const {
+    std::vector<Literal> lits;
+    for (int lit : winningLits) lits.emplace_back(litVar(lit), litNegated(lit));
+    return lits;
+}
+
+// Only proven in prefix order; see dependency learning in QCDCLSolver.h
+int QCDCLSolver::levelZeroValue(int var) const {
+    if (depLearning || var > numVars || qlevel[var] < 0 || universal[var]) return -1;
+    if (value[var] < 0 || level[var] > 0) return -1;
+    return value[var];
+}
+
+// Get final variable assignments
+const std::unordered_map<int, bool>& QCDCLSolver::getAssignments() const {
+    return assignments;
+}
+
+// Get counters from the last solve() call
+const SolverStats& QCDCLSolver::getStats() const {
+    return stats;
+}
@@ -0,0 +1,308 @@
+/*
+ * QCDCLSolver.h - Conflict-Driven Clause and Cube Learning for QBF
+ *
+ * The recursive search in QBFSolver explores the game tree one branch at a
+ * time and forgets everything when it backtracks. QCDCL (the QBF version of
+ * CDCL from SAT solving) instead LEARNS from every dead end:
+ *
+ *   CONFLICT (a clause is falsified)  → learn a new CLAUSE
+ *       "this combination of moves always loses for EXISTS"
+ *
+ *   SOLUTION (all clauses satisfied)  → learn a new CUBE
+ *       "this combination of moves always wins for EXISTS"
+ *
+ * Learned clauses and cubes are derived by Q-resolution and term resolution,
+ * so they are implied by the formula and may be kept for the rest of the
+ * search. They then prune whole families of branches through propagation
+ * and let the solver jump back several decision levels at once.
+ *
+ * QBF-SPECIFIC RULES:
+ *
+ *   Universal reduction (clauses): a universal literal can be dropped from
+ *   a clause if no existential literal of the clause is quantified after it.
+ *     ∃x ∀u ∃y: (x ∨ u ∨ y) stays, ∃x ∀u: (x ∨ u) becomes (x)
+ *
+ *   Existential reduction (cubes): the dual rule, dropping existential
+ *   literals that come after every universal literal of the cube.
+ *
+ *   Unit clause: one unassigned existential e, every other literal false,
+ *   except universals quantified after e (they would be reduced anyway).
+ *
+ *   Unit cube: one unassigned universal u, every other literal true, except
+ *   existentials quantified after u. FORALL then falsifies u's literal.
+ *
+ * DUAL PROPAGATION (--dual):
+ *
+ *   Many formulas are circuits turned into CNF: each gate g = AND(a, b)
+ *   becomes the clauses (¬g ∨ a) (¬g ∨ b) (g ∨ ¬a ∨ ¬b). Such clauses say
+ *   nothing about who wins, only how g follows from a and b. Plain QCDCL
+ *   still waits until every one of them is satisfied before it sees a
+ *   SOLUTION, and then puts one literal per definition into the cube.
+ *
+ *   With dual propagation the solver detects these definitions (AND, OR
+ *   and equivalences of an existential variable in terms of variables
+ *   quantified no later) and watches the formula from both sides. The
+ *   clauses propagate as before, and the circuit's view reports a
+ *   SOLUTION as soon as every other clause is satisfied and each assigned
+ *   gate agrees with its inputs. Unassigned gates are then don't-cares:
+ *   EXISTS can still set them from their inputs. The starting cube only
+ *   needs the literals that justify the gates it mentions.
+ *
+ * DEPENDENCY LEARNING (--dep-learning):
+ *
+ *   The prefix makes every existential depend on every universal before
+ *   it, so a large ∀ block must be played out before its ∃ block can be
+ *   touched, even if most of the pairs never interact. With dependency
+ *   learning the solver starts from NO dependencies: any variable may be
+ *   decided, and a clause implies e even while universals before e are
+ *   still open. Only learned dependencies D(e) block e.
+ *
+ *   Learning itself still follows the real prefix. When conflict analysis
+ *   cannot resolve on e because the reason of e clashes with the working
+ *   clause on a universal u before e (an illegal merge), e should never
+ *   have been implied while u was open: the solver learns "e depends on
+ *   u", takes back the implication and tries again. Cubes learn the dual
+ *   dependencies of universals on existentials. Each such step adds a
+ *   dependency, so at worst the solver ends up with the prefix order; if
+ *   analysis gets stuck in a way no new dependency explains, it switches
+ *   to the prefix order for the rest of the search.
+ *
+ *   Since implications may rely on missing dependencies, a conflict at
+ *   decision level 0 proves nothing by itself: it is analyzed like any
+ *   other, and only an empty learned clause or cube ends the search.
+ */
+
+#ifndef QCDCL_SOLVER_H
+#define QCDCL_SOLVER_H
+
+#include "QBFPreprocessor.h"
+#include "QBFSolver.h"
+#include "QBFSymmetry.h"
+#include "QBFOuter.h"
+#include "QBFProfile.h"
+#include <unordered_map>
+#include <string>
+#include <vector>
+
+class ConstraintSharing;  // QBFPortfolio.h
+
+class QCDCLSolver {
+private:
+    /*
+     * Literals are stored as integers: variable v becomes 2v (positive)
+     * or 2v+1 (negated). Negation is then a single XOR.
+     */
+    static int makeLit(int var, bool negated) { return 2 * var + (negated ? 1 : 0); }
+    static int litVar(int lit) { return lit >> 1; }
+    static bool litNegated(int lit) { return lit & 1; }
+    static int negate(int lit) { return lit ^ 1; }
+
+    /*
+     * A constraint is either a clause (disjunction, from the formula or
+     * learned from a conflict) or a cube (conjunction, learned from a
+     * solution). Both are kept in one array so reasons can point to either.
+     */
+    struct Constraint {
+        std::vector<int> lits;
+        bool isCube;
+        bool learned;
+        int lbd;            // Distinct decision levels when learned (lower = better)
+        double activity;
+        std::vector<int> merged;  // Merged variables u* (long-distance resolution)
+    };
+
+    // Result of checking a single constraint under the current assignment
+    enum class Status { OPEN, SATISFIED, UNIT, CONFLICT, SOLUTION };
+
+    // Outcome of conflict/solution analysis
+    enum class Lesson {
+        CONSTRAINT,   // An asserting clause or cube
+        EMPTY,        // The empty clause or cube: the formula is decided
+        DEPENDENCY    // A learned dependency; take back the implication
+    };
+
+    // Variables
+    int numVars;
+    std::vector<signed char> value;     // -1 unassigned, 0 false, 1 true
+    std::vector<int> level;             // Decision level of the assignment
+    std::vector<int> reason;            // Constraint that implied it, -1 = decision
+    std::vector<int> trailPos;          // Position on the trail
+    std::vector<int> qlevel;            // Quantifier level, -1 = not in the matrix
+    std::vector<bool> universal;
+    std::vector<double> activity;       // Branching score
+    std::vector<bool> savedPhase;
+    std::vector<std::vector<int>> levelVars;   // Quantifier level -> variables
+    std::vector<int> levelUnassigned;          // Quantifier level -> #unassigned
+
+    // Assignment trail
+    std::vector<int> trail;             // Assigned literals in order
+    std::vector<int> trailLim;          // Trail size at each decision
+    size_t qhead;                       // Next trail entry to propagate
+    std::vector<int> assumptions;       // Decided first, one per level (solveAssuming)
+
+    // Constraint database
+    std::vector<Constraint> constraints;
+    std::vector<std::vector<int>> clauseOcc;   // Literal -> clauses containing it
+    std::vector<std::vector<int>> cubeOcc;     // Literal -> cubes containing it
+    int numOriginal;                           // Original clauses come first
+    int numSymmetryCubes;                      // ... then the symmetry-breaking cubes
+    bool rescanPending;                        // Clauses changed since the last search
+    std::vector<int> satCount;                 // True literals per original clause
+    int numSatisfied;                          // Original clauses with satCount > 0
+
+    // Dual propagation: gate definitions found in the original clauses
+    bool dual;
+    std::vector<int> gateOf;                   // Original clause -> gate it defines, 0 = none
+    std::vector<std::vector<int>> gateDefs;    // Variable -> its definition clauses (gates only)
+    int numRest;                               // Original clauses that define no gate
+    int numSatisfiedRest;                      // ... of which satisfied
+    int numOpenDefs;                           // Unsatisfied definitions of assigned gates
+
+    // Dependency learning: variable -> learned dependencies (sorted). Only
+    // used while depLearning is on; otherwise the prefix decides.
+    bool depRequested;
+    bool depLearning;
+    std::vector<std::vector<int>> dependencies;
+
+    // Heuristic parameters
+    double varInc;
+    double constraintInc;
+    size_t maxLearned;
+
+    // Interchangeable universal variables, broken by cubes (vi ∧ ¬vi+1)
+    std::vector<std::vector<int>> universalSymmetries;
+
+    // Anytime reports about the outermost EXISTS block (see QBFOuter.h)
+    OuterCallback outerCallback;
+    OuterTracker outer;
+    std::vector<bool> outerVar;         // Variable belongs to the tracked block
+    size_t forcedScanned;               // Level-0 trail entries already reported
+    std::vector<int> winningLits;       // Existential literals proving SAT
+
+    double timeLimit;                   // Seconds, 0 = unlimited
+    SearchProfile* profile;             // Per-variable statistics, nullptr = off
+
+    // Portfolio worker (see QBFPortfolio.h)
+    ConstraintSharing* sharing;         // nullptr = solving alone
+    int workerId;                       // Also selects the search variant
+    long long restartUnit;              // Conflicts per Luby unit
+
+    std::unordered_map<int, bool> assignments;
+    SolverStats stats;
+    bool verbose;
+
+    // Setup
+    void reset();
+    void buildLevels(const QBFPreprocessor& preprocessor, const std::vector<Clause>& clauses);
+    int addConstraint(const std::vector<int>& lits, bool isCube, bool learned);
+
+    // Assignment
+    int litValue(int lit) const;
+    int decisionLevel() const { return trailLim.size(); }
+    void assign(int lit, int reasonIndex);
+    void backtrack(int targetLevel);
+    int pickBranchLiteral();
+
+    // Dependencies
+    bool dependsOn(int var, int on) const;
+    bool hasOpenDependency(int index, int var) const;
+    void addDependency(int var, int on);
+    long long countPrefixDependencies() const;
+
+    // Propagation
+    Status checkClause(int index, int& unitLit) const;
+    Status checkCube(int index, int& unitLit) const;
+    Status propagate(int& culprit);
+    Status rescanLevelZero(int& culprit);
+    bool againstAssumptions(int index) const;
+    void detectGates();
+    bool dualSolution() const;
+
+    // Learning
+    void reduceConstraint(std::vector<int>& lits, bool isCube, std::vector<int>* merged = nullptr) const;
+    bool importable(std::vector<int>& lits, bool isCube) const;
+    std::vector<int> initialCube() const;
+    std::vector<int> winningCube(int culprit) const;
+    std::vector<int> decisionConstraint(bool isCube) const;
+    bool isAsserting(const std::vector<int>& lits, const std::vector<int>& merged, bool isCube,
+                     int& assertLit, int& backjumpLevel) const;
+    Lesson analyze(std::vector<int> lits, bool isCube, std::vector<int>& learnt,
+                   std::vector<int>& learntMerged, int& assertLit, int& backjumpLevel);
+    bool isRedundant(int lit, bool isCube, const std::vector<bool>& inLearnt,
+                     std::vector<signed char>& memo, int depth) const;
+    void minimizeLearned(std::vector<int>& learnt, std::vector<int>& merged, bool isCube,
+                         int& assertLit, int& backjumpLevel);
+    int computeLBD(const std::vector<int>& lits) const;
+    void bumpVariables(const std::vector<int>& lits);
+    void reduceDatabase();
+
+    // Search
+    Result search(bool rescan);
+
+    // Anytime reports
+    int outerValue(int var) const;
+    void reportForcedOuter();
+
+    // Verbose output helpers
+    void log(const std::string& msg) const;
+    std::string litToString(int lit) const;
+    std::string constraintToString(const std::vector<int>& lits, bool isCube,
+                                   const std::vector<int>& merged = {}) const;
+
+public:
+    QCDCLSolver();
+
+    // Main entry point - solves the preprocessed formula
+    Result solve(const QBFPreprocessor& preprocessor);
+
+    // Solve the same formula again with outer-block literals assumed
+    // (call after solve). SAT: a winning assignment contains them all;
+    // UNSAT: none does. Learned clauses and cubes carry over.
+    Result solveAssuming(const std::vector<Literal>& outerLits);
+
+    // Add a clause over outer-block variables (call between solves), e.g.
+    // to block outer assignments that were already found. Learned clauses
+    // carry over, learned cubes only if they satisfy the new clause.
+    void addOuterClause(const std::vector<Literal>& outerLits);
+
+    // Existential literals of the last SAT answer's winning cube: EXISTS
+    // wins by playing them, whatever the other variables are
+    std::vector<Literal> getWinningLiterals() const;
+
+    // Value of an existential variable implied at decision level 0 (it
+    // holds in every winning assignment), -1 if there is none
+    int levelZeroValue(int var) const;
+
+    // Enable verbose mode for step-by-step tracing
+    void setVerbose(bool v);
+
+    // Skip FORALL moves that are symmetric to sorted ones
+    void setSymmetries(const SymmetryInfo& symmetries);
+
+    // Report outer-block candidates and forced literals during the search
+    void setOuterCallback(const OuterCallback& callback);
+
+    // Give up with Result::UNKNOWN after this many seconds (0 = no limit)
+    void setTimeLimit(double seconds);
+
+    // Collect per-variable statistics into profile (nullptr = off)
+    void setProfile(SearchProfile* profile);
+
+    // Detect gate definitions and report solutions through them
+    void setDualPropagation(bool enabled);
+
+    // Start without dependencies and learn them from failed resolutions
+    void setDependencyLearning(bool enabled);
+
+    // Run as portfolio worker `worker`: exchange learned constraints
+    // through sharing and use that worker's search variant
+    void setSharing(ConstraintSharing* sharing, int worker);
+
+    // Final assignments (preprocessing + trail at the end of the search)
+    const std::unordered_map<int, bool>& getAssignments() const;
+
+    // Counters from the last solve() call
+    const SolverStats& getStats() const;
+};
+
+#endif // QCDCL_SOLVER_H
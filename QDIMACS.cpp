@@ -0,0 +1,125 @@
+/*
+ * QDIMACS.cpp - QDIMACS parser and writer
+ */
+
+#include "QDIMACS.h"
+#include <algorithm>
+#include <cstdlib>
+#include <fstream>
+#include <iostream>
+#include <sstream>
+
+int QBFFormula::maxVariable() const {
+    int maxVar = 0;
+    for (const auto& block : blocks) {
+        for (int var : block.variables) maxVar = std::max(maxVar, var);
+    }
+    for (const auto& clause : clauses) {
+        for (const auto& lit : clause) maxVar = std::max(maxVar, lit.variable);
+    }
+    return maxVar;
+}
+
+/*
+ * Parse line by line. The counts in the problem line are not trusted
+ * (many generators get them wrong); the writer recomputes them.
+ */
+bool parseQDIMACS(std::istream& in, QBFFormula& formula, std::string& error) {
+    formula = QBFFormula();
+    std::string line;
+    int lineNumber = 0;
+
+    while (std::getline(in, line)) {
+        lineNumber++;
+        std::istringstream iss(line);
+        std::string first;
+        if (!(iss >> first)) continue;  // Blank line
+
+        // Quantifier block: 'a' for FORALL, 'e' for EXISTS; clauses start
+        // with a number. Everything else (comments "c", the problem line
+        // "p", stray "%" lines) is skipped.
+        bool isBlock = (first == "a" || first == "e");
+        bool isClause = (first[0] == '-' || (first[0] >= '0' && first[0] <= '9'));
+        if (!isBlock && !isClause) continue;
+        if (isClause) iss.seekg(0);  // Parse the whole line
+
+        std::vector<int> numbers;
+        long long value;
+        bool terminated = false;
+        while (iss >> value) {
+            if (value == 0) {
+                terminated = true;
+                break;
+            }
+            if (value < -1000000000LL || value > 1000000000LL) {
+                error = "line " + std::to_string(lineNumber) + ": variable out of range";
+                return false;
+            }
+            numbers.push_back((int)value);
+        }
+        if (!terminated && !iss.eof()) {
+            error = "line " + std::to_string(lineNumber) + ": unexpected token";
+            return false;
+        }
+
+        if (isBlock) {
+            for (int var : numbers) {
+                if (var <= 0) {
+                    error = "line " + std::to_string(lineNumber) + ": bad variable in prefix";
+                    return false;
+                }
+            }
+            formula.blocks.push_back({first == "a" ? Quantifier::FORALL : Quantifier::EXISTS,
+                                      numbers});
+        } else if (!numbers.empty()) {
+            Clause clause;
+            for (int lit : numbers) clause.push_back(Literal(std::abs(lit), lit < 0));
+            formula.clauses.push_back(clause);
+        }
+    }
+    return true;
+}
+
+bool readQDIMACS(const std::string& filename, QBFFormula& formula) {
+    std::ifstream file(filename);
+    if (!file.is_open()) {
+        std::cerr << "Error: Cannot open file '" << filename << "'" << std::endl;
+        return false;
+    }
+    std::string error;
+    if (!parseQDIMACS(file, formula, error)) {
+        std::cerr << "Error: " << filename << ": " << error << std::endl;
+        return false;
+    }
+    return true;
+}
+
+void writeQDIMACS(std::ostream& out, const QBFFormula& formula) {
+    out << "p cnf " << formula.maxVariable() << " " << formula.clauses.size() << "\n";
+    for (const auto& block : formula.blocks) {
+        if (block.variables.empty()) continue;  // "a 0" is not valid QDIMACS
+        out << (block.type == Quantifier::FORALL ? "a" : "e");
+        for (int var : block.variables) out << " " << var;
+        out << " 0\n";
+    }
+    for (const auto& clause : formula.clauses) {
+        for (const auto& lit : clause) out << (lit.isNegated ? -lit.variable : lit.variable) << " ";
+        out << "0\n";
+    }
+}
+
+bool writeQDIMACS(const std::string& filename, const QBFFormula& formula) {
+    std::ofstream out(filename);
+    if (!out) return false;
+    writeQDIMACS(out, formula);
+    return static_cast<bool>(out);
+}
+
+void loadFormula(const QBFFormula& formula, QBFPreprocessor& preprocessor) {
+    for (const auto& block : formula.blocks) {
+        preprocessor.addQuantifierBlock(block.type, block.variables);
+    }
+    for (const auto& clause : formula.clauses) {
+        preprocessor.addClause(clause);
+    }
+}
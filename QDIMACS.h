@@ -0,0 +1,52 @@
+/*
+ * QDIMACS.h - Reading and Writing QBF Formulas in QDIMACS Format
+ *
+ * QDIMACS FORMAT:
+ * ===============
+ * c This is a comment
+ * p cnf <num_vars> <num_clauses>
+ * a 1 2 3 0          <- universal variables (FORALL)
+ * e 4 5 6 0          <- existential variables (EXISTS)
+ * 1 -2 3 0           <- clause: x1 OR NOT x2 OR x3
+ * -1 4 0             <- clause: NOT x1 OR x4
+ *
+ * Variables are positive integers.
+ * Negation is indicated by negative sign.
+ * Lines end with 0.
+ *
+ * The solver, the fuzzer and the reducer all read formulas through this
+ * module, so they agree on every detail of the format. A QBFFormula is
+ * the plain parsed formula; loadFormula() hands it to a preprocessor.
+ */
+
+#ifndef QDIMACS_H
+#define QDIMACS_H
+
+#include "QBFPreprocessor.h"
+#include <iosfwd>
+#include <string>
+#include <vector>
+
+// A formula exactly as written in the file (nothing simplified)
+struct QBFFormula {
+    std::vector<QuantifierBlock> blocks;
+    std::vector<Clause> clauses;
+
+    // Largest variable number in the prefix or the clauses
+    int maxVariable() const;
+};
+
+// Parse QDIMACS text; returns false on malformed input
+bool parseQDIMACS(std::istream& in, QBFFormula& formula, std::string& error);
+
+// Read a QDIMACS file; prints an error message and returns false on failure
+bool readQDIMACS(const std::string& filename, QBFFormula& formula);
+
+// Write a formula in QDIMACS format (with a correct "p cnf" line)
+void writeQDIMACS(std::ostream& out, const QBFFormula& formula);
+bool writeQDIMACS(const std::string& filename, const QBFFormula& formula);
+
+// Add the formula's prefix and clauses to a (fresh) preprocessor
+void loadFormula(const QBFFormula& formula, QBFPreprocessor& preprocessor);
+
+#endif // QDIMACS_H
@@ -0,0 +1,362 @@
+/*
+ * TreeDPSolver.cpp - Bucket elimination with bit-packed truth tables
+ */
+
+#include "TreeDPSolver.h"
+#include "QBFFeatures.h"
+#include <algorithm>
+#include <iostream>
+
+// Tables of 2^31 bits and more would not be worth waiting for
+static const int MAX_WIDTH_LIMIT = 30;
+
+TreeDPSolver::TreeDPSolver()
+    : maxWidth(20), tooWide(false), aborted(false), verbose(false), timeLimit(0), opsSinceCheck(0) {}
+
+void TreeDPSolver::setVerbose(bool enabled) {
+    verbose = enabled;
+}
+
+void TreeDPSolver::setTimeLimit(double seconds) {
+    timeLimit = seconds;
+}
+
+void TreeDPSolver::setMaxWidth(int width) {
+    maxWidth = std::max(0, std::min(width, MAX_WIDTH_LIMIT));
+}
+
+void TreeDPSolver::setOuterCallback(const OuterCallback& callback) {
+    outerCallback = callback;
+}
+
+// ============================================================================
+// Tables
+// ============================================================================
+
+bool TreeDPSolver::valueAt(const Table& table, uint64_t index) {
+    return (table.bits[index >> 6] >> (index & 63)) & 1;
+}
+
+static std::vector<uint64_t> allTrue(int numVars) {
+    size_t entries = (size_t)1 << numVars;
+    return std::vector<uint64_t>((entries + 63) / 64, ~0ULL);
+}
+
+// True everywhere except where every literal is false
+TreeDPSolver::Table TreeDPSolver::clauseTable(const Clause& clause,
+                                              const std::unordered_map<int, int>& position) const {
+    Table table;
+    for (const auto& lit : clause) table.scope.push_back(position.at(lit.variable));
+    std::sort(table.scope.begin(), table.scope.end());
+    table.scope.erase(std::unique(table.scope.begin(), table.scope.end()), table.scope.end());
+    table.bits = allTrue(table.scope.size());
+
+    // x ∨ ¬x: true everywhere
+    uint64_t falsifying = 0;
+    std::vector<int> seen(table.scope.size(), -1);
+    for (const auto& lit : clause) {
+        size_t i = std::lower_bound(table.scope.begin(), table.scope.end(), position.at(lit.variable)) -
+                   table.scope.begin();
+        int value = lit.isNegated ? 1 : 0;
+        if (seen[i] >= 0 && seen[i] != value) return table;
+        seen[i] = value;
+        if (value) falsifying |= 1ULL << i;
+    }
+    table.bits[falsifying >> 6] &= ~(1ULL << (falsifying & 63));
+    return table;
+}
+
+bool TreeDPSolver::budget() {
+    if (aborted) return false;
+    if (timeLimit > 0 && ++opsSinceCheck >= 1024) {
+        opsSinceCheck = 0;
+        if (std::chrono::steady_clock::now() >= deadline) aborted = true;
+    }
+    return !aborted;
+}
+
+/*
+ * Conjunction over the union of the scopes. The index of an entry in a
+ * table is picked out of the joined index bit by bit; lookup tables per
+ * byte of the joined index do that in a few steps.
+ */
+bool TreeDPSolver::join(const std::vector<Table>& tables, Table& joined) {
+    joined.scope.clear();
+    for (const auto& table : tables) {
+        std::vector<int> merged;
+        std::set_union(joined.scope.begin(), joined.scope.end(), table.scope.begin(), table.scope.end(),
+                       std::back_inserter(merged));
+        joined.scope.swap(merged);
+    }
+    int k = joined.scope.size();
+    joined.bits = allTrue(k);
+    uint64_t entries = 1ULL << k;
+    int bytes = (k + 7) / 8;
+
+    for (const auto& table : tables) {
+        std::vector<uint64_t> lookup(bytes * 256, 0);
+        for (int i = 0, j = 0; i < k && j < (int)table.scope.size(); i++) {
+            if (joined.scope[i] != table.scope[j]) continue;
+            for (int x = 0; x < 256; x++) {
+                if ((x >> (i % 8)) & 1) lookup[(i / 8) * 256 + x] |= 1ULL << j;
+            }
+            j++;
+        }
+        for (uint64_t word = 0; word < joined.bits.size(); word++) {
+            if (joined.bits[word] == 0) continue;
+            if (!budget()) return false;
+            uint64_t end = std::min(entries, (word + 1) * 64);
+            for (uint64_t a = word * 64; a < end; a++) {
+                uint64_t index = 0;
+                for (int b = 0; b < bytes; b++) index |= lookup[b * 256 + ((a >> (8 * b)) & 255)];
+                if (!valueAt(table, index)) joined.bits[word] &= ~(1ULL << (a & 63));
+            }
+        }
+    }
+    return true;
+}
+
+// Quantify the first variable of the scope (the bucket's) out
+TreeDPSolver::Table TreeDPSolver::project(const Table& joined, bool exists) {
+    Table result;
+    result.scope.assign(joined.scope.begin() + 1, joined.scope.end());
+    result.bits.assign((((size_t)1 << result.scope.size()) + 63) / 64, 0);
+    uint64_t entries = 1ULL << result.scope.size();
+    for (uint64_t r = 0; r < entries; r++) {
+        bool lo = valueAt(joined, 2 * r), hi = valueAt(joined, 2 * r + 1);
+        if (exists ? (lo || hi) : (lo && hi)) result.bits[r >> 6] |= 1ULL << (r & 63);
+    }
+    return result;
+}
+
+// Drop the variables the table does not depend on
+void TreeDPSolver::compact(Table& table) {
+    for (int i = (int)table.scope.size() - 1; i >= 0; i--) {
+        uint64_t entries = 1ULL << table.scope.size();
+        uint64_t bit = 1ULL << i;
+        bool depends = false;
+        for (uint64_t a = 0; a < entries && !depends; a++) {
+            if (!(a & bit)) depends = valueAt(table, a) != valueAt(table, a | bit);
+        }
+        if (depends) continue;
+
+        Table smaller;
+        smaller.scope = table.scope;
+        smaller.scope.erase(smaller.scope.begin() + i);
+        smaller.bits.assign(((entries / 2) + 63) / 64, 0);
+        for (uint64_t r = 0; r < entries / 2; r++) {
+            uint64_t a = (r & (bit - 1)) | ((r & ~(bit - 1)) << 1);
+            if (valueAt(table, a)) smaller.bits[r >> 6] |= 1ULL << (r & 63);
+        }
+        table = std::move(smaller);
+    }
+}
+
+// Into the bucket of its first variable (constant tables are handled by the caller)
+void TreeDPSolver::place(Table table) {
+    int first = table.scope[0];
+    buckets[first].push_back(std::move(table));
+}
+
+// ============================================================================
+// Elimination
+// ============================================================================
+
+bool TreeDPSolver::eliminate(int from, int to, std::vector<std::vector<Table>>* kept) {
+    for (int p = from; p < to; p++) {
+        std::vector<Table> tables = std::move(buckets[p]);
+        buckets[p].clear();
+        if (tables.empty()) continue;
+
+        Table joined;
+        if (!join(tables, joined)) return true;
+        stats.dpLargestTable = std::max(stats.dpLargestTable, 1LL << joined.scope.size());
+        Table result = project(joined, !varUniversal[p]);
+        compact(result);
+        bool constant = result.scope.empty();
+        bool value = constant && (result.bits[0] & 1);
+
+        if (verbose) {
+            std::cout << "[DP] " << (varUniversal[p] ? "FORALL " : "EXISTS ") << varString(p) << ": "
+                      << tables.size() << (tables.size() == 1 ? " table" : " tables") << ", bag of "
+                      << joined.scope.size() << " variables -> "
+                      << (!constant ? "table over " + std::to_string(result.scope.size()) + " variables"
+                                    : value ? std::string("true") : std::string("false"))
+                      << std::endl;
+        }
+        if (kept) (*kept)[p - from] = std::move(tables);
+        if (constant) {
+            if (!value) return false;
+            continue;
+        }
+        place(std::move(result));
+    }
+    return true;
+}
+
+/*
+ * Eliminate the outer group from the tables waiting for it, with var =
+ * value assumed if var >= 0, then walk its buckets back: the variable
+ * eliminated last has no other variable left in its tables, the one
+ * before only that one, and so on, so each gets a value under which all
+ * of its bucket's tables hold.
+ */
+bool TreeDPSolver::solveOuter(int from, const std::vector<std::vector<Table>>& waiting, int assumedVar,
+                              bool assumedValue, std::unordered_map<int, bool>& plan) {
+    int n = varName.size();
+    for (int p = from; p < n; p++) buckets[p] = waiting[p - from];
+    if (assumedVar >= 0) {
+        Table unit{{assumedVar}, {assumedValue ? 2ULL : 1ULL}};
+        place(std::move(unit));
+    }
+    std::vector<std::vector<Table>> kept(n - from);
+    if (!eliminate(from, n, &kept) || aborted) return false;
+
+    std::vector<bool> valueOf(n, false);
+    for (int p = n - 1; p >= from; p--) {
+        for (bool value : {true, false}) {
+            valueOf[p] = value;
+            bool holds = std::all_of(kept[p - from].begin(), kept[p - from].end(), [&](const Table& table) {
+                uint64_t index = 0;
+                for (size_t i = 0; i < table.scope.size(); i++) {
+                    if (valueOf[table.scope[i]]) index |= 1ULL << i;
+                }
+                return valueAt(table, index);
+            });
+            if (holds) break;
+        }
+        plan[varName[p]] = valueOf[p];
+    }
+    return true;
+}
+
+/*
+ * Forced outer literals, as in QBFBackbone: each value of the winning
+ * assignment is a candidate; it is forced if the outer group loses with
+ * it flipped, and every winning assignment found on the way rules out the
+ * candidates it disagrees with.
+ */
+void TreeDPSolver::reportOuter(int from, const std::vector<std::vector<Table>>& waiting, Result result,
+                               const std::unordered_map<int, bool>& plan) {
+    if (!outer.active()) return;
+    if (result == Result::SAT) {
+        int n = varName.size();
+        std::vector<bool> candidate(n, false);
+        for (int p = from; p < n; p++) candidate[p] = outer.isOuter(varName[p]);
+        for (int p = from; p < n && !aborted; p++) {
+            if (!candidate[p]) continue;
+            bool value = plan.at(varName[p]);
+            std::unordered_map<int, bool> other;
+            if (!solveOuter(from, waiting, p, !value, other)) {
+                if (aborted) break;
+                if (verbose) {
+                    std::cout << "[OUTER] " << varString(p) << "=" << (value ? "true" : "false")
+                              << " is forced in every winning assignment" << std::endl;
+                }
+                outer.forcedFound(varName[p], value);
+                continue;
+            }
+            for (int q = p + 1; q < n; q++) {
+                if (candidate[q] && other[varName[q]] != plan.at(varName[q])) candidate[q] = false;
+            }
+        }
+        for (const auto& [var, value] : plan) assignments[var] = value;
+    }
+    outer.finish(result == Result::SAT, result == Result::UNSAT, [&](int var) {
+        auto it = assignments.find(var);
+        if (it != assignments.end()) return it->second ? 1 : 0;
+        return -1;
+    });
+}
+
+// ============================================================================
+// Main Entry Point
+// ============================================================================
+
+Result TreeDPSolver::solve(const QBFPreprocessor& preprocessor) {
+    stats = SolverStats();
+    stats.engine = "treedp";
+    tooWide = aborted = false;
+    opsSinceCheck = 0;
+    if (timeLimit > 0) {
+        deadline = std::chrono::steady_clock::now() +
+                   std::chrono::duration_cast<std::chrono::steady_clock::duration>(
+                       std::chrono::duration<double>(timeLimit));
+    }
+    outer.reset(preprocessor, outerCallback);
+    assignments = preprocessor.getAssignments();
+
+    // The decomposition decides the cost before any table exists
+    int width = 0;
+    varName = prefixEliminationOrder(preprocessor, maxWidth, width);
+    if (width > maxWidth) {
+        tooWide = true;
+        if (verbose) {
+            std::cout << "[DP] Tree width above " << maxWidth << ": no decomposition within the limit"
+                      << std::endl;
+        }
+        return Result::UNKNOWN;
+    }
+    stats.treeWidth = width;
+
+    std::unordered_map<int, Quantifier> quantifierOf;
+    for (const auto& block : preprocessor.getQuantifierBlocks()) {
+        for (int var : block.variables) quantifierOf[var] = block.type;
+    }
+    int n = varName.size();
+    std::unordered_map<int, int> position;
+    varUniversal.assign(n, false);
+    for (int p = 0; p < n; p++) {
+        position[varName[p]] = p;
+        auto it = quantifierOf.find(varName[p]);
+        varUniversal[p] = (it != quantifierOf.end() && it->second == Quantifier::FORALL);
+    }
+
+    buckets.assign(n, {});
+    bool refuted = false;
+    int numTables = 0;
+    for (const auto& clause : preprocessor.getClauses()) {
+        if (clause.empty()) {
+            refuted = true;
+            continue;
+        }
+        Table table = clauseTable(clause, position);
+        compact(table);
+        if (table.scope.empty()) continue;  // Tautology
+        place(std::move(table));
+        numTables++;
+    }
+    if (verbose) {
+        std::cout << "[SOLVE] Tree decomposition of width " << width << " (min-fill within quantifier blocks): "
+                  << numTables << " clause tables over " << n << " variables" << std::endl;
+    }
+
+    // The outer EXISTS group is eliminated last; with outer reports its
+    // tables are kept for the walk back
+    int from = n;
+    if (outer.active()) {
+        while (from > 0 && !varUniversal[from - 1]) from--;
+    }
+    if (!refuted) refuted = !eliminate(0, from, nullptr);
+    std::vector<std::vector<Table>> waiting;
+    std::unordered_map<int, bool> plan;
+    if (!refuted && !aborted && from < n) {
+        waiting.assign(buckets.begin() + from, buckets.end());
+        refuted = !solveOuter(from, waiting, -1, false, plan);
+    }
+
+    Result result = Result::SAT;
+    if (aborted) {
+        result = Result::UNKNOWN;
+        if (verbose) std::cout << "[TIMEOUT] Time limit reached" << std::endl;
+    } else if (refuted) {
+        result = Result::UNSAT;
+    }
+    if (verbose && result != Result::UNKNOWN) {
+        std::cout << "[DP] " << (result == Result::UNSAT ? "A table became false: false"
+                                                         : "Every variable eliminated: true")
+                  << " (largest table " << stats.dpLargestTable << " entries)" << std::endl;
+    }
+    reportOuter(from, waiting, result, plan);
+    return result;
+}
@@ -0,0 +1,140 @@
+/*
+ * TreeDPSolver.h - QBF by Dynamic Programming over a Tree Decomposition
+ *
+ * Many structured formulas (circuits, planning horizons, chains of
+ * constraints) are built from small pieces that touch each other only
+ * through a few shared variables. Their PRIMAL GRAPH - variables, with an
+ * edge when two of them share a clause - then has small TREE WIDTH: it
+ * can be cut into overlapping BAGS of at most w+1 variables, arranged in
+ * a tree, such that every clause fits in some bag and the bags holding a
+ * variable form a connected subtree.
+ *
+ * A tree decomposition falls out of an ELIMINATION ORDER. Eliminating v
+ * makes its remaining neighbours pairwise adjacent; v together with those
+ * neighbours is a bag, and the width is the most neighbours any variable
+ * has when its turn comes. Min-fill (pick the variable that adds the
+ * fewest edges) is the classic greedy order. For QBF the order must also
+ * respect the prefix: a variable may only be eliminated once every
+ * variable inside its scope is gone, so the quantifier groups are taken
+ * from the innermost out and min-fill only chooses within a group.
+ *
+ * DYNAMIC PROGRAMMING (bucket elimination). Each clause becomes a TABLE:
+ * a Boolean function over its variables, stored as a truth table. Each
+ * table waits in the BUCKET of its variable eliminated first. In order,
+ * for each variable v:
+ *
+ *   1. JOIN the tables of v's bucket into one table over their union
+ *      (a bag: v and its neighbours, at most w+1 variables)
+ *   2. PROJECT v out:  ∃v T = T[v=0] ∨ T[v=1],  ∀v T = T[v=0] ∧ T[v=1]
+ *   3. Put the result into the bucket of its next variable
+ *
+ * This is correct because v is innermost among the variables left, and
+ * the tables outside its bucket do not mention v:
+ *
+ *   Qv (T1 ∧ ... ∧ Tk ∧ R) = (Qv (T1 ∧ ... ∧ Tk)) ∧ R
+ *
+ * A table that becomes constantly false ends the solve (UNSAT); once every
+ * variable is gone, the formula is true.
+ *
+ * COMPACT TABLES. A table over k variables is a bit vector of 2^k bits,
+ * 64 to a word, so the cost of a join is about 2^(w+1) word operations
+ * per table: governed by the width, not by the number of variables. The
+ * width is known before any table is built, so a formula that is too wide
+ * is turned down at once instead of running out of memory half-way.
+ * Tables are also kept as small as their function allows: a variable the
+ * table does not depend on is dropped from its scope, and constantly true
+ * tables are dropped altogether.
+ *
+ * With an outer callback (QBFOuter.h) the outer EXISTS group is eliminated
+ * last with its buckets kept; walking them back in reverse order picks a
+ * winning outer assignment, and re-running the outer group with a literal
+ * assumed tells whether that literal is forced.
+ */
+
+#ifndef TREE_DP_SOLVER_H
+#define TREE_DP_SOLVER_H
+
+#include "QBFOuter.h"
+#include "QBFPreprocessor.h"
+#include "QBFSolver.h"
+#include <chrono>
+#include <cstdint>
+#include <unordered_map>
+#include <vector>
+
+class TreeDPSolver {
+public:
+    TreeDPSolver();
+
+    void setVerbose(bool enabled);
+
+    // Give up with Result::UNKNOWN after this many seconds (0 = no limit)
+    void setTimeLimit(double seconds);
+
+    // Give up with Result::UNKNOWN, before building any table, when the
+    // decomposition is wider than this (tables of 2^(width+1) bits)
+    void setMaxWidth(int width);
+
+    // Report the winning outer assignment and the forced outer literals
+    void setOuterCallback(const OuterCallback& callback);
+
+    Result solve(const QBFPreprocessor& preprocessor);
+
+    // UNKNOWN because of the width limit (not the time limit)
+    bool exceededWidth() const { return tooWide; }
+
+    // Outer variables of the winning assignment (with an outer callback)
+    const std::unordered_map<int, bool>& getAssignments() const { return assignments; }
+
+    const SolverStats& getStats() const { return stats; }
+
+private:
+    // A Boolean function over scope, as a truth table: bit a of bits is
+    // its value where variable scope[i] has the value of bit i of a
+    struct Table {
+        std::vector<int> scope;        // Elimination positions, ascending
+        std::vector<uint64_t> bits;
+    };
+
+    // Formula in elimination positions 0..n-1 (original numbers in varName)
+    std::vector<int> varName;
+    std::vector<bool> varUniversal;
+    std::vector<std::vector<Table>> buckets;   // Position → tables waiting for it
+
+    int maxWidth;
+    bool tooWide;
+    bool aborted;                  // Time limit hit
+
+    bool verbose;
+    double timeLimit;
+    std::chrono::steady_clock::time_point deadline;
+    long long opsSinceCheck;
+
+    OuterCallback outerCallback;
+    OuterTracker outer;
+    std::unordered_map<int, bool> assignments;
+    SolverStats stats;
+
+    // Tables
+    static bool valueAt(const Table& table, uint64_t index);
+    Table clauseTable(const Clause& clause, const std::unordered_map<int, int>& position) const;
+    bool join(const std::vector<Table>& tables, Table& joined);
+    static Table project(const Table& joined, bool exists);
+    static void compact(Table& table);
+    void place(Table table);
+
+    // Elimination of positions [from, to); kept (if given) receives each
+    // bucket's tables. False if a table became false
+    bool eliminate(int from, int to, std::vector<std::vector<Table>>* kept);
+    bool budget();
+
+    // Outer group: a winning assignment (false: none, under assumed)
+    bool solveOuter(int from, const std::vector<std::vector<Table>>& waiting, int assumedVar, bool assumedValue,
+                    std::unordered_map<int, bool>& plan);
+    void reportOuter(int from, const std::vector<std::vector<Table>>& waiting, Result result,
+                     const std::unordered_map<int, bool>& plan);
+
+    std::string varString(int position) const { return "x" + std::to_string(varName[position]); }
+};
+
+#endif // TREE_DP_SOLVER_H
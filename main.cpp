@@ -6,19 +6,61 @@
  * USAGE:
  *   ./qbf <formula.qdimacs>           Solve the formula
  *   ./qbf -v <formula.qdimacs>        Solve with verbose tracing (educational mode)
+ *   ./qbf --engine=qcdcl <formula>    Force an engine (default: chosen automatically)
+ *   ./qbf --bdd-nodes=N <formula>     BDD engine gives up (and falls back) beyond N nodes
+ *   ./qbf --dp-width=N <formula>      Tree-decomposition engine falls back beyond width N
+ *   ./qbf --aig-nodes=N <formula>     AIG engine gives up (and falls back) beyond N nodes
+ *   ./qbf --incdet-conflicts=N <formula>  Determinization engine falls back after N conflicts
+ *   ./qbf --certificate=FILE <formula> Write the Skolem functions of a true 2QBF (engine incdet)
+ *   ./qbf --expand-clauses=N <formula>    Resolution/expansion engine falls back beyond N clauses
+ *   ./qbf --stats <formula>           Print solver statistics
+ *   ./qbf --symmetry <formula>        Force symmetry breaking (--no-symmetry disables it)
+ *   ./qbf --cache=DIR <formula>       Reuse results of identical or renamed formulas
+ *   ./qbf --outer <formula>           Report the outermost EXISTS values while solving
+ *   ./qbf --backbone <formula>        List the outermost EXISTS values every winning assignment has
+ *   ./qbf --enumerate-outer[=K] <formula> List (up to K) winning outermost EXISTS assignments
+ *   ./qbf --time-limit=SEC <formula>  Give up (UNKNOWN) after SEC seconds
+ *   ./qbf --profile=N <formula>       Show the N variables with the largest search subtrees
+ *   ./qbf --trace-out=FILE <formula>  Write a timeline of the solver phases (Chrome trace JSON)
+ *   ./qbf --pre-budget=TICKS <formula> Limit the effort of each preprocessing technique
+ *   ./qbf --pre-threads=N <formula>   Threads for preprocessing large formulas
+ *   ./qbf --threads=N <formula>       Parallel QCDCL portfolio (--deterministic: reproducible)
+ *   ./qbf --dual <formula>            QCDCL with gate-aware solution detection (--no-dual disables it)
+ *   ./qbf --dep-learning <formula>    QCDCL learns variable dependencies instead of following the prefix
  *
  * The solver reads formulas in QDIMACS format, a standard format for QBF.
  * Use -v to see step-by-step how the algorithm explores the search tree.
  */
 
+#include <algorithm>
+#include <chrono>
+#include <climits>
+#include <cmath>
 #include <cstdlib>
-#include <iostream>
 #include <fstream>
-#include <sstream>
+#include <iomanip>
+#include <iostream>
 #include <string>
+#include <thread>
 #include <vector>
 #include "QBFPreprocessor.h"
 #include "QBFSolver.h"
+#include "QCDCLSolver.h"
+#include "BDDSolver.h"
+#include "TreeDPSolver.h"
+#include "AIGSolver.h"
+#include "IncDetSolver.h"
+#include "ExpansionSolver.h"
+#include "QBFFeatures.h"
+#include "QBFSymmetry.h"
+#include "QBFCache.h"
+#include "QBFOuter.h"
+#include "QBFBackbone.h"
+#include "QBFEnumerate.h"
+#include "QBFProfile.h"
+#include "QBFTrace.h"
+#include "QBFPortfolio.h"
+#include "QDIMACS.h"
 
 /*
  * Print a single clause in human-readable form.
@@ -58,87 +100,260 @@ void printQuantifierBlock(const QuantifierBlock& block) {
 }
 
 /*
- * Read a QBF formula from a QDIMACS file.
- *
- * QDIMACS FORMAT:
- * ===============
- * c This is a comment
- * p cnf <num_vars> <num_clauses>
- * a 1 2 3 0          <- universal variables (FORALL)
- * e 4 5 6 0          <- existential variables (EXISTS)
- * 1 -2 3 0           <- clause: x1 OR NOT x2 OR x3
- * -1 4 0             <- clause: NOT x1 OR x4
- *
- * Variables are positive integers.
- * Negation is indicated by negative sign.
- * Lines end with 0.
+ * Read a QBF formula from a QDIMACS file (the format is described in
+ * QDIMACS.h) and hand it to the preprocessor.
  */
 bool readQBF(const std::string& filename, QBFPreprocessor& preprocessor, bool verbose) {
-    std::ifstream file(filename);
-    if (!file.is_open()) {
-        std::cerr << "Error: Cannot open file '" << filename << "'" << std::endl;
+    QBFFormula formula;
+    if (!readQDIMACS(filename, formula)) {
         return false;
     }
 
-    std::string line;
-    int clauseCount = 0;
-
-    while (std::getline(file, line)) {
-        if (line.empty()) continue;
+    if (verbose) {
+        for (const auto& block : formula.blocks) {
+            std::cout << "[PARSE] Quantifier block: "
+                      << (block.type == Quantifier::FORALL ? "FORALL" : "EXISTS") << " ";
+            for (size_t i = 0; i < block.variables.size(); i++) {
+                std::cout << "x" << block.variables[i];
+                if (i < block.variables.size() - 1) std::cout << ", ";
+            }
+            std::cout << std::endl;
+        }
+        std::cout << "[PARSE] Read " << formula.clauses.size() << " clauses" << std::endl;
+    }
 
-        std::istringstream iss(line);
-        char type;
-        iss >> type;
+    loadFormula(formula, preprocessor);
+    return true;
+}
 
-        // Skip comments and problem line
-        if (type == 'c' || type == 'p') {
-            continue;
+/*
+ * Print the final answer.
+ */
+void printResult(Result result, bool verbose) {
+    std::cout << std::endl;
+    if (result == Result::SAT) {
+        std::cout << "SATISFIABLE" << std::endl;
+        if (verbose) {
+            std::cout << std::endl << "The EXISTS player has a winning strategy." << std::endl;
         }
-
-        // Quantifier block: 'a' for FORALL, 'e' for EXISTS
-        if (type == 'a' || type == 'e') {
-            std::vector<int> variables;
-            int var;
-            while (iss >> var && var != 0) {
-                variables.push_back(var);
-            }
-            preprocessor.addQuantifierBlock(
-                type == 'a' ? Quantifier::FORALL : Quantifier::EXISTS,
-                variables
-            );
-            if (verbose) {
-                std::cout << "[PARSE] Quantifier block: "
-                          << (type == 'a' ? "FORALL" : "EXISTS") << " ";
-                for (size_t i = 0; i < variables.size(); i++) {
-                    std::cout << "x" << variables[i];
-                    if (i < variables.size() - 1) std::cout << ", ";
-                }
-                std::cout << std::endl;
-            }
+    } else if (result == Result::UNSAT) {
+        std::cout << "UNSATISFIABLE" << std::endl;
+        if (verbose) {
+            std::cout << std::endl << "The FORALL player can always falsify the formula." << std::endl;
         }
-        // Clause (starts with a number)
-        else if (type == '-' || (type >= '1' && type <= '9')) {
-            // Put the first character back and parse the whole line
-            std::istringstream clauseStream(line);
-            std::vector<Literal> clause;
-            int var;
-            while (clauseStream >> var && var != 0) {
-                bool isNegated = var < 0;
-                clause.push_back(Literal(std::abs(var), isNegated));
-            }
-            if (!clause.empty()) {
-                preprocessor.addClause(clause);
-                clauseCount++;
-            }
+    } else {
+        std::cout << "UNKNOWN" << std::endl;
+        if (verbose) {
+            std::cout << std::endl << "The time limit was reached before the game was decided." << std::endl;
         }
     }
+}
 
-    file.close();
+// Exit code: 0 = SAT, 1 = UNSAT (or error), 2 = UNKNOWN
+int exitCode(Result result) {
+    if (result == Result::SAT) return 0;
+    return (result == Result::UNSAT) ? 1 : 2;
+}
 
-    if (verbose) {
-        std::cout << "[PARSE] Read " << clauseCount << " clauses" << std::endl;
+// Format outer literals as "x1=true x2=false"
+std::string outerToString(const std::vector<Literal>& lits) {
+    if (lits.empty()) return "(none)";
+    std::string out;
+    for (const auto& lit : lits) {
+        if (!out.empty()) out += " ";
+        out += "x" + std::to_string(lit.variable) + (lit.isNegated ? "=false" : "=true");
+    }
+    return out;
+}
+
+/*
+ * Print an outer-block report (--outer). Each line is flushed right away
+ * so that a caller reading our output can act on it during the search.
+ */
+void printOuterProgress(const OuterProgress& progress, size_t& forcedShown) {
+    if (progress.forced.size() > forcedShown) {
+        forcedShown = progress.forced.size();
+        std::cout << "[OUTER] forced    : " << outerToString(progress.forced) << std::endl;
+        if (!progress.finished) return;
+    }
+    if (progress.finished) {
+        if (progress.proven) {
+            // An empty winning assignment means every outer value wins
+            std::cout << "[OUTER] winning   : "
+                      << (progress.candidate.empty() ? "any values" : outerToString(progress.candidate))
+                      << std::endl;
+        } else if (!progress.candidate.empty()) {
+            std::cout << "[OUTER] unproven  : " << outerToString(progress.candidate)
+                      << " (" << progress.score << " branches won)" << std::endl;
+        }
+    } else if (!progress.candidate.empty()) {
+        std::cout << "[OUTER] candidate : " << outerToString(progress.candidate)
+                  << " (" << progress.score << " branches won)" << std::endl;
+    }
+}
+
+/*
+ * Print solver statistics (--stats).
+ */
+void printStats(const SolverStats& stats, const FormulaFeatures& features,
+                const SymmetryInfo& symmetries) {
+    std::cout << "[STATS] preprocessing : " << stats.preprocessReason << std::endl;
+    std::cout << "[STATS] features      : " << featuresToString(features) << std::endl;
+    std::cout << "[STATS] symmetry      : " << symmetries.existentialGroups.size() << " EXISTS groups, "
+              << symmetries.universalGroups.size() << " FORALL groups, "
+              << symmetries.numBreakingConstraints() << " breaking constraints" << std::endl;
+    std::cout << "[STATS] engine        : " << stats.engine;
+    if (!stats.engineReason.empty()) std::cout << " (" << stats.engineReason << ")";
+    std::cout << std::endl;
+    std::cout << "[STATS] decisions     : " << stats.decisions << std::endl;
+    std::cout << "[STATS] propagations  : " << stats.propagations << std::endl;
+    std::cout << "[STATS] conflicts     : " << stats.conflicts << std::endl;
+    std::cout << "[STATS] solutions     : " << stats.solutions << std::endl;
+    std::cout << "[STATS] learned       : " << stats.learnedClauses << " clauses, "
+              << stats.learnedCubes << " cubes" << std::endl;
+    if (stats.minimizedLits > 0) {
+        std::cout << "[STATS] minimized     : " << stats.minimizedLits << " literals" << std::endl;
+    }
+    if (stats.longDistance > 0) {
+        std::cout << "[STATS] long-distance : " << stats.longDistance
+                  << " resolution steps merging literals" << std::endl;
+    }
+    std::cout << "[STATS] restarts      : " << stats.restarts << std::endl;
+    std::cout << "[STATS] reused phases : " << stats.reusedPhases << std::endl;
+    std::cout << "[STATS] symmetry cuts : " << stats.symmetryPrunes << std::endl;
+    if (stats.gates > 0) {
+        std::cout << "[STATS] dual          : " << stats.gates << " gates, "
+                  << stats.dualSolutions << " early solutions" << std::endl;
+    }
+    if (stats.prefixDependencies > 0) {
+        std::cout << "[STATS] dependencies  : " << stats.dependencies << " learned of "
+                  << stats.prefixDependencies << " in the prefix";
+        if (stats.dependencyFallbacks > 0) std::cout << ", fell back to the prefix";
+        std::cout << std::endl;
+    }
+    if (stats.bddPeakNodes > 0) {
+        std::cout << "[STATS] bdd           : " << stats.bddPeakNodes << " peak nodes, "
+                  << stats.bddReorderings << " reorderings" << std::endl;
+    }
+    if (stats.dpLargestTable > 0) {
+        std::cout << "[STATS] tree dp       : width " << stats.treeWidth << ", largest table "
+                  << stats.dpLargestTable << " entries" << std::endl;
+    }
+    if (stats.aigPeakNodes > 0) {
+        std::cout << "[STATS] aig           : " << stats.aigGates << " gates, " << stats.aigPeakNodes
+                  << " peak nodes, " << stats.aigMerges << " merged by sweeping" << std::endl;
+    }
+    if (stats.elimPeakClauses > 0) {
+        std::cout << "[STATS] expansion     : " << stats.resolvedVars << " resolved, " << stats.expandedVars
+                  << " expanded, peak " << stats.elimPeakClauses << " clauses" << std::endl;
+    }
+    if (stats.satCalls > 0) {
+        std::cout << "[STATS] determinized  : " << stats.detPropagated << " propagated, " << stats.detDecided
+                  << " decided, " << stats.satCalls << " SAT calls" << std::endl;
+    }
+    if (stats.workers > 1) {
+        std::cout << "[STATS] workers       : " << stats.workers << ", "
+                  << stats.imported << " constraints imported by the winner" << std::endl;
+    }
+}
+
+/*
+ * Print the search profile (--profile): the variables with the largest
+ * subtrees, then the same numbers per quantifier block.
+ */
+void printProfile(const SearchProfile& profile, size_t topN) {
+    auto quantifierName = [](Quantifier q) { return q == Quantifier::FORALL ? "FORALL" : "EXISTS"; };
+    auto blockName = [](int block) { return block < 0 ? std::string("free") : std::to_string(block + 1); };
+
+    std::cout << "[PROFILE] " << profile.totalDecisions() << " decisions" << std::endl;
+    std::cout << "[PROFILE] Top " << topN << " variables by subtree size:" << std::endl;
+    std::cout << "[PROFILE]   variable block  quant   decisions  conflicts     subtree   time (s)" << std::endl;
+    for (const auto& v : profile.topVariables(topN)) {
+        std::cout << "[PROFILE]   " << std::left << std::setw(8) << ("x" + std::to_string(v.variable))
+                  << " " << std::setw(6) << blockName(v.block) << " " << std::setw(6) << quantifierName(v.type)
+                  << std::right << std::setw(10) << v.decisions << std::setw(11) << v.conflicts
+                  << std::setw(12) << v.subtree << std::setw(11) << std::fixed << std::setprecision(3)
+                  << v.seconds << std::defaultfloat << std::endl;
+    }
+
+    std::cout << "[PROFILE] Per block (subtree and time below the block's first decision):" << std::endl;
+    std::cout << "[PROFILE]   block  quant    vars  decisions  conflicts     subtree   time (s)" << std::endl;
+    for (const auto& b : profile.blocks()) {
+        std::cout << "[PROFILE]   " << std::left << std::setw(6) << blockName(b.block) << " "
+                  << std::setw(6) << quantifierName(b.type) << std::right << std::setw(6) << b.numVars
+                  << std::setw(11) << b.decisions << std::setw(11) << b.conflicts << std::setw(12) << b.subtree
+                  << std::setw(11) << std::fixed << std::setprecision(3) << b.seconds << std::defaultfloat
+                  << std::endl;
+    }
+}
+
+/*
+ * Run an engine that may give up: BDD, tree DP, AIG, determinization or
+ * expansion. Afterwards limitHit() says why it gave up ("" if it did not).
+ * If it answered, result and stats are set and true is returned.
+ * Otherwise the fallback engine takes over with the time that is left:
+ * the reason is recorded, and the engine's counters are added to
+ * engineStats for the final stats.
+ */
+template <typename Solver, typename LimitHit>
+bool runWithFallback(Solver& solver, LimitHit limitHit, const char* name, EngineConfig& config,
+                     const QBFPreprocessor& preprocessor, const OuterCallback& onOuter, double& timeLimit,
+                     bool verbose, Result& result, SolverStats& stats, SolverStats& engineStats) {
+    auto start = std::chrono::steady_clock::now();
+    solver.setVerbose(verbose);
+    solver.setOuterCallback(onOuter);
+    solver.setTimeLimit(timeLimit);
+    {
+        TraceScope traced("solve", name);
+        result = solver.solve(preprocessor);
+    }
+    std::string why = limitHit();
+    if (why.empty()) {
+        stats = solver.getStats();
+        return true;
+    }
+    engineStats.mergeEngineCounters(solver.getStats());
+    config.engine = config.fallback;
+    config.reason += "; " + why + ", fell back to " + engineName(config.fallback);
+    if (verbose) std::cout << "[ENGINE] " << engineName(config.engine) << " (fallback)" << std::endl;
+    if (timeLimit > 0) {
+        double spent = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+        timeLimit = std::max(timeLimit - spent, 1e-3);
+    }
+    return false;
+}
+
+/*
+ * Write the --trace-out timeline, if one was requested.
+ */
+void finishTrace(const std::string& traceFile) {
+    if (!traceFile.empty() && !traceWrite(traceFile)) {
+        std::cerr << "Warning: Cannot write trace file '" << traceFile << "'" << std::endl;
     }
+}
 
+/*
+ * Parse a preprocessing pipeline like "pure,unit": the listed order
+ * becomes the priority order, "none" disables preprocessing. Each
+ * technique keeps the budget it has in the given pipeline.
+ */
+bool parsePipeline(const std::string& list, std::vector<ScheduledTechnique>& pipeline) {
+    std::vector<ScheduledTechnique> defaults = pipeline;
+    pipeline.clear();
+    if (list == "none") return true;
+    size_t start = 0;
+    while (start <= list.size()) {
+        size_t comma = list.find(',', start);
+        if (comma == std::string::npos) comma = list.size();
+        PreprocessTechnique technique;
+        if (!parseTechnique(list.substr(start, comma - start), technique)) return false;
+        long long budget = -1;
+        for (const auto& scheduled : defaults) {
+            if (scheduled.technique == technique) budget = scheduled.tickBudget;
+        }
+        pipeline.push_back({technique, (int)pipeline.size(), budget});
+        start = comma + 1;
+    }
     return true;
 }
 
@@ -148,10 +363,39 @@ bool readQBF(const std::string& filename, QBFPreprocessor& preprocessor, bool ve
 void printUsage(const char* programName) {
     std::cout << "QBF Solver - Educational Implementation" << std::endl;
     std::cout << std::endl;
-    std::cout << "Usage: " << programName << " [-v] <formula.qdimacs>" << std::endl;
+    std::cout << "Usage: " << programName << " [options] <formula.qdimacs>" << std::endl;
     std::cout << std::endl;
     std::cout << "Options:" << std::endl;
-    std::cout << "  -v    Verbose mode - show step-by-step solving trace" << std::endl;
+    std::cout << "  -v              Verbose mode - show step-by-step solving trace" << std::endl;
+    std::cout << "  --engine=NAME   Solving engine: auto (default), search, qcdcl, bdd, treedp, aig," << std::endl;
+    std::cout << "                  incdet, expand" << std::endl;
+    std::cout << "  --bdd-nodes=N   BDD engine falls back to the fallback engine (QCDCL) beyond N nodes (default 1000000)" << std::endl;
+    std::cout << "  --dp-width=N    Tree-decomposition engine falls back beyond width N (default 20)" << std::endl;
+    std::cout << "  --aig-nodes=N   AIG engine falls back to the fallback engine (QCDCL) beyond N nodes (default 1000000)" << std::endl;
+    std::cout << "  --incdet-conflicts=N  Determinization engine falls back after N conflicts (default 10000)" << std::endl;
+    std::cout << "  --expand-clauses=N  Resolution/expansion engine falls back beyond N clauses (default 200000)" << std::endl;
+    std::cout << "  --certificate=F Write the Skolem functions of a true 2QBF to F (AIGER, engine incdet)" << std::endl;
+    std::cout << "  --stats         Print solver statistics" << std::endl;
+    std::cout << "  --symmetry      Always detect and break symmetries" << std::endl;
+    std::cout << "  --no-symmetry   Never break symmetries" << std::endl;
+    std::cout << "  --cache=DIR     Look up / store results by formula fingerprint in DIR" << std::endl;
+    std::cout << "  --outer         Report outermost EXISTS candidates and forced values" << std::endl;
+    std::cout << "  --backbone      List the outermost EXISTS literals forced in every winning assignment" << std::endl;
+    std::cout << "  --enumerate-outer[=K]  List all (or K) winning outermost EXISTS assignments as cubes" << std::endl;
+    std::cout << "  --time-limit=S  Stop after S seconds and answer UNKNOWN" << std::endl;
+    std::cout << "  --profile[=N]   Per-variable and per-block search profile (top N, default 10)" << std::endl;
+    std::cout << "  --trace-out=F   Write a timeline of solver phases to F (chrome://tracing)" << std::endl;
+    std::cout << "  --pre=LIST      Preprocessing pipeline in order, e.g. unit,pure,subsume (none: skip)" << std::endl;
+    std::cout << "  --pre-budget=T  Effort per preprocessing technique in ticks (-1: unlimited)" << std::endl;
+    std::cout << "  --pre-rounds=N  At most N preprocessing rounds" << std::endl;
+    std::cout << "  --pre-min-gain=F  Stop preprocessing when a round removes < F of the literals (default 0.005)" << std::endl;
+    std::cout << "  --pre-threads=N Threads for preprocessing large formulas (default: number of cores)" << std::endl;
+    std::cout << "  --threads=N     QCDCL portfolio of N workers sharing learned constraints" << std::endl;
+    std::cout << "  --deterministic Portfolio gives the same result and statistics on every run" << std::endl;
+    std::cout << "  --dual          QCDCL detects gate definitions and sees solutions through them" << std::endl;
+    std::cout << "  --no-dual       Never use dual propagation" << std::endl;
+    std::cout << "  --dep-learning  QCDCL starts without variable dependencies and learns them" << std::endl;
+    std::cout << "  --no-dep-learning  Always follow the quantifier prefix" << std::endl;
     std::cout << std::endl;
     std::cout << "Example:" << std::endl;
     std::cout << "  " << programName << " formula.qdimacs       # Solve quietly" << std::endl;
@@ -161,7 +405,32 @@ void printUsage(const char* programName) {
 int main(int argc, char* argv[]) {
     // Parse command line arguments
     bool verbose = false;
+    bool showStats = false;
+    bool reportOuter = false;
+    bool backbone = false;
+    long long enumerateOuter = -1;  // -1 = off, 0 = all, K = at most K cubes
+    double timeLimit = 0;
+    long long bddNodes = 1000000;
+    int dpWidth = 20;
+    long long aigNodes = 1000000;
+    long long incdetConflicts = 10000;
+    long long expandClauses = 200000;
+    int profileTop = 0;     // 0 = no profile
+    int symmetryMode = -1;  // -1 = automatic, 0 = off, 1 = on
+    int dualMode = -1;      // -1 = automatic, 0 = off, 1 = on
+    int depMode = -1;       // -1 = automatic, 0 = off, 1 = on
+    Engine engine = Engine::AUTO;
+    std::string cacheDir;
+    std::string traceFile;
+    std::string certificateFile;
     std::string filename;
+    PreprocessSchedule schedule;
+    std::string pipelineList;
+    long long preBudget = -2;   // -2 = no --pre-budget, keep each technique's own
+    bool preScheduled = false;  // Any --pre* option: the features do not choose
+    int preThreads = std::max(1u, std::thread::hardware_concurrency());
+    int solveThreads = 1;
+    bool deterministic = false;
 
     if (argc < 2) {
         printUsage(argv[0]);
@@ -172,6 +441,157 @@ int main(int argc, char* argv[]) {
         std::string arg = argv[i];
         if (arg == "-v" || arg == "--verbose") {
             verbose = true;
+        } else if (arg == "--stats") {
+            showStats = true;
+        } else if (arg == "--symmetry") {
+            symmetryMode = 1;
+        } else if (arg == "--no-symmetry") {
+            symmetryMode = 0;
+        } else if (arg == "--outer") {
+            reportOuter = true;
+        } else if (arg == "--backbone") {
+            backbone = true;
+        } else if (arg == "--enumerate-outer") {
+            enumerateOuter = 0;
+        } else if (arg.rfind("--enumerate-outer=", 0) == 0) {
+            char* end = nullptr;
+            enumerateOuter = std::strtoll(arg.c_str() + 18, &end, 10);
+            if (*end != '\0' || enumerateOuter <= 0) {
+                std::cerr << "Invalid number of outer assignments: " << arg.substr(18) << std::endl;
+                printUsage(argv[0]);
+                return 1;
+            }
+        } else if (arg.rfind("--time-limit=", 0) == 0) {
+            char* end = nullptr;
+            timeLimit = std::strtod(arg.c_str() + 13, &end);
+            if (*end != '\0' || !std::isfinite(timeLimit) || timeLimit <= 0) {
+                std::cerr << "Invalid time limit: " << arg.substr(13) << std::endl;
+                printUsage(argv[0]);
+                return 1;
+            }
+        } else if (arg.rfind("--bdd-nodes=", 0) == 0) {
+            char* end = nullptr;
+            bddNodes = std::strtoll(arg.c_str() + 12, &end, 10);
+            if (*end != '\0' || bddNodes <= 0) {
+                std::cerr << "Invalid BDD node limit: " << arg.substr(12) << std::endl;
+                printUsage(argv[0]);
+                return 1;
+            }
+        } else if (arg.rfind("--dp-width=", 0) == 0) {
+            char* end = nullptr;
+            long width = std::strtol(arg.c_str() + 11, &end, 10);
+            if (*end != '\0' || width < 0 || width > 30) {
+                std::cerr << "Invalid tree width limit (0-30): " << arg.substr(11) << std::endl;
+                printUsage(argv[0]);
+                return 1;
+            }
+            dpWidth = width;
+        } else if (arg.rfind("--aig-nodes=", 0) == 0) {
+            char* end = nullptr;
+            aigNodes = std::strtoll(arg.c_str() + 12, &end, 10);
+            if (*end != '\0' || aigNodes <= 0) {
+                std::cerr << "Invalid AIG node limit: " << arg.substr(12) << std::endl;
+                printUsage(argv[0]);
+                return 1;
+            }
+        } else if (arg.rfind("--incdet-conflicts=", 0) == 0) {
+            char* end = nullptr;
+            incdetConflicts = std::strtoll(arg.c_str() + 19, &end, 10);
+            if (*end != '\0' || incdetConflicts <= 0) {
+                std::cerr << "Invalid conflict limit: " << arg.substr(19) << std::endl;
+                printUsage(argv[0]);
+                return 1;
+            }
+        } else if (arg.rfind("--expand-clauses=", 0) == 0) {
+            char* end = nullptr;
+            expandClauses = std::strtoll(arg.c_str() + 17, &end, 10);
+            if (*end != '\0' || expandClauses <= 0) {
+                std::cerr << "Invalid clause limit: " << arg.substr(17) << std::endl;
+                printUsage(argv[0]);
+                return 1;
+            }
+        } else if (arg.rfind("--certificate=", 0) == 0) {
+            certificateFile = arg.substr(14);
+        } else if (arg == "--profile") {
+            profileTop = 10;
+        } else if (arg.rfind("--profile=", 0) == 0) {
+            char* end = nullptr;
+            long long top = std::strtoll(arg.c_str() + 10, &end, 10);
+            if (*end != '\0' || top <= 0 || top > INT_MAX) {
+                std::cerr << "Invalid profile size: " << arg.substr(10) << std::endl;
+                printUsage(argv[0]);
+                return 1;
+            }
+            profileTop = top;
+        } else if (arg.rfind("--trace-out=", 0) == 0) {
+            traceFile = arg.substr(12);
+        } else if (arg.rfind("--pre=", 0) == 0) {
+            preScheduled = true;
+            pipelineList = arg.substr(6);
+        } else if (arg.rfind("--pre-budget=", 0) == 0) {
+            preScheduled = true;
+            char* end = nullptr;
+            preBudget = std::strtoll(arg.c_str() + 13, &end, 10);
+            if (*end != '\0' || preBudget < -1) {
+                std::cerr << "Invalid preprocessing budget: " << arg.substr(13) << std::endl;
+                printUsage(argv[0]);
+                return 1;
+            }
+        } else if (arg.rfind("--pre-rounds=", 0) == 0) {
+            preScheduled = true;
+            char* end = nullptr;
+            long long rounds = std::strtoll(arg.c_str() + 13, &end, 10);
+            if (*end != '\0' || rounds < 0 || rounds > INT_MAX) {
+                std::cerr << "Invalid number of preprocessing rounds: " << arg.substr(13) << std::endl;
+                printUsage(argv[0]);
+                return 1;
+            }
+            schedule.maxRounds = rounds;
+        } else if (arg.rfind("--pre-min-gain=", 0) == 0) {
+            preScheduled = true;
+            char* end = nullptr;
+            schedule.minGain = std::strtod(arg.c_str() + 15, &end);
+            if (*end != '\0' || !std::isfinite(schedule.minGain) || schedule.minGain < 0 || schedule.minGain > 1) {
+                std::cerr << "Invalid preprocessing gain: " << arg.substr(15) << std::endl;
+                printUsage(argv[0]);
+                return 1;
+            }
+        } else if (arg.rfind("--pre-threads=", 0) == 0) {
+            char* end = nullptr;
+            long long threads = std::strtoll(arg.c_str() + 14, &end, 10);
+            if (*end != '\0' || threads < 1 || threads > INT_MAX) {
+                std::cerr << "Invalid number of preprocessing threads: " << arg.substr(14) << std::endl;
+                printUsage(argv[0]);
+                return 1;
+            }
+            preThreads = threads;
+        } else if (arg.rfind("--threads=", 0) == 0) {
+            char* end = nullptr;
+            long long threads = std::strtoll(arg.c_str() + 10, &end, 10);
+            if (*end != '\0' || threads < 1 || threads > INT_MAX) {
+                std::cerr << "Invalid number of threads: " << arg.substr(10) << std::endl;
+                printUsage(argv[0]);
+                return 1;
+            }
+            solveThreads = threads;
+        } else if (arg == "--deterministic") {
+            deterministic = true;
+        } else if (arg == "--dual") {
+            dualMode = 1;
+        } else if (arg == "--no-dual") {
+            dualMode = 0;
+        } else if (arg == "--dep-learning") {
+            depMode = 1;
+        } else if (arg == "--no-dep-learning") {
+            depMode = 0;
+        } else if (arg.rfind("--cache=", 0) == 0) {
+            cacheDir = arg.substr(8);
+        } else if (arg.rfind("--engine=", 0) == 0) {
+            if (!parseEngine(arg.substr(9), engine)) {
+                std::cerr << "Unknown engine: " << arg.substr(9) << std::endl;
+                printUsage(argv[0]);
+                return 1;
+            }
         } else if (arg == "-h" || arg == "--help") {
             printUsage(argv[0]);
             return 0;
@@ -189,10 +609,33 @@ int main(int argc, char* argv[]) {
         printUsage(argv[0]);
         return 1;
     }
+    if (backbone && enumerateOuter >= 0) {
+        std::cerr << "Error: --backbone and --enumerate-outer cannot be combined" << std::endl;
+        return 1;
+    }
+    bool allOuter = backbone || enumerateOuter >= 0;  // Looks at every winning outer assignment
+
+    if (!pipelineList.empty() && !parsePipeline(pipelineList, schedule.pipeline)) {
+        std::cerr << "Invalid preprocessing pipeline: " << pipelineList << std::endl;
+        printUsage(argv[0]);
+        return 1;
+    }
+    if (preBudget != -2) {
+        for (auto& scheduled : schedule.pipeline) scheduled.tickBudget = preBudget;
+    }
+
+    if (!traceFile.empty()) {
+        traceStart();
+    }
 
     // Read the formula
     QBFPreprocessor preprocessor;
-    if (!readQBF(filename, preprocessor, verbose)) {
+    bool parsed;
+    {
+        TraceScope traced("parse", "io");
+        parsed = readQBF(filename, preprocessor, verbose);
+    }
+    if (!parsed) {
         return 1;
     }
 
@@ -208,15 +651,58 @@ int main(int argc, char* argv[]) {
         std::cout << std::endl;
     }
 
-    // Preprocess (unit propagation, pure literal elimination)
+    // Consult the result cache before doing any work (a cached result has
+    // no outer report, backbone, cubes, certificate or profile, so --outer,
+    // --backbone, --enumerate-outer, --certificate and --profile only store)
+    std::string canonical, fingerprint;
+    if (!cacheDir.empty()) {
+        TraceScope traced("cache lookup", "cache");
+        canonical = canonicalForm(preprocessor);
+        fingerprint = computeFingerprint(canonical);
+        Result cached;
+        if (!reportOuter && !allOuter && certificateFile.empty() && profileTop == 0 &&
+            ResultCache(cacheDir).lookup(fingerprint, canonical, cached)) {
+            if (verbose) {
+                std::cout << "[CACHE] Hit for fingerprint " << fingerprint << std::endl;
+            }
+            printResult(cached, verbose);
+            if (showStats) {
+                std::cout << std::endl << "[STATS] cache         : hit (" << fingerprint << ")" << std::endl;
+            }
+            finishTrace(traceFile);
+            return exitCode(cached);
+        }
+        if (verbose) {
+            std::cout << "[CACHE] Miss for fingerprint " << fingerprint << std::endl << std::endl;
+        }
+    }
+
+    // Preprocess (the scheduled pipeline of techniques, chosen from the
+    // size of the formula unless given on the command line)
+    std::string preprocessReason = "set on the command line";
+    if (!preScheduled) preprocessReason = selectPreprocessing(computeSizeFeatures(preprocessor), schedule);
     if (verbose) {
-        std::cout << "[PREPROCESS] Running unit propagation and pure literal elimination..." << std::endl;
+        std::cout << "[PREPROCESS] Schedule: " << preprocessReason << std::endl;
+        std::cout << "[PREPROCESS] Running";
+        for (size_t i = 0; i < schedule.pipeline.size(); i++) {
+            std::cout << (i == 0 ? " " : ", ") << techniqueName(schedule.pipeline[i].technique);
+        }
+        std::cout << (schedule.pipeline.empty() ? " nothing" : "") << "..." << std::endl;
     }
+    preprocessor.setSchedule(schedule);
+    preprocessor.setThreads(preThreads);
+    if (allOuter) freezeOuterBlock(preprocessor);
     preprocessor.preprocess();
 
     if (verbose) {
+        for (const auto& stats : preprocessor.getTechniqueStats()) {
+            std::cout << "[PREPROCESS] " << techniqueName(stats.technique) << ": " << stats.runs
+                      << " runs, " << stats.ticks << " ticks, " << stats.assignments << " assignments, "
+                      << stats.clausesRemoved << " clauses removed"
+                      << (stats.exhausted ? " (budget exhausted)" : "") << std::endl;
+        }
         std::cout << "[PREPROCESS] After preprocessing: " << preprocessor.getClauses().size()
-                  << " clauses remain" << std::endl;
+                  << " clauses remain after " << preprocessor.getRounds() << " rounds" << std::endl;
 
         // Show any assignments made during preprocessing
         const auto& preAssignments = preprocessor.getAssignments();
@@ -230,24 +716,289 @@ int main(int argc, char* argv[]) {
         std::cout << std::endl;
     }
 
-    // Solve
-    QBFSolver solver;
-    solver.setVerbose(verbose);
-    Result result = solver.solve(preprocessor);
+    // Choose an engine from the shape of the preprocessed formula
+    FormulaFeatures features;
+    EngineConfig config;
+    {
+        TraceScope traced("select engine", "engine");
+        features = computeFeatures(preprocessor);
+        config = selectEngine(features);
+    }
+    if (engine != Engine::AUTO) {
+        config.engine = engine;
+        config.reason = "requested";
+    }
+    if (symmetryMode >= 0) {
+        config.breakSymmetries = (symmetryMode == 1);
+    }
+    if (dualMode >= 0) {
+        config.dualPropagation = (dualMode == 1);
+    }
+    if (depMode >= 0) {
+        config.dependencyLearning = (depMode == 1);
+    }
+    if (allOuter) {
+        config.engine = Engine::QCDCL;
+        config.reason = backbone ? "backbone: solving under assumptions" : "enumeration: blocking clauses";
+    }
+    if (verbose) {
+        std::cout << "[ENGINE] " << engineName(config.engine)
+                  << " (" << config.reason << ")" << std::endl;
+    }
 
-    // Print result
-    std::cout << std::endl;
-    if (result == Result::SAT) {
-        std::cout << "SATISFIABLE" << std::endl;
+    // Break symmetries: clauses for EXISTS groups, pruning for FORALL groups
+    SymmetryInfo symmetries;
+    if (config.breakSymmetries) {
+        TraceScope traced("symmetry", "symmetry");
+        symmetries = detectSymmetries(preprocessor);
+
+        // Sorting the outer block would hide winning outer assignments, and
+        // with them the "forced in every winning assignment" guarantee
+        if (reportOuter || allOuter) {
+            std::vector<int> outerVars = outerBlockVariables(preprocessor);
+            auto& groups = symmetries.existentialGroups;
+            groups.erase(std::remove_if(groups.begin(), groups.end(), [&](const std::vector<int>& group) {
+                return std::find(outerVars.begin(), outerVars.end(), group[0]) != outerVars.end();
+            }), groups.end());
+        }
+        addSymmetryBreakingClauses(preprocessor, symmetries);
         if (verbose) {
-            std::cout << std::endl << "The EXISTS player has a winning strategy." << std::endl;
+            for (const auto& group : symmetries.existentialGroups) {
+                std::cout << "[SYMMETRY] Interchangeable EXISTS variables:";
+                for (int var : group) std::cout << " x" << var;
+                std::cout << " (sorted by added clauses)" << std::endl;
+            }
+            for (const auto& group : symmetries.universalGroups) {
+                std::cout << "[SYMMETRY] Interchangeable FORALL variables:";
+                for (int var : group) std::cout << " x" << var;
+                std::cout << " (only sorted moves explored)" << std::endl;
+            }
         }
+    }
+
+    // Outer-block reports, printed as they arrive
+    size_t forcedShown = 0;
+    OuterCallback onOuter;
+    if (reportOuter) {
+        onOuter = [&forcedShown](const OuterProgress& progress) {
+            printOuterProgress(progress, forcedShown);
+        };
+    }
+
+    // Solve
+    Result result;
+    SolverStats stats;
+    SearchProfile profile;
+    SearchProfile* profilePtr = profileTop > 0 ? &profile : nullptr;
+    bool profiled = false;  // Only the search and QCDCL engines record a profile
+
+    // The BDD engine gives up when its diagrams outgrow the node limit; the
+    // engine the features would pick otherwise then takes over, with the
+    // time that is left
+    bool answered = false;
+    SolverStats engineStats;   // Counters of an engine that gave up
+    if (config.engine == Engine::BDD) {
+        BDDSolver solver;
+        solver.setNodeLimit(bddNodes);
+        answered = runWithFallback(solver, [&] {
+            return solver.exceededNodeLimit() ? "over " + std::to_string(bddNodes) + " BDD nodes" : std::string();
+        }, "bdd", config, preprocessor, onOuter, timeLimit, verbose, result, stats, engineStats);
+    }
+
+    // Likewise the tree-decomposition engine when the formula is wider than
+    // its limit; it finds out before building any table, but computing the
+    // decomposition still takes time
+    if (config.engine == Engine::TREEDP) {
+        TreeDPSolver solver;
+        solver.setMaxWidth(dpWidth);
+        answered = runWithFallback(solver, [&] {
+            return solver.exceededWidth() ? "tree width above " + std::to_string(dpWidth) : std::string();
+        }, "treedp", config, preprocessor, onOuter, timeLimit, verbose, result, stats, engineStats);
+    }
+
+    // And the AIG engine when its graph outgrows the node limit
+    if (config.engine == Engine::AIG) {
+        AIGSolver solver;
+        solver.setNodeLimit(aigNodes);
+        answered = runWithFallback(solver, [&] {
+            return solver.exceededNodeLimit() ? "over " + std::to_string(aigNodes) + " AIG nodes" : std::string();
+        }, "aig", config, preprocessor, onOuter, timeLimit, verbose, result, stats, engineStats);
+    }
+
+    // And the determinization engine on prefixes other than ∀∃, or past
+    // its conflict limit
+    IncDetSolver incdet;   // Kept for --certificate
+    bool certified = false;
+    if (config.engine == Engine::INCDET) {
+        incdet.setConflictLimit(incdetConflicts);
+        answered = runWithFallback(incdet, [&] {
+            if (incdet.unsupportedPrefix()) return std::string("not 2QBF");
+            return incdet.exceededConflictLimit() ? "over " + std::to_string(incdetConflicts) + " conflicts"
+                                                  : std::string();
+        }, "incdet", config, preprocessor, onOuter, timeLimit, verbose, result, stats, engineStats);
+        certified = answered && result == Result::SAT;
+    }
+
+    // And the resolution/expansion engine when the matrix outgrows the
+    // clause limit
+    if (config.engine == Engine::EXPAND) {
+        ExpansionSolver solver;
+        solver.setClauseLimit(expandClauses);
+        answered = runWithFallback(solver, [&] {
+            return solver.exceededClauseLimit() ? "over " + std::to_string(expandClauses) + " clauses" : std::string();
+        }, "expand", config, preprocessor, onOuter, timeLimit, verbose, result, stats, engineStats);
+    }
+
+    // The portfolio's workers report nothing while searching, so --outer,
+    // --profile and -v keep the single solver
+    bool portfolio = config.engine == Engine::QCDCL && solveThreads > 1 &&
+                     !reportOuter && !allOuter && profileTop == 0 && !verbose;
+    if (verbose && solveThreads > 1 && config.engine == Engine::QCDCL) {
+        std::cout << "[PORTFOLIO] Verbose mode runs a single worker" << std::endl;
+    }
+    QBFBackbone backboneSolver;
+    QBFEnumerate enumerator;
+    if (answered) {
+        // Solved by an elimination engine above
+    } else if (enumerateOuter >= 0) {
+        // Cubes are printed as they are found
+        enumerator.setCubeCallback([](const std::vector<Literal>& cube) {
+            std::cout << "[ENUM] winning   : " << (cube.empty() ? "any values" : outerToString(cube)) << std::endl;
+        });
+        enumerator.setLimit(enumerateOuter);
+        enumerator.setVerbose(verbose);
+        enumerator.setSymmetries(symmetries);
+        enumerator.setDualPropagation(config.dualPropagation);
+        enumerator.setTimeLimit(timeLimit);
+        TraceScope traced("enumerate", "qcdcl");
+        result = enumerator.enumerate(preprocessor);
+        stats = enumerator.getStats();
+    } else if (backbone) {
+        backboneSolver.setVerbose(verbose);
+        backboneSolver.setSymmetries(symmetries);
+        backboneSolver.setDualPropagation(config.dualPropagation);
+        backboneSolver.setTimeLimit(timeLimit);
+        TraceScope traced("backbone", "qcdcl");
+        result = backboneSolver.compute(preprocessor);
+        stats = backboneSolver.getStats();
+    } else if (portfolio) {
+        QBFPortfolio solver;
+        solver.setThreads(solveThreads);
+        solver.setDeterministic(deterministic);
+        solver.setSymmetries(symmetries);
+        solver.setDualPropagation(config.dualPropagation);
+        solver.setDependencyLearning(config.dependencyLearning);
+        solver.setTimeLimit(timeLimit);
+        TraceScope traced("solve", "qcdcl");
+        result = solver.solve(preprocessor);
+        stats = solver.getStats();
+    } else if (config.engine == Engine::QCDCL) {
+        QCDCLSolver solver;
+        solver.setVerbose(verbose);
+        solver.setSymmetries(symmetries);
+        solver.setDualPropagation(config.dualPropagation);
+        solver.setDependencyLearning(config.dependencyLearning);
+        solver.setOuterCallback(onOuter);
+        solver.setTimeLimit(timeLimit);
+        solver.setProfile(profilePtr);
+        TraceScope traced("solve", "qcdcl");
+        result = solver.solve(preprocessor);
+        stats = solver.getStats();
+        profiled = true;
     } else {
-        std::cout << "UNSATISFIABLE" << std::endl;
-        if (verbose) {
-            std::cout << std::endl << "The FORALL player can always falsify the formula." << std::endl;
+        QBFSolver solver;
+        solver.setVerbose(verbose);
+        solver.setStrategyReuse(config.reuseStrategies);
+        solver.setSymmetries(symmetries);
+        solver.setOuterCallback(onOuter);
+        solver.setTimeLimit(timeLimit);
+        solver.setProfile(profilePtr);
+        TraceScope traced("solve", "search");
+        result = solver.solve(preprocessor);
+        stats = solver.getStats();
+        profiled = true;
+    }
+    stats.engineReason = config.reason;
+    stats.preprocessReason = preprocessReason;
+    stats.mergeEngineCounters(engineStats);
+
+    // An UNKNOWN answer says nothing about the formula - never cache it
+    if (!cacheDir.empty() && result != Result::UNKNOWN &&
+        !ResultCache(cacheDir).store(fingerprint, canonical, result)) {
+        std::cerr << "Warning: Cannot write result cache in '" << cacheDir << "'" << std::endl;
+    }
+
+    printResult(result, verbose);
+
+    // Only the determinization engine builds Skolem functions
+    if (!certificateFile.empty()) {
+        if (!certified) {
+            std::cerr << "Warning: No certificate (only a true formula solved by --engine=incdet has one)"
+                      << std::endl;
+        } else {
+            std::ofstream out(certificateFile);
+            incdet.writeCertificate(out);
+            if (!out) {
+                std::cerr << "Warning: Cannot write certificate file '" << certificateFile << "'" << std::endl;
+            } else if (verbose) {
+                std::cout << "[CERTIFICATE] Skolem functions written to " << certificateFile << std::endl;
+            }
+        }
+    }
+
+    // The backbone is proven literal by literal: when time runs out, the
+    // literals proven so far are still forced
+    if (backbone && result == Result::SAT) {
+        std::cout << "[BACKBONE] forced    : " << outerToString(backboneSolver.getBackbone()) << std::endl;
+        if (!backboneSolver.isComplete()) {
+            std::cout << "[BACKBONE] undecided : " << outerToString(backboneSolver.getUndecided())
+                      << " (time limit)" << std::endl;
+        }
+    }
+
+    // Cubes are disjoint, so their sizes add up
+    if (enumerateOuter >= 0 && result == Result::SAT) {
+        const auto& cubes = enumerator.getCubes();
+        std::cout << "[ENUM] " << cubes.size() << (cubes.size() == 1 ? " cube" : " cubes");
+        if (enumerator.getOuterSize() < 63) {
+            long long covered = 0;
+            for (const auto& cube : cubes) covered += 1LL << (enumerator.getOuterSize() - cube.size());
+            std::cout << " covering " << covered << " of " << (1LL << enumerator.getOuterSize())
+                      << " outer assignments";
+        }
+        std::cout << (enumerator.isComplete() ? " (all)" : " (stopped early)") << std::endl;
+    }
+
+    if (showStats) {
+        std::cout << std::endl;
+        printStats(stats, features, symmetries);
+        if (enumerateOuter >= 0) {
+            std::cout << "[STATS] enumeration   : " << enumerator.getCubes().size() << " cubes, "
+                      << enumerator.getCalls() << " solver calls, "
+                      << enumerator.getShrunk() << " literals dropped by shrinking" << std::endl;
         }
+        if (backbone) {
+            std::cout << "[STATS] backbone      : " << backboneSolver.getBackbone().size() << " literals, "
+                      << backboneSolver.getCalls() << " solver calls, "
+                      << backboneSolver.getFiltered() << " candidates dropped by winning cubes, "
+                      << backboneSolver.getLevelZero() << " implied at level 0" << std::endl;
+        }
+        if (!cacheDir.empty()) {
+            std::cout << "[STATS] cache         : miss (" << fingerprint << ")" << std::endl;
+        }
+    }
+
+    // The other engines do not branch on variables, and the backbone and
+    // enumeration run many searches, so they have no profile to show
+    if (profileTop > 0 && !profiled) {
+        std::string used = backbone ? "--backbone" : enumerateOuter >= 0 ? "--enumerate-outer" : stats.engine;
+        std::cerr << "Warning: No search profile (only a single search or qcdcl solve records one; "
+                  << used << " was used)" << std::endl;
+    } else if (profileTop > 0) {
+        std::cout << std::endl;
+        printProfile(profile, profileTop);
     }
 
-    return (result == Result::SAT) ? 0 : 1;
+    finishTrace(traceFile);
+    return exitCode(result);
 }
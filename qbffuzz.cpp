@@ -0,0 +1,746 @@
+/*
+ * qbffuzz.cpp - Differential Fuzzer for the QBF Solver
+ *
+ * Every solver configuration must give the same answer as the brute-force
+ * reference evaluator (QBFReference.h). The fuzzer produces many small
+ * formulas, solves each one with every configuration, and reports any
+ * disagreement, shrunk by delta debugging (QBFDelta.h) to a small repro.
+ *
+ * FORMULA SOURCES:
+ *   generate  random formulas from the blocksqbf generator (make generator)
+ *   mutate    random edits of corpus files given on the command line:
+ *             flip/add/remove literals, add/remove/duplicate clauses,
+ *             flip a quantifier, move/free/add variables, split/merge blocks
+ *
+ * USAGE:
+ *   ./qbffuzz [options] [corpus.qdimacs ...]
+ *
+ *   -n N              Number of formulas (default 500)
+ *   --seed=S          Random seed (default: from the clock)
+ *   --mode=MODE       generate, mutate or mixed (default: mixed with a
+ *                     corpus, generate without)
+ *   --generator=PATH  blocksqbf binary (default ./blocksqbf)
+ *   --max-vars=N      Skip formulas with more variables (default 16)
+ *   --time-limit=S    Per-solve limit in seconds (default 10)
+ *   --out=DIR         Where failing formulas are written (default fuzz-failures)
+ *   -v                Print every formula's verdicts
+ *
+ * Exit code 0 if all configurations agreed on every formula, 1 otherwise.
+ */
+
+#include "AIGSolver.h"
+#include "BDDSolver.h"
+#include "ExpansionSolver.h"
+#include "IncDetSolver.h"
+#include "QBFBackbone.h"
+#include "QBFDelta.h"
+#include "QBFEnumerate.h"
+#include "QBFFeatures.h"
+#include "QBFOuter.h"
+#include "QBFPreprocessor.h"
+#include "QBFPortfolio.h"
+#include "QBFReference.h"
+#include "QBFSolver.h"
+#include "QBFSymmetry.h"
+#include "QCDCLSolver.h"
+#include "QDIMACS.h"
+#include "TreeDPSolver.h"
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <exception>
+#include <filesystem>
+#include <iostream>
+#include <random>
+#include <sstream>
+#include <string>
+#include <unordered_map>
+#include <unordered_set>
+#include <vector>
+
+/*
+ * One way of running the solver. Together the configurations cover every
+ * engine and every optional technique, each switched on and off.
+ */
+struct SolverConfig {
+    const char* name;
+    Engine engine;
+    bool preprocess;
+    bool symmetry;
+    bool reuseStrategies;
+    bool checkOuter;        // Also verify the --outer claims (QBFOuter.h)
+    bool incremental;       // Preprocess in three rounds of added clauses
+    long long preBudget = -1; // Ticks per preprocessing technique, -1 = default schedule
+    int threads = 1;          // QCDCL portfolio workers (QBFPortfolio.h)
+    bool deterministic = false;
+    bool dual = false;        // QCDCL dual propagation through gate definitions
+    bool dependencies = false; // QCDCL dependency learning
+    bool backbone = false;    // Also verify the outer backbone (QBFBackbone.h)
+    bool enumerate = false;   // Also verify the winning outer cubes (QBFEnumerate.h)
+    long long bddNodes = 0;   // BDD node limit, 0 = default (small: collect and reorder often)
+    long long aigNodes = 0;   // AIG node limit, 0 = default (small: rebuild and sweep often)
+    long long expandClauses = 0; // Clause limit of the resolution/expansion engine, 0 = default
+    int dpWidth = -1;         // Tree width limit, -1 = default (small: most formulas fall back)
+    long long incdetConflicts = -1; // Determinization conflict limit, -1 = default
+};
+
+static const std::vector<SolverConfig> CONFIGS = {
+    {"search",             Engine::SEARCH, true,  false, true,  false, false},
+    {"search-noreuse",     Engine::SEARCH, true,  false, false, false, false},
+    {"search-nopre",       Engine::SEARCH, false, false, true,  false, false},
+    {"search-symmetry",    Engine::SEARCH, true,  true,  true,  false, false},
+    {"search-outer",       Engine::SEARCH, true,  false, true,  true,  false},
+    {"search-incremental", Engine::SEARCH, true,  false, true,  false, true},
+    {"search-budget",      Engine::SEARCH, true,  false, true,  false, false, 20},
+    {"qcdcl",              Engine::QCDCL,  true,  false, true,  false, false},
+    {"qcdcl-nopre",        Engine::QCDCL,  false, false, true,  false, false},
+    {"qcdcl-symmetry",     Engine::QCDCL,  true,  true,  true,  false, false},
+    {"qcdcl-outer",        Engine::QCDCL,  true,  false, true,  true,  false},
+    {"qcdcl-incremental",  Engine::QCDCL,  true,  false, true,  false, true},
+    {"qcdcl-portfolio",    Engine::QCDCL,  true,  false, true,  false, false, -1, 3},
+    {"qcdcl-deterministic", Engine::QCDCL, true,  false, true,  false, false, -1, 3, true},
+    {"qcdcl-dual",         Engine::QCDCL,  true,  false, true,  false, false, -1, 1, false, true},
+    {"qcdcl-dual-nopre",   Engine::QCDCL,  false, false, true,  false, false, -1, 1, false, true},
+    {"qcdcl-dual-outer",   Engine::QCDCL,  false, false, true,  true,  false, -1, 1, false, true},
+    {"qcdcl-deps",         Engine::QCDCL,  false, false, true,  false, false, -1, 1, false, false, true},
+    {"qcdcl-deps-outer",   Engine::QCDCL,  true,  false, true,  true,  false, -1, 1, false, false, true},
+    {"qcdcl-deps-portfolio", Engine::QCDCL, true, false, true,  false, false, -1, 3, false, false, true},
+    {"qcdcl-backbone",     Engine::QCDCL,  true,  false, true,  false, false, -1, 1, false, false, false, true},
+    {"qcdcl-enumerate",    Engine::QCDCL,  true,  false, true,  false, false, -1, 1, false, false, false, false, true},
+    {"bdd",                Engine::BDD,    true,  false, true,  false, false},
+    {"bdd-nopre",          Engine::BDD,    false, false, true,  false, false},
+    {"bdd-outer",          Engine::BDD,    true,  false, true,  true,  false},
+    {"bdd-sift",           Engine::BDD,    false, false, true,  false, false, -1, 1, false, false, false, false, false, 100},
+    {"treedp",             Engine::TREEDP, true,  false, true,  false, false},
+    {"treedp-nopre",       Engine::TREEDP, false, false, true,  false, false},
+    {"treedp-outer",       Engine::TREEDP, true,  false, true,  true,  false},
+    {"treedp-narrow",      Engine::TREEDP, false, false, true,  false, false, -1, 1, false, false, false, false, false, 0, 0, 0, 1},
+    {"aig",                Engine::AIG,    true,  false, true,  false, false},
+    {"aig-nopre",          Engine::AIG,    false, false, true,  false, false},
+    {"aig-outer",          Engine::AIG,    true,  false, true,  true,  false},
+    {"aig-sweep",          Engine::AIG,    false, false, true,  false, false, -1, 1, false, false, false, false, false, 0, 400},
+    {"aig-small",          Engine::AIG,    false, false, true,  false, false, -1, 1, false, false, false, false, false, 0, 8},
+    {"incdet",             Engine::INCDET, true,  false, true,  false, false},
+    {"incdet-nopre",       Engine::INCDET, false, false, true,  false, false},
+    {"incdet-outer",       Engine::INCDET, true,  false, true,  true,  false},
+    {"incdet-noconflicts", Engine::INCDET, false, false, true,  false, false, -1, 1, false, false, false, false, false, 0, 0, 0, -1, 0},
+    {"expand",             Engine::EXPAND, true,  false, true,  false, false},
+    {"expand-nopre",       Engine::EXPAND, false, false, true,  false, false},
+    {"expand-outer",       Engine::EXPAND, true,  false, true,  true,  false},
+    {"expand-small",       Engine::EXPAND, false, false, true,  false, false, -1, 1, false, false, false, false, false, 0, 0, 40},
+};
+
+static std::string resultName(Result result) {
+    switch (result) {
+        case Result::SAT:     return "SAT";
+        case Result::UNSAT:   return "UNSAT";
+        case Result::UNKNOWN: return "UNKNOWN";
+    }
+    return "?";
+}
+
+/*
+ * True if EXISTS wins by playing the cube's literals, even if the other
+ * outer variables are chosen by FORALL (they are claimed don't-care).
+ */
+static bool isWinningCube(const QBFFormula& formula, const std::vector<int>& outerVars,
+                          const std::vector<Literal>& cube) {
+    std::unordered_set<int> listed;
+    QBFFormula f;
+    for (const auto& lit : cube) {
+        listed.insert(lit.variable);
+        f.clauses.push_back({lit});
+    }
+    QuantifierBlock open{Quantifier::FORALL, {}};
+    for (int var : outerVars) {
+        if (!listed.count(var)) open.variables.push_back(var);
+    }
+    std::unordered_set<int> outerSet(outerVars.begin(), outerVars.end());
+    f.blocks.push_back(open);
+    for (const auto& block : formula.blocks) {
+        QuantifierBlock rest{block.type, {}};
+        for (int var : block.variables) {
+            if (!outerSet.count(var)) rest.variables.push_back(var);
+        }
+        f.blocks.push_back(rest);
+    }
+    f.clauses.insert(f.clauses.end(), formula.clauses.begin(), formula.clauses.end());
+    return evaluateReference(f) == Result::SAT;
+}
+
+/*
+ * Check the final outer-block report against the reference:
+ *
+ *   forced literal l    the formula with the unit clause (¬l) is false
+ *   winning assignment  the formula with its literals as unit clauses is
+ *                       true even if the unlisted outer variables are
+ *                       chosen by FORALL (they are claimed don't-care)
+ *
+ * Returns an empty string if the claims hold.
+ */
+static std::string checkOuterReport(const QBFFormula& formula, const OuterProgress& report) {
+    QBFPreprocessor loaded;
+    loadFormula(formula, loaded);
+    std::vector<int> outerVars = outerBlockVariables(loaded);
+
+    for (const auto& lit : report.forced) {
+        QBFFormula f = formula;
+        f.clauses.push_back({lit.complement()});
+        if (evaluateReference(f) != Result::UNSAT) return "WRONG-OUTER (forced)";
+    }
+
+    if (report.proven && !isWinningCube(formula, outerVars, report.candidate)) {
+        return "WRONG-OUTER (winning)";
+    }
+    return "";
+}
+
+/*
+ * Check a complete backbone against the reference: an outer literal l is
+ * listed exactly when the formula with the unit clause (¬l) is false.
+ */
+static std::string checkBackbone(const QBFFormula& formula, const std::vector<Literal>& backbone) {
+    QBFPreprocessor loaded;
+    loadFormula(formula, loaded);
+    for (int var : outerBlockVariables(loaded)) {
+        for (bool negated : {false, true}) {
+            Literal lit(var, negated);
+            bool listed = std::any_of(backbone.begin(), backbone.end(), [&](const Literal& forced) {
+                return forced.variable == var && forced.isNegated == negated;
+            });
+            QBFFormula f = formula;
+            f.clauses.push_back({lit.complement()});
+            if ((evaluateReference(f) == Result::UNSAT) != listed) {
+                return listed ? "WRONG-BACKBONE (not forced)" : "WRONG-BACKBONE (missing)";
+            }
+        }
+    }
+    return "";
+}
+
+/*
+ * Check enumerated outer cubes against the reference: each one wins, no
+ * two overlap, and if the list is complete, blocking all of them leaves
+ * EXISTS without a winning move.
+ */
+static std::string checkCubes(const QBFFormula& formula, const std::vector<std::vector<Literal>>& cubes,
+                              bool complete) {
+    QBFPreprocessor loaded;
+    loadFormula(formula, loaded);
+    std::vector<int> outerVars = outerBlockVariables(loaded);
+    QBFFormula blocked = formula;
+    for (size_t i = 0; i < cubes.size(); i++) {
+        if (!isWinningCube(formula, outerVars, cubes[i])) return "WRONG-ENUM (not winning)";
+        for (size_t j = 0; j < i; j++) {
+            bool clash = std::any_of(cubes[i].begin(), cubes[i].end(), [&](const Literal& lit) {
+                return std::any_of(cubes[j].begin(), cubes[j].end(), [&](const Literal& other) {
+                    return other.variable == lit.variable && other.isNegated != lit.isNegated;
+                });
+            });
+            if (!clash) return "WRONG-ENUM (overlap)";
+        }
+        Clause blocking;
+        for (const auto& lit : cubes[i]) blocking.push_back(lit.complement());
+        blocked.clauses.push_back(blocking);
+    }
+    if (complete && evaluateReference(blocked) != Result::UNSAT) return "WRONG-ENUM (missing)";
+    return "";
+}
+
+/*
+ * Check a Skolem certificate against the original clauses: under every
+ * assignment of the universals, the existentials' function values
+ * satisfy every clause.
+ */
+static std::string checkCertificate(const QBFFormula& formula, const IncDetSolver& solver) {
+    std::vector<int> universals;
+    for (const auto& block : formula.blocks) {
+        if (block.type != Quantifier::FORALL) continue;
+        universals.insert(universals.end(), block.variables.begin(), block.variables.end());
+    }
+    for (long long bits = 0; bits < (1LL << universals.size()); bits++) {
+        std::unordered_map<int, bool> values;
+        for (size_t i = 0; i < universals.size(); i++) values[universals[i]] = (bits >> i) & 1;
+        std::unordered_map<int, bool> skolem = solver.evaluateCertificate(values);
+        values.insert(skolem.begin(), skolem.end());
+        for (const auto& clause : formula.clauses) {
+            bool satisfied = std::any_of(clause.begin(), clause.end(), [&](const Literal& lit) {
+                auto it = values.find(lit.variable);
+                return (it != values.end() && it->second) != lit.isNegated;
+            });
+            if (!satisfied) return "WRONG-CERTIFICATE";
+        }
+    }
+    return "";
+}
+
+/*
+ * The engine main.cpp hands over to when an elimination engine gives up
+ * at its limit: the fallback the formula features choose.
+ */
+static Result runFallback(const QBFPreprocessor& preprocessor, const OuterCallback& onOuter, double timeLimit) {
+    EngineConfig chosen = selectEngine(computeFeatures(preprocessor));
+    if (chosen.fallback == Engine::QCDCL) {
+        QCDCLSolver solver;
+        solver.setDualPropagation(chosen.dualPropagation);
+        solver.setDependencyLearning(chosen.dependencyLearning);
+        solver.setOuterCallback(onOuter);
+        solver.setTimeLimit(timeLimit);
+        return solver.solve(preprocessor);
+    }
+    QBFSolver solver;
+    solver.setStrategyReuse(chosen.reuseStrategies);
+    solver.setOuterCallback(onOuter);
+    solver.setTimeLimit(timeLimit);
+    return solver.solve(preprocessor);
+}
+
+/*
+ * Solve a formula with one configuration. Crashes that surface as C++
+ * exceptions are reported as "ERROR" so they count as disagreements too.
+ * fellBack (if given) is set when an engine hit its limit and the
+ * fallback engine answered instead.
+ */
+static std::string runConfig(const QBFFormula& formula, const SolverConfig& config, double timeLimit,
+                             bool* fellBack = nullptr) {
+    if (fellBack) *fellBack = false;
+    try {
+        QBFPreprocessor preprocessor;
+        if (config.preBudget >= 0) {
+            // Stop preprocessing part-way, leaving a half-simplified formula
+            PreprocessSchedule schedule;
+            for (auto& scheduled : schedule.pipeline) scheduled.tickBudget = config.preBudget;
+            preprocessor.setSchedule(schedule);
+        }
+        if (config.incremental) {
+            // Add the clauses in three rounds, preprocessing after each, so
+            // later rounds exercise the delta path (and undoing pure steps)
+            QBFFormula prefix{formula.blocks, {}};
+            preprocessor.enableIncremental();
+            loadFormula(prefix, preprocessor);
+            size_t round = (formula.clauses.size() + 2) / 3;
+            for (size_t start = 0; start < formula.clauses.size(); start += round) {
+                size_t end = std::min(formula.clauses.size(), start + round);
+                for (size_t i = start; i < end; i++) preprocessor.addClause(formula.clauses[i]);
+                preprocessor.preprocess();
+            }
+        } else {
+            loadFormula(formula, preprocessor);
+        }
+        if (config.backbone || config.enumerate) freezeOuterBlock(preprocessor);
+        if (config.preprocess) preprocessor.preprocess();
+
+        SymmetryInfo symmetries;
+        if (config.symmetry) {
+            symmetries = detectSymmetries(preprocessor);
+            addSymmetryBreakingClauses(preprocessor, symmetries);
+        }
+
+        OuterProgress report;
+        OuterCallback onOuter;
+        if (config.checkOuter) {
+            onOuter = [&report](const OuterProgress& progress) { report = progress; };
+        }
+
+        Result result;
+        if (config.enumerate) {
+            QBFEnumerate solver;
+            solver.setSymmetries(symmetries);
+            solver.setDualPropagation(config.dual);
+            solver.setTimeLimit(timeLimit);
+            result = solver.enumerate(preprocessor);
+            if (result == Result::SAT) {
+                std::string problem = checkCubes(formula, solver.getCubes(), solver.isComplete());
+                if (!problem.empty()) return problem;
+            }
+        } else if (config.backbone) {
+            QBFBackbone solver;
+            solver.setSymmetries(symmetries);
+            solver.setDualPropagation(config.dual);
+            solver.setTimeLimit(timeLimit);
+            result = solver.compute(preprocessor);
+            if (result == Result::SAT && solver.isComplete()) {
+                std::string problem = checkBackbone(formula, solver.getBackbone());
+                if (!problem.empty()) return problem;
+            }
+        } else if (config.threads > 1) {
+            QBFPortfolio solver;
+            solver.setThreads(config.threads);
+            solver.setDeterministic(config.deterministic);
+            solver.setEpochLength(4);  // Small formulas: meet often
+            solver.setSymmetries(symmetries);
+            solver.setDualPropagation(config.dual);
+            solver.setDependencyLearning(config.dependencies);
+            solver.setTimeLimit(timeLimit);
+            result = solver.solve(preprocessor);
+        } else if (config.engine == Engine::BDD) {
+            BDDSolver solver;
+            if (config.bddNodes > 0) solver.setNodeLimit(config.bddNodes);
+            solver.setOuterCallback(onOuter);
+            solver.setTimeLimit(timeLimit);
+            result = solver.solve(preprocessor);
+            if (solver.exceededNodeLimit()) {
+                if (fellBack) *fellBack = true;
+                result = runFallback(preprocessor, onOuter, timeLimit);
+            }
+        } else if (config.engine == Engine::TREEDP) {
+            TreeDPSolver solver;
+            if (config.dpWidth >= 0) solver.setMaxWidth(config.dpWidth);
+            solver.setOuterCallback(onOuter);
+            solver.setTimeLimit(timeLimit);
+            result = solver.solve(preprocessor);
+            if (solver.exceededWidth()) {
+                if (fellBack) *fellBack = true;
+                result = runFallback(preprocessor, onOuter, timeLimit);
+            }
+        } else if (config.engine == Engine::AIG) {
+            AIGSolver solver;
+            if (config.aigNodes > 0) solver.setNodeLimit(config.aigNodes);
+            solver.setOuterCallback(onOuter);
+            solver.setTimeLimit(timeLimit);
+            result = solver.solve(preprocessor);
+            if (solver.exceededNodeLimit()) {
+                if (fellBack) *fellBack = true;
+                result = runFallback(preprocessor, onOuter, timeLimit);
+            }
+        } else if (config.engine == Engine::EXPAND) {
+            ExpansionSolver solver;
+            if (config.expandClauses > 0) solver.setClauseLimit(config.expandClauses);
+            solver.setOuterCallback(onOuter);
+            solver.setTimeLimit(timeLimit);
+            result = solver.solve(preprocessor);
+            if (solver.exceededClauseLimit()) {
+                if (fellBack) *fellBack = true;
+                result = runFallback(preprocessor, onOuter, timeLimit);
+            }
+        } else if (config.engine == Engine::INCDET) {
+            // Other prefixes and the conflict limit fall back like in main.cpp
+            IncDetSolver solver;
+            if (config.incdetConflicts >= 0) solver.setConflictLimit(config.incdetConflicts);
+            solver.setOuterCallback(onOuter);
+            solver.setTimeLimit(timeLimit);
+            result = solver.solve(preprocessor);
+            if (solver.unsupportedPrefix() || solver.exceededConflictLimit()) {
+                if (fellBack) *fellBack = true;
+                result = runFallback(preprocessor, onOuter, timeLimit);
+            } else if (result == Result::SAT) {
+                std::string problem = checkCertificate(formula, solver);
+                if (!problem.empty()) return problem;
+            }
+        } else if (config.engine == Engine::QCDCL) {
+            QCDCLSolver solver;
+            solver.setSymmetries(symmetries);
+            solver.setDualPropagation(config.dual);
+            solver.setDependencyLearning(config.dependencies);
+            solver.setOuterCallback(onOuter);
+            solver.setTimeLimit(timeLimit);
+            result = solver.solve(preprocessor);
+        } else {
+            QBFSolver solver;
+            solver.setStrategyReuse(config.reuseStrategies);
+            solver.setSymmetries(symmetries);
+            solver.setOuterCallback(onOuter);
+            solver.setTimeLimit(timeLimit);
+            result = solver.solve(preprocessor);
+        }
+
+        if (config.checkOuter && result != Result::UNKNOWN) {
+            std::string problem = checkOuterReport(formula, report);
+            if (!problem.empty()) return problem;
+        }
+        return resultName(result);
+    } catch (const std::exception& e) {
+        return std::string("ERROR (") + e.what() + ")";
+    }
+}
+
+// A configuration disagrees if it answers, and answers differently
+static bool disagrees(const std::string& outcome, const std::string& expected) {
+    return outcome != expected && outcome != "UNKNOWN";
+}
+
+static int countVariables(const QBFFormula& formula) {
+    std::unordered_set<int> vars;
+    for (const auto& block : formula.blocks) vars.insert(block.variables.begin(), block.variables.end());
+    for (const auto& clause : formula.clauses) {
+        for (const auto& lit : clause) vars.insert(lit.variable);
+    }
+    return vars.size();
+}
+
+// ============================================================================
+// Formula Sources
+// ============================================================================
+
+/*
+ * Run blocksqbf with random parameters: 2-5 blocks of 1-4 variables, each
+ * clause taking 1-2 literals per block, 3-32 clauses.
+ */
+static bool generateFormula(const std::string& generator, std::mt19937& rng, QBFFormula& formula) {
+    auto pick = [&](int lo, int hi) { return std::uniform_int_distribution<int>(lo, hi)(rng); };
+
+    int numBlocks = pick(2, 5);
+    std::ostringstream cmd;
+    cmd << generator << " -s " << rng() << " -c " << pick(3, 32) << " -b " << numBlocks;
+    std::vector<int> perClause(numBlocks);
+    for (int& n : perClause) n = pick(1, 2);
+    for (int n : perClause) cmd << " -bs " << pick(n, 4);
+    for (int n : perClause) cmd << " -bc " << n;
+    cmd << " 2>/dev/null";
+
+    FILE* pipe = popen(cmd.str().c_str(), "r");
+    if (!pipe) return false;
+    std::string text;
+    char buffer[4096];
+    size_t n;
+    while ((n = fread(buffer, 1, sizeof(buffer), pipe)) > 0) text.append(buffer, n);
+    if (pclose(pipe) != 0) return false;
+
+    std::istringstream in(text);
+    std::string error;
+    return parseQDIMACS(in, formula, error) && !formula.clauses.empty();
+}
+
+/*
+ * Apply one random structural edit. The result is always valid QDIMACS:
+ * clauses stay non-empty and no variable is quantified twice.
+ */
+static void mutateOnce(QBFFormula& f, std::mt19937& rng) {
+    auto pick = [&](int lo, int hi) { return std::uniform_int_distribution<int>(lo, hi)(rng); };
+    int maxVar = std::max(1, f.maxVariable());
+    auto randomLiteral = [&]() { return Literal(pick(1, maxVar), pick(0, 1) == 1); };
+    bool haveClauses = !f.clauses.empty();
+    bool haveBlocks = !f.blocks.empty();
+
+    switch (pick(0, 11)) {
+        case 0:  // Flip a literal
+            if (haveClauses) {
+                auto& c = f.clauses[pick(0, f.clauses.size() - 1)];
+                auto& lit = c[pick(0, c.size() - 1)];
+                lit.isNegated = !lit.isNegated;
+            }
+            break;
+        case 1:  // Remove a literal
+            if (haveClauses) {
+                auto& c = f.clauses[pick(0, f.clauses.size() - 1)];
+                if (c.size() > 1) c.erase(c.begin() + pick(0, c.size() - 1));
+            }
+            break;
+        case 2:  // Add a literal (may create duplicates or tautologies)
+            if (haveClauses) f.clauses[pick(0, f.clauses.size() - 1)].push_back(randomLiteral());
+            break;
+        case 3:  // Remove a clause
+            if (haveClauses) f.clauses.erase(f.clauses.begin() + pick(0, f.clauses.size() - 1));
+            break;
+        case 4:  // Duplicate a clause
+            if (haveClauses) f.clauses.push_back(f.clauses[pick(0, f.clauses.size() - 1)]);
+            break;
+        case 5: {  // Add a short clause
+            Clause c;
+            for (int i = pick(1, 3); i > 0; i--) c.push_back(randomLiteral());
+            f.clauses.push_back(c);
+            break;
+        }
+        case 6:  // Flip a quantifier
+            if (haveBlocks) {
+                auto& b = f.blocks[pick(0, f.blocks.size() - 1)];
+                b.type = (b.type == Quantifier::EXISTS) ? Quantifier::FORALL : Quantifier::EXISTS;
+            }
+            break;
+        case 7:  // Move a variable to another block, or out of the prefix (free)
+            if (haveBlocks) {
+                auto& from = f.blocks[pick(0, f.blocks.size() - 1)];
+                if (from.variables.empty()) break;
+                size_t i = pick(0, from.variables.size() - 1);
+                int var = from.variables[i];
+                from.variables.erase(from.variables.begin() + i);
+                if (pick(0, 3) > 0) f.blocks[pick(0, f.blocks.size() - 1)].variables.push_back(var);
+            }
+            break;
+        case 8: {  // Add a fresh variable in a new innermost block and use it
+            int var = maxVar + 1;
+            f.blocks.push_back({pick(0, 1) ? Quantifier::FORALL : Quantifier::EXISTS, {var}});
+            if (haveClauses) f.clauses[pick(0, f.clauses.size() - 1)].push_back(Literal(var, pick(0, 1) == 1));
+            break;
+        }
+        case 9:  // Split a block in two
+            if (haveBlocks) {
+                size_t b = pick(0, f.blocks.size() - 1);
+                auto& vars = f.blocks[b].variables;
+                if (vars.size() < 2) break;
+                size_t cut = pick(1, vars.size() - 1);
+                QuantifierBlock tail{pick(0, 1) ? Quantifier::FORALL : Quantifier::EXISTS,
+                                     std::vector<int>(vars.begin() + cut, vars.end())};
+                vars.resize(cut);
+                f.blocks.insert(f.blocks.begin() + b + 1, tail);
+            }
+            break;
+        case 10:  // Merge two adjacent blocks
+            if (f.blocks.size() >= 2) {
+                size_t b = pick(0, f.blocks.size() - 2);
+                auto& vars = f.blocks[b].variables;
+                vars.insert(vars.end(), f.blocks[b + 1].variables.begin(), f.blocks[b + 1].variables.end());
+                f.blocks.erase(f.blocks.begin() + b + 1);
+            }
+            break;
+        case 11: {  // Define a fresh innermost EXISTS variable as an AND/OR gate and use it
+            int var = maxVar + 1;
+            bool isOr = pick(0, 1) == 1;
+            Literal out(var, isOr);  // OR gate: ¬g = AND of the negated inputs
+            Clause longClause = {out};
+            for (int i = pick(1, 3); i > 0; i--) {
+                Literal input = randomLiteral();
+                f.clauses.push_back({Literal(var, !isOr), input});
+                longClause.push_back(input.complement());
+            }
+            f.clauses.push_back(longClause);
+            f.blocks.push_back({Quantifier::EXISTS, {var}});
+            if (haveClauses) f.clauses[pick(0, f.clauses.size() - 1)].push_back(Literal(var, pick(0, 1) == 1));
+            break;
+        }
+    }
+}
+
+static QBFFormula mutateFormula(const QBFFormula& seed, std::mt19937& rng) {
+    QBFFormula f = seed;
+    int edits = std::uniform_int_distribution<int>(1, 4)(rng);
+    for (int i = 0; i < edits; i++) mutateOnce(f, rng);
+    return f;
+}
+
+// ============================================================================
+// Main Loop
+// ============================================================================
+
+static void printUsage(const char* programName) {
+    std::cout << "Usage: " << programName << " [options] [corpus.qdimacs ...]" << std::endl;
+    std::cout << std::endl;
+    std::cout << "Options:" << std::endl;
+    std::cout << "  -n N              Number of formulas (default 500)" << std::endl;
+    std::cout << "  --seed=S          Random seed (default: from the clock)" << std::endl;
+    std::cout << "  --mode=MODE       generate, mutate or mixed" << std::endl;
+    std::cout << "  --generator=PATH  blocksqbf binary (default ./blocksqbf)" << std::endl;
+    std::cout << "  --max-vars=N      Skip formulas with more variables (default 16)" << std::endl;
+    std::cout << "  --time-limit=S    Per-solve time limit in seconds (default 10)" << std::endl;
+    std::cout << "  --out=DIR         Directory for failing formulas (default fuzz-failures)" << std::endl;
+    std::cout << "  -v                Print the verdicts for every formula" << std::endl;
+}
+
+int main(int argc, char* argv[]) {
+    long long iterations = 500;
+    unsigned long long seed = std::chrono::steady_clock::now().time_since_epoch().count();
+    std::string mode;
+    std::string generator = "./blocksqbf";
+    std::string outDir = "fuzz-failures";
+    int maxVars = 16;
+    double timeLimit = 10;
+    bool verbose = false;
+    std::vector<QBFFormula> corpus;
+
+    for (int i = 1; i < argc; i++) {
+        std::string arg = argv[i];
+        if (arg == "-n" && i + 1 < argc) {
+            iterations = std::atoll(argv[++i]);
+        } else if (arg.rfind("--seed=", 0) == 0) {
+            seed = std::strtoull(arg.c_str() + 7, nullptr, 10);
+        } else if (arg.rfind("--mode=", 0) == 0) {
+            mode = arg.substr(7);
+        } else if (arg.rfind("--generator=", 0) == 0) {
+            generator = arg.substr(12);
+        } else if (arg.rfind("--max-vars=", 0) == 0) {
+            maxVars = std::atoi(arg.c_str() + 11);
+        } else if (arg.rfind("--time-limit=", 0) == 0) {
+            timeLimit = std::atof(arg.c_str() + 13);
+        } else if (arg.rfind("--out=", 0) == 0) {
+            outDir = arg.substr(6);
+        } else if (arg == "-v") {
+            verbose = true;
+        } else if (arg == "-h" || arg == "--help") {
+            printUsage(argv[0]);
+            return 0;
+        } else if (arg[0] != '-') {
+            QBFFormula formula;
+            if (!readQDIMACS(arg, formula)) return 1;
+            corpus.push_back(formula);
+        } else {
+            std::cerr << "Unknown option: " << arg << std::endl;
+            printUsage(argv[0]);
+            return 1;
+        }
+    }
+
+    if (mode.empty()) mode = corpus.empty() ? "generate" : "mixed";
+    if (mode != "generate" && mode != "mutate" && mode != "mixed") {
+        std::cerr << "Unknown mode: " << mode << std::endl;
+        return 1;
+    }
+    if (mode != "generate" && corpus.empty()) {
+        std::cerr << "Error: --mode=" << mode << " needs corpus files" << std::endl;
+        return 1;
+    }
+
+    std::cout << "[FUZZ] seed " << seed << ", mode " << mode << ", " << CONFIGS.size()
+              << " configurations" << std::endl;
+
+    std::mt19937 rng(seed);
+    long long tested = 0, skipped = 0, failures = 0, unknown = 0, limitHits = 0;
+
+    for (long long iter = 0; iter < iterations; iter++) {
+        // Pick a source: generated, or a mutation of a corpus entry
+        bool mutate = (mode == "mutate") || (mode == "mixed" && rng() % 2 == 0);
+        QBFFormula formula;
+        if (mutate) {
+            formula = mutateFormula(corpus[rng() % corpus.size()], rng);
+        } else if (!generateFormula(generator, rng, formula)) {
+            std::cerr << "Error: generator '" << generator << "' failed (run 'make generator')" << std::endl;
+            return 1;
+        }
+        if (countVariables(formula) > maxVars) {
+            skipped++;
+            continue;
+        }
+        // Mutated formulas are fed back, so edits accumulate over time
+        if (mutate && corpus.size() < 1000) corpus.push_back(formula);
+
+        tested++;
+        std::string expected = resultName(evaluateReference(formula));
+        if (verbose) std::cout << "[FUZZ] #" << iter << " reference " << expected;
+
+        for (const auto& config : CONFIGS) {
+            bool fellBack = false;
+            std::string outcome = runConfig(formula, config, timeLimit, &fellBack);
+            if (verbose) std::cout << " " << config.name << "=" << outcome << (fellBack ? "(fallback)" : "");
+            if (outcome == "UNKNOWN") unknown++;
+            if (fellBack) limitHits++;
+            if (!disagrees(outcome, expected)) continue;
+
+            // Shrink while this configuration keeps giving the same wrong
+            // answer (not just any wrong answer, so the bug does not change)
+            failures++;
+            std::cout << std::endl << "[FAIL] #" << iter << " " << config.name << " says " << outcome
+                      << ", reference says " << expected << std::endl;
+            QBFFormula minimal = minimizeFormula(formula, [&](const QBFFormula& candidate) {
+                return runConfig(candidate, config, timeLimit) == outcome &&
+                       resultName(evaluateReference(candidate)) == expected;
+            });
+
+            std::error_code ec;
+            std::filesystem::create_directories(outDir, ec);
+            std::string base = outDir + "/fail-" + std::to_string(seed) + "-" +
+                               std::to_string(iter) + "-" + config.name;
+            writeQDIMACS(base + ".qdimacs", formula);
+            writeQDIMACS(base + ".min.qdimacs", minimal);
+            std::cout << "[FAIL] minimized from " << formula.clauses.size() << " to "
+                      << minimal.clauses.size() << " clauses: " << base << ".min.qdimacs" << std::endl;
+            writeQDIMACS(std::cout, minimal);
+            break;  // One report per formula is enough
+        }
+        if (verbose) std::cout << std::endl;
+    }
+
+    std::cout << "[FUZZ] " << tested << " formulas tested, " << skipped << " skipped (too large), "
+              << unknown << " timeouts, " << limitHits << " limit fallbacks, " << failures << " failures"
+              << std::endl;
+    return failures > 0 ? 1 : 0;
+}
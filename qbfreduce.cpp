@@ -0,0 +1,293 @@
+/*
+ * qbfreduce.cpp - Shrink Slow Instances into Small Performance Reproducers
+ *
+ * A formula on which the solver is pathologically slow is worth a bug
+ * report, but a 50,000-clause benchmark is not a useful one. The reducer
+ * runs delta debugging (QBFDelta.h) with "the solver is still slow" as
+ * the failure test, removing clauses, variables and literals and merging
+ * quantifier blocks for as long as the slowness survives.
+ *
+ * WHAT "SLOW" MEANS:
+ *   --time=T        the solve step does not finish within T seconds. The
+ *                   solver runs with a T-second time limit, so no test
+ *                   costs more than about T seconds.
+ *   --decisions=N   the solver makes more than N decisions. Decision
+ *                   counts do not depend on machine load, so the result
+ *                   is reproducible; each run is still capped by --cap.
+ *
+ * The solver runs exactly as ./qbf would (same preprocessing, same
+ * automatic engine choice), unless --engine or --symmetry says otherwise.
+ *
+ * USAGE:
+ *   ./qbfreduce [options] input.qdimacs output.qdimacs
+ *
+ *   --time=T          Keep "takes more than T seconds" (default 1)
+ *   --decisions=N     Keep "needs more than N decisions" instead
+ *   --cap=S           Time cap per run with --decisions (default 60)
+ *   --engine=NAME     auto (default), search, qcdcl, bdd, treedp, aig, incdet or expand
+ *   --symmetry        Always break symmetries (--no-symmetry: never)
+ *   -j N              Candidates tested in parallel (default: number of cores)
+ *   -v                Print every accepted reduction
+ *   --trace-out=FILE  Timeline of the candidate tests per worker (Chrome trace)
+ *
+ * Parallel runs compete for the CPU, which makes --time measurements
+ * noisy; prefer --decisions, or -j 1 when timing matters.
+ */
+
+#include "AIGSolver.h"
+#include "IncDetSolver.h"
+#include "ExpansionSolver.h"
+#include "BDDSolver.h"
+#include "QBFDelta.h"
+#include "QBFFeatures.h"
+#include "QBFPreprocessor.h"
+#include "QBFSolver.h"
+#include "QBFSymmetry.h"
+#include "QBFTrace.h"
+#include "QCDCLSolver.h"
+#include "QDIMACS.h"
+#include "TreeDPSolver.h"
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cstdlib>
+#include <iostream>
+#include <string>
+#include <thread>
+#include <unordered_set>
+
+// How the solver is run on every candidate
+struct RunSettings {
+    Engine engine = Engine::AUTO;
+    int symmetryMode = -1;   // -1 = automatic, 0 = off, 1 = on
+    double timeLimit = 1;
+};
+
+// What one run of the solver cost
+struct RunCost {
+    Result result = Result::UNKNOWN;
+    long long decisions = 0;
+    double seconds = 0;
+};
+
+/*
+ * Solve a formula the way main.cpp does: preprocess, pick the engine from
+ * the features, break symmetries if chosen, then solve with a time limit.
+ */
+static RunCost runSolver(const QBFFormula& formula, const RunSettings& settings) {
+    auto start = std::chrono::steady_clock::now();
+    RunCost cost;
+
+    QBFPreprocessor preprocessor;
+    loadFormula(formula, preprocessor);
+    preprocessor.preprocess();
+
+    EngineConfig config = selectEngine(computeFeatures(preprocessor));
+    if (settings.engine != Engine::AUTO) config.engine = settings.engine;
+    if (settings.symmetryMode >= 0) config.breakSymmetries = (settings.symmetryMode == 1);
+
+    SymmetryInfo symmetries;
+    if (config.breakSymmetries) {
+        symmetries = detectSymmetries(preprocessor);
+        addSymmetryBreakingClauses(preprocessor, symmetries);
+    }
+
+    // Like main.cpp: past the BDD or AIG node limit, the width limit, the
+    // conflict limit or the clause limit, or on a prefix other than ∀∃,
+    // the fallback engine takes over
+    if (config.engine == Engine::BDD) {
+        BDDSolver solver;
+        solver.setTimeLimit(settings.timeLimit);
+        cost.result = solver.solve(preprocessor);
+        if (solver.exceededNodeLimit()) config.engine = config.fallback;
+    }
+    if (config.engine == Engine::TREEDP) {
+        TreeDPSolver solver;
+        solver.setTimeLimit(settings.timeLimit);
+        cost.result = solver.solve(preprocessor);
+        if (solver.exceededWidth()) config.engine = config.fallback;
+    }
+    if (config.engine == Engine::AIG) {
+        AIGSolver solver;
+        solver.setTimeLimit(settings.timeLimit);
+        cost.result = solver.solve(preprocessor);
+        if (solver.exceededNodeLimit()) config.engine = config.fallback;
+    }
+    if (config.engine == Engine::INCDET) {
+        IncDetSolver solver;
+        solver.setTimeLimit(settings.timeLimit);
+        cost.result = solver.solve(preprocessor);
+        cost.decisions = solver.getStats().decisions;
+        if (solver.unsupportedPrefix() || solver.exceededConflictLimit()) config.engine = config.fallback;
+    }
+    if (config.engine == Engine::EXPAND) {
+        ExpansionSolver solver;
+        solver.setTimeLimit(settings.timeLimit);
+        cost.result = solver.solve(preprocessor);
+        if (solver.exceededClauseLimit()) config.engine = config.fallback;
+    }
+
+    if (config.engine == Engine::QCDCL) {
+        QCDCLSolver solver;
+        solver.setSymmetries(symmetries);
+        solver.setDependencyLearning(config.dependencyLearning);
+        solver.setTimeLimit(settings.timeLimit);
+        cost.result = solver.solve(preprocessor);
+        cost.decisions = solver.getStats().decisions;
+    } else if (config.engine == Engine::SEARCH) {
+        QBFSolver solver;
+        solver.setStrategyReuse(config.reuseStrategies);
+        solver.setSymmetries(symmetries);
+        solver.setTimeLimit(settings.timeLimit);
+        cost.result = solver.solve(preprocessor);
+        cost.decisions = solver.getStats().decisions;
+    }
+
+    cost.seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+    return cost;
+}
+
+static int countVariables(const QBFFormula& formula) {
+    std::unordered_set<int> vars;
+    for (const auto& block : formula.blocks) vars.insert(block.variables.begin(), block.variables.end());
+    for (const auto& clause : formula.clauses) {
+        for (const auto& lit : clause) vars.insert(lit.variable);
+    }
+    return vars.size();
+}
+
+static std::string sizeToString(const QBFFormula& formula) {
+    return std::to_string(formula.clauses.size()) + " clauses, " +
+           std::to_string(countVariables(formula)) + " variables, " +
+           std::to_string(formula.blocks.size()) + " blocks";
+}
+
+static std::string costToString(const RunCost& cost) {
+    std::string answer = cost.result == Result::SAT   ? "SAT" :
+                         cost.result == Result::UNSAT ? "UNSAT" : "timeout";
+    return answer + " after " + std::to_string(cost.decisions) + " decisions, " +
+           std::to_string(cost.seconds) + " s";
+}
+
+static void printUsage(const char* programName) {
+    std::cout << "Usage: " << programName << " [options] input.qdimacs output.qdimacs" << std::endl;
+    std::cout << std::endl;
+    std::cout << "Options:" << std::endl;
+    std::cout << "  --time=T        Keep \"takes more than T seconds\" (default 1)" << std::endl;
+    std::cout << "  --decisions=N   Keep \"needs more than N decisions\" instead" << std::endl;
+    std::cout << "  --cap=S         Time cap per run with --decisions (default 60)" << std::endl;
+    std::cout << "  --engine=NAME   Solving engine: auto (default), search, qcdcl, bdd, treedp, aig," << std::endl;
+    std::cout << "                  incdet, expand" << std::endl;
+    std::cout << "  --symmetry      Always detect and break symmetries" << std::endl;
+    std::cout << "  --no-symmetry   Never break symmetries" << std::endl;
+    std::cout << "  -j N            Candidates tested in parallel (default: number of cores)" << std::endl;
+    std::cout << "  -v              Print every accepted reduction" << std::endl;
+    std::cout << "  --trace-out=F   Write a timeline of the candidate tests to F" << std::endl;
+}
+
+int main(int argc, char* argv[]) {
+    RunSettings settings;
+    long long maxDecisions = -1;  // -1 = time mode
+    double cap = 60;
+    int threads = std::max(1u, std::thread::hardware_concurrency());
+    bool verbose = false;
+    std::string traceFile;
+    std::vector<std::string> files;
+
+    for (int i = 1; i < argc; i++) {
+        std::string arg = argv[i];
+        if (arg.rfind("--time=", 0) == 0) {
+            settings.timeLimit = std::atof(arg.c_str() + 7);
+        } else if (arg.rfind("--decisions=", 0) == 0) {
+            maxDecisions = std::atoll(arg.c_str() + 12);
+        } else if (arg.rfind("--cap=", 0) == 0) {
+            cap = std::atof(arg.c_str() + 6);
+        } else if (arg.rfind("--engine=", 0) == 0) {
+            if (!parseEngine(arg.substr(9), settings.engine)) {
+                std::cerr << "Unknown engine: " << arg.substr(9) << std::endl;
+                return 1;
+            }
+        } else if (arg == "--symmetry") {
+            settings.symmetryMode = 1;
+        } else if (arg == "--no-symmetry") {
+            settings.symmetryMode = 0;
+        } else if (arg == "-j" && i + 1 < argc) {
+            threads = std::max(1, std::atoi(argv[++i]));
+        } else if (arg.rfind("--trace-out=", 0) == 0) {
+            traceFile = arg.substr(12);
+        } else if (arg == "-v") {
+            verbose = true;
+        } else if (arg == "-h" || arg == "--help") {
+            printUsage(argv[0]);
+            return 0;
+        } else if (arg[0] != '-') {
+            files.push_back(arg);
+        } else {
+            std::cerr << "Unknown option: " << arg << std::endl;
+            printUsage(argv[0]);
+            return 1;
+        }
+    }
+    if (files.size() != 2) {
+        printUsage(argv[0]);
+        return 1;
+    }
+
+    if (!traceFile.empty()) traceStart();
+
+    QBFFormula formula;
+    if (!readQDIMACS(files[0], formula)) return 1;
+
+    // The failure test: is the solver still slow on this candidate?
+    if (maxDecisions >= 0) settings.timeLimit = cap;
+    auto isSlow = [&](const RunCost& cost) {
+        if (maxDecisions >= 0) return cost.decisions > maxDecisions;
+        return cost.result == Result::UNKNOWN;
+    };
+    std::atomic<long long> tests{0};
+    FailureTest stillSlow = [&](const QBFFormula& candidate) {
+        tests++;
+        return isSlow(runSolver(candidate, settings));
+    };
+
+    std::string property = maxDecisions >= 0
+        ? "more than " + std::to_string(maxDecisions) + " decisions"
+        : "more than " + std::to_string(settings.timeLimit) + " s";
+    std::cout << "[REDUCE] " << files[0] << ": " << sizeToString(formula) << std::endl;
+    std::cout << "[REDUCE] keeping \"" << property << "\" with " << threads << " threads" << std::endl;
+
+    RunCost original = runSolver(formula, settings);
+    std::cout << "[REDUCE] original: " << costToString(original) << std::endl;
+    if (!isSlow(original)) {
+        std::cerr << "Error: the input does not need " << property << " - nothing to reduce" << std::endl;
+        return 1;
+    }
+
+    DeltaOptions options;
+    options.threads = threads;
+    if (verbose) {
+        options.onReduced = [](const QBFFormula& reduced) {
+            std::cout << "[REDUCE] now " << sizeToString(reduced) << std::endl;
+        };
+    }
+    QBFFormula reduced = minimizeFormula(formula, stillSlow, options);
+
+    // Re-measure alone: parallel runs may have inflated the times
+    RunCost final = runSolver(reduced, settings);
+    std::cout << "[REDUCE] reduced to " << sizeToString(reduced) << " in " << tests << " tests" << std::endl;
+    std::cout << "[REDUCE] reduced: " << costToString(final) << std::endl;
+    if (!isSlow(final)) {
+        std::cout << "[REDUCE] warning: the reduced formula is no longer slow when run alone" << std::endl;
+    }
+
+    if (!writeQDIMACS(files[1], reduced)) {
+        std::cerr << "Error: Cannot write '" << files[1] << "'" << std::endl;
+        return 1;
+    }
+    std::cout << "[REDUCE] written to " << files[1] << std::endl;
+
+    if (!traceFile.empty() && !traceWrite(traceFile)) {
+        std::cerr << "Warning: Cannot write trace file '" << traceFile << "'" << std::endl;
+    }
+    return 0;
+}